@@ -0,0 +1,95 @@
+// Frame rate of GraphItem under the Qt Quick software renderer.
+//
+// Usage: bench_graph_item [nodes] [seconds]
+//
+// Loads a synthetic graph (same shape as bench_graph_layout, laid out in
+// layers so setup stays fast), shows it in an offscreen window and
+// changes the zoom and pan on every frame, as a user dragging or
+// scrolling would. Reports the time to the first frame (geometry build)
+// and frames per second while navigating.
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QQuickWindow>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "graph_item.h"
+#include "state_graph_model.h"
+
+using namespace tla_visualiser;
+
+static TLCRunner::RunResults makeResults(int nodes) {
+    TLCRunner::RunResults results{};
+    const std::vector<std::pair<std::string, std::string>> variables{{"x", "0"}};
+    uint64_t seed = 42;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return seed >> 33;
+    };
+    for (int i = 0; i < nodes; ++i) {
+        results.states.add(i, "S", variables);
+        if (i == 0) continue;
+        int span = std::min(i, 64);
+        results.transitions.push_back({static_cast<int>(i - 1 - next() % span), i, "Next"});
+        for (int extra = 0; extra < 2; ++extra) {
+            results.transitions.push_back({i, static_cast<int>(i - 1 - next() % span), "Next"});
+        }
+    }
+    return results;
+}
+
+int main(int argc, char* argv[]) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    QGuiApplication app(argc, argv);
+
+    const int nodes = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 5.0;
+
+    StateGraphModel model;
+    model.setLayoutMode(StateGraphModel::LayoutMode::Layered);
+    model.loadFromResults(makeResults(nodes));
+
+    QQuickWindow window;
+    window.resize(1280, 800);
+    auto* item = new GraphItem(window.contentItem());
+    item->setSize(QSizeF(1280, 800));
+    item->setModel(&model);
+
+    QElapsedTimer clock;
+    qint64 first_frame = -1;
+    long frames = 0;
+    const qreal fit = item->zoom();
+    const QPointF centre(640, 400);
+    const QPointF anchor = (centre - item->pan()) / fit;   // layout point at the centre
+
+    QObject::connect(&window, &QQuickWindow::frameSwapped, &window, [&]() {
+        if (first_frame < 0) {
+            first_frame = clock.elapsed();
+            clock.restart();
+        } else {
+            ++frames;
+        }
+        if (clock.elapsed() >= seconds * 1000) {
+            std::printf("nodes %d, edges %d\n", model.nodeCount(), model.edgeCount());
+            std::printf("first frame: %lld ms\n", static_cast<long long>(first_frame));
+            std::printf("navigating: %ld frames in %.1f s = %.1f fps\n", frames,
+                        clock.elapsed() / 1000.0, frames * 1000.0 / clock.elapsed());
+            app.quit();
+            return;
+        }
+        // Zoom in and out around the centre while panning sideways
+        const double t = frames / 30.0;
+        const qreal zoom = fit * (1.0 + 3.0 * (0.5 + 0.5 * std::sin(t)));
+        item->setZoom(zoom);
+        item->setPan(centre - anchor * zoom + QPointF(200 * std::cos(t), 0));
+    });
+
+    clock.start();
+    window.show();
+    return app.exec();
+}
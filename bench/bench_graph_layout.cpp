@@ -0,0 +1,106 @@
+// Times GraphLayout::forceDirected on a synthetic state graph.
+//
+// Usage: bench_graph_layout [nodes] [threads] [iterations]
+//
+// The graph mimics TLC output: a BFS-like spanning tree (each state
+// reached from a recent one) plus two extra, mostly local transitions
+// per state.
+// Reports the cold layout time, a warm re-layout after adding 1% more
+// nodes, a refine() of just those nodes, and the mean edge length relative
+// to the ideal length as a rough quality check; then the spatial index
+// build and update for that growth, and the time of the layered layout on
+// the same graph.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "graph_layout.h"
+#include "spatial_index.h"
+
+using namespace tla_visualiser;
+
+static std::vector<GraphLayout::Edge> makeEdges(std::size_t nodes) {
+    std::vector<GraphLayout::Edge> edges;
+    uint64_t seed = 42;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return seed >> 33;
+    };
+    for (std::size_t i = 1; i < nodes; ++i) {
+        std::size_t span = std::min<std::size_t>(i, 64);
+        edges.push_back({static_cast<uint32_t>(i - 1 - next() % span), static_cast<uint32_t>(i)});
+        for (int extra = 0; extra < 2; ++extra) {
+            edges.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(i - 1 - next() % span)});
+        }
+    }
+    return edges;
+}
+
+static double meanEdgeLength(const std::vector<GraphLayout::Edge>& edges,
+                             const std::vector<GraphLayout::Point>& positions) {
+    double total = 0;
+    for (const auto& [from, to] : edges) {
+        double dx = positions[from].first - positions[to].first;
+        double dy = positions[from].second - positions[to].second;
+        total += std::sqrt(dx * dx + dy * dy);
+    }
+    return edges.empty() ? 0 : total / edges.size();
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    GraphLayout::ForceOptions options;
+    options.threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0;
+    if (argc > 3) options.iterations = std::atoi(argv[3]);
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+
+    std::size_t grown = nodes + nodes / 100;
+    std::vector<GraphLayout::Edge> all_edges = makeEdges(grown);
+    std::vector<GraphLayout::Edge> edges;
+    for (const auto& edge : all_edges) {
+        if (edge.first < nodes && edge.second < nodes) edges.push_back(edge);
+    }
+
+    std::vector<GraphLayout::Point> positions;
+    auto start = std::chrono::steady_clock::now();
+    GraphLayout::forceDirected(nodes, edges, positions, options);
+    double cold = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("cold:  %zu nodes, %zu edges, %u threads, %d iterations: %.2f s (mean edge %.2f x ideal)\n",
+                nodes, edges.size(), threads, options.iterations, cold,
+                meanEdgeLength(edges, positions) / options.edge_length);
+
+    // makeEdges() emits the edges of each node in order, so the grown
+    // graph's edges are `edges` followed by the new ones
+    const std::vector<GraphLayout::Point> laid_out = positions;
+    start = std::chrono::steady_clock::now();
+    GraphLayout::forceDirected(grown, all_edges, positions, options);
+    double warm = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("warm:  +%zu nodes: %.2f s (mean edge %.2f x ideal)\n",
+                grown - nodes, warm, meanEdgeLength(all_edges, positions) / options.edge_length);
+
+    positions = laid_out;
+    std::vector<uint32_t> moved;
+    start = std::chrono::steady_clock::now();
+    GraphLayout::refine(grown, all_edges, edges.size(), positions, moved, options);
+    double refine = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("refine: +%zu nodes, %zu moved: %.3f s (mean edge %.2f x ideal)\n",
+                grown - nodes, moved.size(), refine, meanEdgeLength(all_edges, positions) / options.edge_length);
+
+    SpatialIndex index(laid_out, edges);
+    start = std::chrono::steady_clock::now();
+    SpatialIndex rebuilt(positions, all_edges);
+    double build = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    SpatialIndex updated = index.updated(positions, all_edges, edges.size(), moved);
+    double update = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("index: build %.3f s, update %.3f s\n", build, update);
+
+    start = std::chrono::steady_clock::now();
+    GraphLayout::layered(grown, all_edges, positions);
+    double layered = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("layered: %zu nodes, %zu edges: %.3f s\n", grown, all_edges.size(), layered);
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Parses a GitHub recursive tree listing two ways: buffered whole into
+// QJsonDocument (what fetchRepository used to do) and streamed through
+// JsonStreamParser in network-sized chunks, keeping only the matching
+// entries (what it does now).
+//
+// Usage: bench_json_stream [entries] [chunk_bytes]
+//
+// The listing is synthetic (default 300k entries, about 55 MB; one in a
+// hundred is a .tla file). The streamed variant's memory is the token
+// buffer plus the kept entries; the buffered variant also holds the whole
+// body and the document built from it.
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "json_stream.h"
+
+using namespace tla_visualiser;
+
+static std::string makeListing(std::size_t entries) {
+    std::string listing = R"({"sha": "0123456789abcdef0123456789abcdef01234567", "url": "https://api.github.com/repos/o/r/git/trees/0123", "tree": [)";
+    listing.reserve(entries * 180);
+    for (std::size_t i = 0; i < entries; ++i) {
+        const std::string path = i % 100 == 0 ? "specs/module" + std::to_string(i) + "/Spec.tla"
+                                              : "src/component" + std::to_string(i % 997) + "/file" +
+                                                    std::to_string(i) + ".cpp";
+        if (i) listing += ',';
+        listing += R"({"path": ")" + path + R"(", "mode": "100644", "type": "blob", "sha": ")" +
+                   std::to_string(1000000000 + i) + R"(0123456789abcdef0123456789", "size": )" +
+                   std::to_string(i % 5000) + R"(, "url": "https://api.github.com/repos/o/r/git/blobs/)" +
+                   std::to_string(i) + "\"}";
+    }
+    listing += R"(], "truncated": false})";
+    return listing;
+}
+
+static bool isSpec(std::string_view path) {
+    return path.size() > 4 && path.substr(path.size() - 4) == ".tla";
+}
+
+// Same shape as the importer's handler: keep blobs with matching paths
+class Matches : public JsonStreamParser::Handler {
+public:
+    std::vector<std::string> paths;
+    std::size_t entries = 0;
+
+    void startObject() override { ++depth; }
+    void endObject() override {
+        if (depth-- == 3) {
+            ++entries;
+            if (blob && isSpec(path)) paths.push_back(path);
+            blob = false;
+        }
+    }
+    void startArray() override { ++depth; }
+    void endArray() override { --depth; }
+    void key(std::string_view name) override { last_key.assign(name); }
+    void string(std::string_view value) override {
+        if (depth != 3) return;
+        if (last_key == "path") path.assign(value);
+        if (last_key == "type") blob = value == "blob";
+    }
+
+private:
+    int depth = 0;
+    bool blob = false;
+    std::string last_key;
+    std::string path;
+};
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t entries = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300000;
+    std::size_t chunk = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16384;
+    if (chunk == 0) chunk = 16384;
+
+    const std::string listing = makeListing(entries);
+    const double megabytes = listing.size() / 1048576.0;
+    std::printf("listing:  %8.1f MB, %zu entries\n", megabytes, entries);
+
+    // Buffered: the body is held whole, then a DOM is built over it
+    auto start = std::chrono::steady_clock::now();
+    std::size_t buffered_matches = 0;
+    {
+        std::string body;
+        for (std::size_t at = 0; at < listing.size(); at += chunk) {
+            body.append(listing, at, chunk);
+        }
+        const QJsonDocument document =
+            QJsonDocument::fromJson(QByteArray(body.data(), static_cast<qsizetype>(body.size())));
+        for (const auto& value : document.object().value("tree").toArray()) {
+            const QJsonObject entry = value.toObject();
+            if (entry.value("type").toString() == "blob" &&
+                isSpec(entry.value("path").toString().toStdString())) {
+                ++buffered_matches;
+            }
+        }
+    }
+    const double buffered_ms = millisecondsSince(start);
+
+    // Streamed: chunks go straight to the parser
+    start = std::chrono::steady_clock::now();
+    Matches matches;
+    JsonStreamParser parser(matches);
+    std::size_t held = 0;
+    for (std::size_t at = 0; at < listing.size(); at += chunk) {
+        const std::size_t size = std::min(chunk, listing.size() - at);
+        if (!parser.feed(listing.data() + at, size)) break;
+        held = std::max(held, parser.bufferedBytes());
+    }
+    if (!parser.finish()) {
+        std::fprintf(stderr, "parse failed: %s\n", parser.error().c_str());
+        return 1;
+    }
+    const double streamed_ms = millisecondsSince(start);
+
+    std::printf("buffered: %8.1f ms (%7.1f MB/s), %zu matches, body of %.1f MB held\n",
+                buffered_ms, megabytes / (buffered_ms / 1000.0), buffered_matches, megabytes);
+    std::printf("streamed: %8.1f ms (%7.1f MB/s), %zu matches of %zu entries, at most %zu bytes buffered\n",
+                streamed_ms, megabytes / (streamed_ms / 1000.0), matches.paths.size(), matches.entries, held);
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Measures how long a saved run takes to reopen from the binary results
+// file, and how much of it is actually read.
+//
+// Usage: bench_results_file [states] [variables] [path]
+//
+// Writes a synthetic run (default 5M states x 10 variables), then maps the
+// file the way TLCRunner::loadResults does (POSIX mmap here instead of
+// QFile::map) and times results_file::read plus building the StateIndex.
+// The resident-set growth after opening shows that untouched values stay
+// on disk. The file is usually still in the page cache, so this measures
+// decoding rather than disk reads.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "results_file.h"
+#include "state_index.h"
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace tla_visualiser;
+
+static long long residentBytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    long long pages_total = 0, pages_resident = 0;
+    if (statm >> pages_total >> pages_resident) {
+        return pages_resident * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+#if defined(__unix__)
+    std::size_t state_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000000;
+    std::size_t variable_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    std::string path = argc > 3 ? argv[3] : "bench_results_file.tlcres";
+
+    {
+        TLCRunner::RunResults results{};
+        std::vector<std::pair<std::string, std::string>> variables(variable_count);
+        for (std::size_t i = 0; i < state_count; ++i) {
+            for (std::size_t v = 0; v < variable_count; ++v) {
+                variables[v] = {"v" + std::to_string(v),
+                                "<<" + std::to_string(i % 9973) + ", \"" + std::to_string(v) + "\">>"};
+            }
+            results.states.add(static_cast<int>(i), i == 0 ? "Initial predicate" : "Next", variables);
+            if (i > 0) {
+                results.transitions.push_back({static_cast<int>(i - 1), static_cast<int>(i), "Next"});
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!results_file::write(out, results)) {
+            std::fprintf(stderr, "failed to write %s\n", path.c_str());
+            return 1;
+        }
+        std::printf("write:  %8.1f ms\n", millisecondsSince(start));
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info {};
+    if (fd < 0 || ::fstat(fd, &info) != 0) {
+        std::fprintf(stderr, "failed to open %s\n", path.c_str());
+        return 1;
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+
+    long long before = residentBytes();
+    auto start = std::chrono::steady_clock::now();
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::fprintf(stderr, "mmap failed\n");
+        return 1;
+    }
+    std::shared_ptr<const void> backing(mapped, [size](const void* p) {
+        ::munmap(const_cast<void*>(p), size);
+    });
+
+    TLCRunner::RunResults loaded{};
+    if (!results_file::read(std::string_view(static_cast<const char*>(mapped), size), backing, loaded)) {
+        std::fprintf(stderr, "failed to read %s\n", path.c_str());
+        return 1;
+    }
+    loaded.index = StateIndex::of(loaded);
+    double open_ms = millisecondsSince(start);
+    long long open_rss = residentBytes() - before;
+
+    start = std::chrono::steady_clock::now();
+    std::size_t checksum = 0;
+    for (std::size_t i = 0; i < 1000 && loaded.states.size() > 0; ++i) {
+        std::size_t index = (i * 2654435761u) % loaded.states.size();
+        checksum += loaded.states.value(index, i % variable_count).size();
+    }
+    double access_ms = millisecondsSince(start);
+
+    std::printf("file:   %8.1f MB, %zu states, %zu transitions\n",
+                size / 1048576.0, loaded.states.size(), loaded.transitions.size());
+    std::printf("open:   %8.1f ms, %8.1f MB resident after open\n", open_ms, open_rss / 1048576.0);
+    std::printf("access: %8.3f ms for 1000 random values (checksum %zu)\n", access_ms, checksum);
+
+    ::unlink(path.c_str());
+    return 0;
+#else
+    (void)argc;
+    (void)argv;
+    std::printf("bench_results_file requires POSIX mmap\n");
+    return 0;
+#endif
+}
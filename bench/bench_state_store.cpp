@@ -0,0 +1,102 @@
+// Compares the memory footprint of StateStore against the former
+// std::vector<TLCRunner::State> representation.
+//
+// Usage: bench_state_store [states] [variables]
+//
+// Builds the same synthetic run (default 1M states x 10 variables) in
+// both layouts and reports the resident-set growth of each. RSS is read
+// from /proc on Linux; elsewhere only StateStore::memoryUsage() is shown.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "tlc_runner.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+using namespace tla_visualiser;
+
+static long long residentBytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    long long pages_total = 0, pages_resident = 0;
+    if (statm >> pages_total >> pages_resident) {
+        return pages_resident * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
+
+static void releaseFreedMemory() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+static const char* kNames[] = {
+    "pc", "counter", "queue", "flag", "votes", "leader", "term", "log", "msgs", "acks",
+    "v10", "v11", "v12", "v13", "v14", "v15",
+};
+
+static std::string makeValue(std::size_t state, std::size_t variable) {
+    switch (variable % 4) {
+    case 0: return std::to_string(state % 1000);
+    case 1: return state % 2 ? "TRUE" : "FALSE";
+    case 2: return "<<" + std::to_string(state % 7) + ", " + std::to_string(state % 11) + ">>";
+    default: return "[p1 |-> \"idle\", p2 |-> \"busy\"]";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t state_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::size_t variable_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    if (variable_count > sizeof(kNames) / sizeof(kNames[0])) {
+        variable_count = sizeof(kNames) / sizeof(kNames[0]);
+    }
+
+    long long store_rss = 0;
+    {
+        long long before = residentBytes();
+        StateStore store;
+        std::vector<std::pair<std::string, std::string>> variables(variable_count);
+        for (std::size_t i = 0; i < state_count; ++i) {
+            for (std::size_t v = 0; v < variable_count; ++v) {
+                variables[v] = {kNames[v], makeValue(i, v)};
+            }
+            store.add(static_cast<int>(i), i == 0 ? "Initial predicate" : "Next", variables);
+        }
+        store_rss = residentBytes() - before;
+        std::printf("StateStore:         %8.1f MB RSS, %8.1f MB reported\n",
+                    store_rss / 1048576.0, store.memoryUsage() / 1048576.0);
+    }
+    releaseFreedMemory();
+
+    {
+        long long before = residentBytes();
+        std::vector<TLCRunner::State> states;
+        for (std::size_t i = 0; i < state_count; ++i) {
+            TLCRunner::State state;
+            state.id = static_cast<int>(i);
+            state.description = i == 0 ? "Initial predicate" : "Next";
+            for (std::size_t v = 0; v < variable_count; ++v) {
+                state.variables.emplace_back(kNames[v], makeValue(i, v));
+            }
+            states.push_back(std::move(state));
+        }
+        long long legacy_rss = residentBytes() - before;
+        std::printf("vector<State>:      %8.1f MB RSS\n", legacy_rss / 1048576.0);
+        if (store_rss > 0 && legacy_rss > 0) {
+            std::printf("reduction:          %8.1fx\n", static_cast<double>(legacy_rss) / store_rss);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Compares std::regex against the text_scan primitives on the two hot
+// paths that used regexes: TLC log line scanning and GitHub URL parsing.
+//
+// Usage: bench_text_scan [lines] [urls]
+//
+// The log is synthetic plain (non -tool) TLC output of the given number of
+// lines (default 10M). The regex variant reproduces the former
+// TLCRunner::parseResults loop; the scanner variant is what
+// TLCOutputParser does per line today.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <sstream>
+#include <string>
+#include "github_importer.h"
+#include "text_scan.h"
+
+using namespace tla_visualiser;
+
+static std::string makeLog(std::size_t lines) {
+    std::string log;
+    log.reserve(lines * 64);
+    for (std::size_t i = 0; i < lines; ++i) {
+        switch (i % 8) {
+        case 0:
+            log += "Progress(" + std::to_string(i / 8) + ") at 2024-01-01 12:00:00: " +
+                   std::to_string(i * 3) + " states generated (1,843,921 s/min), " +
+                   std::to_string(i) + " distinct states found (232,091 ds/min), "
+                   "10,220 states left on queue.\n";
+            break;
+        case 1:
+            log += "Checking temporal properties for the current state space with 1204 total distinct states\n";
+            break;
+        case 2:
+            log += "/\\ counter = " + std::to_string(i) + "\n";
+            break;
+        case 3:
+            log += "/\\ pc = [p1 |-> \"a\", p2 |-> \"b\"]\n";
+            break;
+        default:
+            log += "Finished checking temporal properties in 00s at 2024-01-01 12:00:00\n";
+            break;
+        }
+    }
+    return log;
+}
+
+struct Counters {
+    long long generated = 0;
+    long long distinct = 0;
+    std::size_t errors = 0;
+};
+
+static Counters scanWithRegex(const std::string& log) {
+    Counters counters;
+    std::istringstream stream(log);
+    std::string line;
+    std::regex states_pattern(R"((\d+)\s+states\s+generated)");
+    std::regex distinct_pattern(R"((\d+)\s+distinct\s+states)");
+    std::smatch match;
+    while (std::getline(stream, line)) {
+        if (std::regex_search(line, match, states_pattern)) {
+            counters.generated = std::stoll(match[1]);
+        }
+        if (std::regex_search(line, match, distinct_pattern)) {
+            counters.distinct = std::stoll(match[1]);
+        }
+        if (line.find("Error:") != std::string::npos) {
+            ++counters.errors;
+        }
+    }
+    return counters;
+}
+
+static Counters scanWithTextScan(const std::string& log) {
+    Counters counters;
+    text_scan::LineReader lines(log);
+    std::string_view line;
+    while (lines.next(line)) {
+        if (line.find("states") != std::string_view::npos) {
+            long long generated = text_scan::countBefore(line, "states generated");
+            if (generated >= 0) counters.generated = generated;
+            long long distinct = text_scan::countBefore(line, "distinct states");
+            if (distinct >= 0) counters.distinct = distinct;
+        }
+        if (line.find("Error:") != std::string_view::npos) {
+            ++counters.errors;
+        }
+    }
+    return counters;
+}
+
+static GitHubImporter::UrlInfo parseUrlWithRegex(const std::string& url) {
+    GitHubImporter::UrlInfo info{};
+    std::regex file_pattern(R"(github\.com/([^/]+)/([^/]+)/blob/([^/]+)/(.+))");
+    std::regex raw_pattern(R"(raw\.githubusercontent\.com/([^/]+)/([^/]+)/([^/]+)/(.+))");
+    std::regex repo_pattern(R"(github\.com/([^/]+)/([^/]+)/?$)");
+    std::smatch match;
+    if (std::regex_search(url, match, file_pattern) ||
+        std::regex_search(url, match, raw_pattern)) {
+        info.owner = match[1];
+        info.repo = match[2];
+        info.branch = match[3];
+        info.file_path = match[4];
+    } else if (std::regex_search(url, match, repo_pattern)) {
+        info.owner = match[1];
+        info.repo = match[2];
+    }
+    return info;
+}
+
+template <typename F>
+static double timeIt(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t line_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    std::size_t url_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+
+    std::string log = makeLog(line_count);
+    double mb = static_cast<double>(log.size()) / (1024.0 * 1024.0);
+
+    Counters regex_counters, scan_counters;
+    double regex_seconds = timeIt([&] { regex_counters = scanWithRegex(log); });
+    double scan_seconds = timeIt([&] { scan_counters = scanWithTextScan(log); });
+
+    std::printf("log: %zu lines, %.1f MB\n", line_count, mb);
+    std::printf("  std::regex  %8.3f s  %10.0f lines/s  %8.1f MB/s\n",
+                regex_seconds, line_count / regex_seconds, mb / regex_seconds);
+    std::printf("  text_scan   %8.3f s  %10.0f lines/s  %8.1f MB/s  (%.1fx)\n",
+                scan_seconds, line_count / scan_seconds, mb / scan_seconds,
+                regex_seconds / scan_seconds);
+    if (regex_counters.generated != scan_counters.generated ||
+        regex_counters.distinct != scan_counters.distinct ||
+        regex_counters.errors != scan_counters.errors) {
+        std::printf("  MISMATCH between regex and text_scan results\n");
+        return 1;
+    }
+
+    const std::string urls[] = {
+        "https://github.com/tlaplus/Examples/blob/master/specifications/Paxos/Paxos.tla",
+        "https://raw.githubusercontent.com/tlaplus/Examples/master/specifications/ewd840/EWD840.tla",
+        "https://github.com/tlaplus/Examples",
+    };
+    GitHubImporter importer;
+    std::size_t sink = 0;
+    double url_regex_seconds = timeIt([&] {
+        for (std::size_t i = 0; i < url_count; ++i) sink += parseUrlWithRegex(urls[i % 3]).owner.size();
+    });
+    double url_scan_seconds = timeIt([&] {
+        for (std::size_t i = 0; i < url_count; ++i) sink += importer.parseUrl(urls[i % 3]).owner.size();
+    });
+
+    std::printf("parseUrl: %zu urls\n", url_count);
+    std::printf("  std::regex  %8.3f s  %10.0f urls/s\n", url_regex_seconds, url_count / url_regex_seconds);
+    std::printf("  text_scan   %8.3f s  %10.0f urls/s  (%.1fx)\n", url_scan_seconds,
+                url_count / url_scan_seconds, url_regex_seconds / url_scan_seconds);
+    return sink == 0;
+}
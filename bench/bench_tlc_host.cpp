@@ -0,0 +1,82 @@
+// Latency of repeated small model checks: a JVM per run vs the warm host.
+//
+// Usage: bench_tlc_host [runs] [tla2tools.jar] [spec] [TLCHost.java]
+//
+// Checks the spec (default examples/SimpleCounter.tla, which stops at its
+// first invariant violation within a few states) `runs` times with a fresh
+// JVM per run, then the same number of times through tools/TLCHost.java.
+// The first warm run includes starting the host. Needs java on PATH and
+// is run from the source directory by default.
+
+#include <QCoreApplication>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tlc_runner.h"
+
+using namespace tla_visualiser;
+
+static std::vector<double> timeRuns(TLCRunner& runner, const std::string& spec, const std::string& config,
+                                    int runs) {
+    std::vector<double> milliseconds;
+    for (int i = 0; i < runs; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        if (!runner.startModelCheck(spec, config)) break;
+        while (runner.getStatus() == TLCRunner::Status::Running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        milliseconds.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        if (runner.getStatus() == TLCRunner::Status::Failed) {
+            std::fprintf(stderr, "run failed: %s\n", runner.getResults().error_message.c_str());
+            break;
+        }
+    }
+    return milliseconds;
+}
+
+static void report(const char* label, std::vector<double> milliseconds) {
+    if (milliseconds.empty()) {
+        std::printf("%-10s no runs\n", label);
+        return;
+    }
+    const double first = milliseconds.front();
+    std::sort(milliseconds.begin(), milliseconds.end());
+    double total = 0;
+    for (double ms : milliseconds) total += ms;
+    std::printf("%-10s runs %3zu  first %8.1f ms  median %8.1f ms  mean %8.1f ms  min %8.1f ms\n",
+                label, milliseconds.size(), first, milliseconds[milliseconds.size() / 2],
+                total / static_cast<double>(milliseconds.size()), milliseconds.front());
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const int runs = argc > 1 ? std::atoi(argv[1]) : 20;
+    TLCOptions options = TLCOptions::autoSized();
+    options.workers = 1;   // small specs: worker startup would only add noise
+    if (argc > 2) options.tla2tools_jar = argv[2];
+    const std::string spec = argc > 3 ? argv[3] : "examples/SimpleCounter.tla";
+    if (argc > 4) options.host_source = argv[4];
+    std::string config = spec;
+    if (config.size() > 4 && config.compare(config.size() - 4, 4, ".tla") == 0) {
+        config.replace(config.size() - 4, 4, ".cfg");
+    }
+
+    {
+        TLCRunner cold;
+        cold.setOptions(options);
+        report("per-run", timeRuns(cold, spec, config, runs));
+    }
+    {
+        options.warm_host = true;
+        TLCRunner warm;
+        warm.setOptions(options);
+        report("warm host", timeRuns(warm, spec, config, runs));
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Measures TLCOutputParser throughput on synthetic -tool output.
+//
+// Usage: bench_tlc_output_parser [megabytes] [chunk_bytes]
+//
+// The generated log mixes progress statistics with error traces whose
+// states have several multi-line variables, which is what dominates the
+// output of long runs with violations. Two variants are measured: traces
+// that revisit the same states (pure decode cost) and traces where every
+// state is new (decode plus materialisation into RunResults).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "tlc_output_parser.h"
+
+using tla_visualiser::TLCOutputParser;
+using tla_visualiser::TLCRunner;
+
+static std::string makeLog(std::size_t target_bytes, bool distinct_states) {
+    std::string log;
+    log.reserve(target_bytes + 4096);
+
+    int trace = 0;
+    while (log.size() < target_bytes) {
+        log += "@!@!@STARTMSG 2200:0 @!@!@\n"
+               "Progress(12) at 2024-01-01 12:00:00: 1,843,921 states generated "
+               "(1,843,921 s/min), 232,091 distinct states found (232,091 ds/min), "
+               "10,220 states left on queue.\n"
+               "@!@!@ENDMSG 2200 @!@!@\n";
+
+        log += "@!@!@STARTMSG 2110:1 @!@!@\nInvariant Inv is violated.\n@!@!@ENDMSG 2110 @!@!@\n";
+        for (int step = 1; step <= 50; ++step) {
+            log += "@!@!@STARTMSG 2217:4 @!@!@\n";
+            log += std::to_string(step);
+            log += step == 1 ? ": <Initial predicate>\n"
+                             : ": <Next line 12, col 5 to line 14, col 20 of module Bench>\n";
+            log += "/\\ pc = [p1 |-> \"a\", p2 |-> \"b\", p3 |-> \"c\"]\n";
+            int counter = distinct_states ? trace * 100 + step : step;
+            log += "/\\ counter = " + std::to_string(counter) + "\n";
+            log += "/\\ queue = << 1, 2, 3,\n             4, 5, 6 >>\n";
+            log += "/\\ flag = TRUE\n";
+            log += "@!@!@ENDMSG 2217 @!@!@\n";
+        }
+        ++trace;
+    }
+    return log;
+}
+
+static void run(const char* name, const std::string& log, std::size_t chunk) {
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t offset = 0; offset < log.size(); offset += chunk) {
+        parser.feed(log.data() + offset, std::min(chunk, log.size() - offset));
+    }
+    parser.finish();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double mb = static_cast<double>(log.size()) / (1024.0 * 1024.0);
+    std::printf("%-18s %.1f MB in %.3f s: %.1f MB/s (states=%zu transitions=%zu traces=%zu)\n",
+                name, mb, seconds, mb / seconds, results.states.size(),
+                results.transitions.size(), results.counterexamples.size());
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    std::size_t chunk = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64 * 1024;
+    if (chunk == 0) chunk = 64 * 1024;
+
+    run("recurring states", makeLog(megabytes * 1024 * 1024, false), chunk);
+    run("distinct states", makeLog(megabytes * 1024 * 1024, true), chunk);
+    return 0;
+}
@@ -0,0 +1,128 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Helpers for the binary results file (see results_file.h)
+ *
+ * Values are written in host byte order and arrays are 8-byte aligned
+ * relative to the start of the file, so a memory-mapped file can be read
+ * in place. Reader never trusts the data: every offset and count is
+ * bounds-checked before it is dereferenced.
+ */
+namespace binary_format {
+
+inline constexpr uint64_t padded(uint64_t size) {
+    return (size + 7) & ~uint64_t(7);
+}
+
+/**
+ * @brief Sequential writer that tracks its position for alignment
+ */
+class Writer {
+public:
+    explicit Writer(std::ostream& out, uint64_t position = 0) : out_(out), pos_(position) {}
+
+    template <typename T>
+    void pod(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void array(const T* values, std::size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes(values, count * sizeof(T));
+    }
+
+    void bytes(const void* data, std::size_t size) {
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        pos_ += size;
+    }
+
+    /// Length-prefixed string, padded to 8 bytes
+    void string(std::string_view text) {
+        pod(uint64_t(text.size()));
+        bytes(text.data(), text.size());
+        align();
+    }
+
+    void align() {
+        static const char zeros[8] = {};
+        bytes(zeros, padded(pos_) - pos_);
+    }
+
+    uint64_t position() const { return pos_; }
+    bool ok() const { return out_.good(); }
+
+private:
+    std::ostream& out_;
+    uint64_t pos_;
+};
+
+/**
+ * @brief Bounds-checked cursor over an in-memory (usually mapped) buffer
+ *
+ * All methods return false instead of reading out of range.
+ */
+class Reader {
+public:
+    Reader(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool pod(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (sizeof(T) > size_ - pos_) return false;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool string(std::string_view& text) {
+        uint64_t length = 0;
+        if (!pod(length) || length > size_ - pos_) return false;
+        text = std::string_view(data_ + pos_, static_cast<std::size_t>(length));
+        pos_ = static_cast<std::size_t>(std::min<uint64_t>(padded(pos_ + length), size_));
+        return true;
+    }
+
+    /// Point `values` at `count` elements stored at `offset`, in place
+    template <typename T>
+    bool array(uint64_t offset, uint64_t count, const T*& values) const {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (offset > size_ || count > (size_ - offset) / sizeof(T)) return false;
+        const char* at = data_ + offset;
+        if (reinterpret_cast<std::uintptr_t>(at) % alignof(T) != 0) return false;
+        values = reinterpret_cast<const T*>(at);
+        return true;
+    }
+
+    bool seek(uint64_t offset) {
+        if (offset > size_) return false;
+        pos_ = static_cast<std::size_t>(offset);
+        return true;
+    }
+
+    std::size_t position() const { return pos_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace binary_format
+
+} // namespace tla_visualiser
+
+#endif // BINARY_FORMAT_H
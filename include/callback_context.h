@@ -0,0 +1,137 @@
+#ifndef CALLBACK_CONTEXT_H
+#define CALLBACK_CONTEXT_H
+
+#include <QMetaObject>
+#include <QObject>
+#include <QThread>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Where a worker thread delivers callbacks: the thread of a QObject
+ *
+ * Calls are queued to the object's event loop, or run directly when no
+ * object was given. The object may be destroyed at any time from its own
+ * thread; calls posted after that are dropped, and calls already queued
+ * are discarded with its event queue. Copies share the object's lifetime
+ * tracking, so they can be taken to other threads.
+ */
+class CallbackContext {
+public:
+    CallbackContext() = default;
+
+    explicit CallbackContext(QObject* object) {
+        if (!object) return;
+        guard_ = std::make_shared<Guard>();
+        guard_->object = object;
+        std::weak_ptr<Guard> weak = guard_;
+        guard_->connection = QObject::connect(object, &QObject::destroyed, [weak] {
+            if (auto guard = weak.lock()) {
+                std::lock_guard<std::mutex> lock(guard->mutex);
+                guard->object = nullptr;
+            }
+        });
+    }
+
+    explicit operator bool() const { return guard_ != nullptr; }
+
+    /**
+     * @brief Run `call` on the object's thread
+     *
+     * Queued, or direct when `type` is Qt::AutoConnection and this is the
+     * object's thread. Returns false if the object is already destroyed.
+     */
+    bool post(std::function<void()> call, Qt::ConnectionType type = Qt::QueuedConnection) const {
+        if (!guard_) {
+            call();
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(guard_->mutex);
+        QObject* object = guard_->object;
+        if (!object) return false;
+        if (type == Qt::AutoConnection && object->thread() == QThread::currentThread()) {
+            lock.unlock();
+            call();
+            return true;
+        }
+        // Posted under the lock: `destroyed` waits for it, and the object
+        // then removes the event along with the rest of its queue
+        QMetaObject::invokeMethod(object, std::move(call), Qt::QueuedConnection);
+        return true;
+    }
+
+private:
+    struct Guard {
+        std::mutex mutex;
+        QObject* object = nullptr;   // cleared when it is destroyed
+        QMetaObject::Connection connection;
+
+        ~Guard() { QObject::disconnect(connection); }
+    };
+
+    std::shared_ptr<Guard> guard_;
+};
+
+/**
+ * @brief Latest-value delivery of a frequently updated T to a CallbackContext
+ *
+ * While one delivery is waiting in the context's queue, updates change the
+ * value it will deliver instead of queueing more, so a slow event loop
+ * sees the newest value rather than a backlog. Delivery hands over the
+ * value and leaves a default T for the next updates. Copies share it.
+ */
+template <typename T>
+class CoalescedDelivery {
+public:
+    CoalescedDelivery() = default;
+
+    CoalescedDelivery(CallbackContext context, std::function<void(T)> deliver)
+        : state_(std::make_shared<State>()) {
+        state_->context = std::move(context);
+        state_->deliver = std::move(deliver);
+    }
+
+    explicit operator bool() const { return state_ != nullptr; }
+
+    /**
+     * @brief Apply `change` (called with a T&) to the value to deliver
+     *
+     * Queues a delivery unless one is already waiting to pick the change up.
+     */
+    template <typename Change>
+    void update(Change&& change) const {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            change(state_->value);
+            if (std::exchange(state_->queued, true)) return;
+        }
+        state_->context.post([state = state_] {
+            T value;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->queued = false;
+                value = std::exchange(state->value, T{});
+            }
+            state->deliver(std::move(value));
+        });
+    }
+
+private:
+    struct State {
+        CallbackContext context;
+        std::function<void(T)> deliver;
+        std::mutex mutex;
+        bool queued = false;   // a delivery is waiting in the context's queue
+        T value{};
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace tla_visualiser
+
+#endif // CALLBACK_CONTEXT_H
@@ -1,13 +1,19 @@
 #ifndef GITHUB_IMPORTER_H
 #define GITHUB_IMPORTER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
 
+class QObject;
+
 namespace tla_visualiser {
 
+class ImportCache;
+
 /**
  * @brief Handles importing TLA+ specifications from GitHub URLs
  * 
@@ -15,6 +21,12 @@ namespace tla_visualiser {
  * - File URLs: https://github.com/owner/repo/blob/branch/file.tla
  * - Raw URLs: https://raw.githubusercontent.com/owner/repo/branch/file.tla
  * - Repo URLs: https://github.com/owner/repo
+ *
+ * Files and repositories can be fetched synchronously, on the calling
+ * thread, or asynchronously on the importer's I/O thread, with the result
+ * delivered to a callback. Synchronous calls are for worker threads and
+ * tools; GUI code should use the asynchronous ones. Settings changed
+ * while requests are queued apply to those that start afterwards.
  */
 class GitHubImporter {
 public:
@@ -34,6 +46,26 @@ public:
         std::string sha;
     };
 
+    // How fetched files were obtained
+    struct FetchStats {
+        uint64_t hits = 0;          // from the cache without a request
+        uint64_t revalidated = 0;   // cached copy confirmed unchanged by a 304
+        uint64_t misses = 0;        // downloaded in full
+        uint64_t stale = 0;         // cached copy served because revalidation failed
+        uint64_t failures = 0;      // neither downloaded nor cached
+    };
+
+    using RequestId = uint64_t;
+
+    enum class RequestStatus {
+        Completed,
+        Failed,       // the file could not be fetched, or the repository listed
+        Cancelled
+    };
+
+    using FileCallback = std::function<void(RequestStatus status, const std::string& content)>;
+    using RepositoryCallback = std::function<void(RequestStatus status, const std::vector<FileInfo>& files)>;
+
     GitHubImporter();
     ~GitHubImporter();
 
@@ -46,20 +78,101 @@ public:
 
     /**
      * @brief Fetch a single file from GitHub
+     *
+     * A cached copy is revalidated with a conditional request (ETag,
+     * Last-Modified) and served if unchanged, or if the server cannot be
+     * reached. In offline mode only the cache is used.
+     *
      * @param url_info Parsed URL information
-     * @return File content as string
+     * @return File content as string, empty on failure
      */
     std::string fetchFile(const UrlInfo& url_info);
 
     /**
-     * @brief Fetch all TLA+ files from a repository
+     * @brief Fetch all TLA+ specs and TLC configs from a repository
+     *
+     * Lists the tree through the GitHub API, parsing the listing as it
+     * streams in, then downloads the .tla and .cfg files concurrently over
+     * a few reused connections. Files whose blob SHA is in the import
+     * cache are not downloaded again. Progress is reported in percent as
+     * files arrive. In offline mode, the files cached for the branch are
+     * returned instead.
+     *
      * @param url_info Parsed URL information
-     * @return Vector of FileInfo structures
+     * @return The files that were fetched; failures are left out
      */
     std::vector<FileInfo> fetchRepository(const UrlInfo& url_info);
 
+    /**
+     * @brief Fetch a file on the I/O thread, as fetchFile() does
+     *
+     * Returns at once. Requests are queued and run one at a time, in
+     * order; a request for a file whose request is still queued or running
+     * joins it instead of fetching it again. `callback` is called exactly
+     * once, unless the importer is destroyed first.
+     *
+     * @return Id for cancel()
+     */
+    RequestId fetchFileAsync(const UrlInfo& url_info, FileCallback callback);
+
+    /**
+     * @brief Fetch a repository on the I/O thread, as fetchRepository() does
+     *
+     * Queued and joined like fetchFileAsync(). Progress and listing
+     * callbacks report on the import while it runs.
+     */
+    RequestId fetchRepositoryAsync(const UrlInfo& url_info, RepositoryCallback callback);
+
+    /**
+     * @brief Cancel an asynchronous request
+     *
+     * Its callback is called with RequestStatus::Cancelled. A fetch shared
+     * with other requests carries on for them; otherwise it is dropped
+     * from the queue, or aborted within about 100 ms if it is running.
+     *
+     * @return false if the request already finished or was cancelled
+     */
+    bool cancel(RequestId id);
+
+    /**
+     * @brief Cancel every asynchronous request
+     */
+    void cancelAll();
+
+    /**
+     * @brief Block until every asynchronous request has finished
+     *
+     * Callbacks without a context have then run; those with one are
+     * queued to it.
+     */
+    void waitForIdle();
+
+    /**
+     * @brief Asynchronous requests not yet finished or cancelled
+     */
+    std::size_t pendingRequests() const;
+
+    /**
+     * @brief Deliver asynchronous callbacks on the thread of `context` (e.g. the GUI)
+     *
+     * Completion callbacks of requests submitted from then on, and the
+     * progress and listing callbacks of asynchronous imports, are then
+     * queued to the context's event loop instead of running on the I/O
+     * thread; an import's progress and listing arrive as the latest values
+     * (CoalescedDelivery). Callbacks are never called from within
+     * fetchFileAsync(), fetchRepositoryAsync() or cancel(), and requests
+     * whose context has been destroyed complete without calling back.
+     * Pass nullptr to call back on the I/O thread (or, for cancellations,
+     * the cancelling thread) again.
+     */
+    void setCallbackContext(QObject* context);
+
     /**
      * @brief Save fetched content to local cache
+     *
+     * Stored under its git blob SHA and recorded as the content of
+     * url_info's owner, repo, branch and file path.
+     *
      * @param url_info Source URL information
      * @param content File content to cache
      */
@@ -72,11 +185,50 @@ public:
      */
     std::string loadFromCache(const UrlInfo& url_info);
 
+    /**
+     * @brief Use another import cache, or none (nullptr)
+     *
+     * By default each importer opens one in the user's cache directory.
+     * A cache can be shared between importers.
+     */
+    void setImportCache(std::shared_ptr<ImportCache> cache);
+
+    std::shared_ptr<ImportCache> importCache() const;
+
+    /**
+     * @brief Serve imports from the cache alone, without any requests
+     */
+    void setOfflineMode(bool offline);
+
+    bool offlineMode() const;
+
+    FetchStats fetchStats() const;
+
+    /**
+     * @brief Where API and raw file requests go
+     *
+     * Defaults to https://api.github.com and
+     * https://raw.githubusercontent.com; a GitHub Enterprise host or a
+     * local stand-in server can be used instead.
+     */
+    void setBaseUrls(const std::string& api_base, const std::string& raw_base);
+
     /**
      * @brief Set callback for progress updates
+     *
+     * Synchronous imports call it on their own thread; asynchronous ones on
+     * the I/O thread unless a callback context is set.
      */
     void setProgressCallback(std::function<void(int)> callback);
 
+    /**
+     * @brief Set callback for tree listing updates
+     *
+     * Called while a repository's tree listing streams in, with the number
+     * of entries read so far and how many of them are specs or configs.
+     */
+    void setListingCallback(std::function<void(std::size_t entries, std::size_t matched)> callback);
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -0,0 +1,97 @@
+#ifndef GRAPH_ITEM_H
+#define GRAPH_ITEM_H
+
+#include <QColor>
+#include <QPointF>
+#include <QQuickItem>
+#include <memory>
+#include "state_graph_model.h"
+
+namespace tla_visualiser {
+
+/**
+ * @brief Scene-graph view of a StateGraphModel
+ *
+ * Draws the model's layout through its SpatialIndex: only the grid tiles
+ * in view are drawn, at a level of detail where items stay a few pixels
+ * apart, so zoomed-out views show super-nodes instead of every state.
+ * Each tile's geometry is built once and cached; pan and zoom only change
+ * a transform node.
+ *
+ * Works with every Qt Quick backend: with the software renderer, where
+ * custom geometry nodes are not drawn, tiles are painted by QSGRenderNodes
+ * with batched QPainter calls.
+ *
+ * Item coordinates are layout coordinates * zoom + pan. Dragging pans,
+ * the wheel zooms around the cursor.
+ */
+class GraphItem : public QQuickItem {
+    Q_OBJECT
+    Q_PROPERTY(tla_visualiser::StateGraphModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(qreal zoom READ zoom WRITE setZoom NOTIFY zoomChanged)
+    Q_PROPERTY(QPointF pan READ pan WRITE setPan NOTIFY panChanged)
+    Q_PROPERTY(qreal nodeRadius READ nodeRadius WRITE setNodeRadius NOTIFY nodeRadiusChanged)
+    Q_PROPERTY(QColor nodeColor READ nodeColor WRITE setNodeColor NOTIFY nodeColorChanged)
+    Q_PROPERTY(QColor edgeColor READ edgeColor WRITE setEdgeColor NOTIFY edgeColorChanged)
+    Q_PROPERTY(int detailLevel READ detailLevel NOTIFY detailLevelChanged)
+
+public:
+    explicit GraphItem(QQuickItem* parent = nullptr);
+    ~GraphItem() override;
+
+    StateGraphModel* model() const;
+    void setModel(StateGraphModel* model);
+
+    qreal zoom() const;
+    void setZoom(qreal zoom);
+
+    QPointF pan() const;
+    void setPan(const QPointF& pan);
+
+    qreal nodeRadius() const;      // in layout units
+    void setNodeRadius(qreal radius);
+
+    QColor nodeColor() const;
+    void setNodeColor(const QColor& color);
+
+    QColor edgeColor() const;
+    void setEdgeColor(const QColor& color);
+
+    /// SpatialIndex level drawn at the current zoom; 0 is single nodes
+    int detailLevel() const;
+
+    /**
+     * @brief Zoom and pan so the whole graph fits the item
+     *
+     * Also done automatically when the graph changes, until the user
+     * pans or zooms.
+     */
+    Q_INVOKABLE void fitToView();
+
+signals:
+    void modelChanged();
+    void zoomChanged();
+    void panChanged();
+    void nodeRadiusChanged();
+    void nodeColorChanged();
+    void edgeColorChanged();
+    void detailLevelChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* old_node, UpdatePaintNodeData* data) override;
+    void geometryChange(const QRectF& new_geometry, const QRectF& old_geometry) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+
+private:
+    void reloadGraph();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace tla_visualiser
+
+#endif // GRAPH_ITEM_H
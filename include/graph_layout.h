@@ -0,0 +1,113 @@
+#ifndef GRAPH_LAYOUT_H
+#define GRAPH_LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Node placement for the state graph
+ *
+ * Nodes are 0..node_count-1 (StateStore positions) and edges are pairs of
+ * node indices. Positions use the same (x, y) pairs as StateGraphModel.
+ */
+class GraphLayout {
+public:
+    using Point = std::pair<double, double>;
+    using Edge = std::pair<uint32_t, uint32_t>;
+
+    struct ForceOptions {
+        int iterations = 100;
+        double edge_length = 60.0;   // ideal distance between neighbours
+        double theta = 1.2;          // Barnes-Hut opening angle; 0 is exact
+        unsigned threads = 0;        // 0: one per hardware thread
+    };
+
+    /**
+     * @brief Force-directed (Fruchterman-Reingold) layout
+     *
+     * Repulsion between all nodes is approximated with a Barnes-Hut
+     * quadtree, so each iteration is O(n log n); forces are computed in
+     * parallel. Edges attract their endpoints.
+     *
+     * Warm start: entries already in `positions` are kept as the starting
+     * layout and only refined, so re-laying out a graph that grew moves
+     * existing nodes little. Missing entries are new nodes and start next
+     * to their placed neighbours.
+     *
+     * @param positions In: known positions (may be empty). Out: node_count positions
+     */
+    static void forceDirected(std::size_t node_count, const std::vector<Edge>& edges,
+                              std::vector<Point>& positions, const ForceOptions& options);
+
+    static void forceDirected(std::size_t node_count, const std::vector<Edge>& edges,
+                              std::vector<Point>& positions) {
+        forceDirected(node_count, edges, positions, ForceOptions());
+    }
+
+    /**
+     * @brief Settle the nodes a graph grew by, leaving the rest in place
+     *
+     * Nodes missing from `positions` are new and start beside their placed
+     * neighbours, as in forceDirected(). They and the endpoints of
+     * edges[first_new_edge..] are then relaxed with the same forces and
+     * schedule as a warm start, while every other node stays pinned: the
+     * pinned nodes' repulsion comes from one quadtree built up front, so the
+     * iterations visit only the moved nodes. If most nodes would move, this
+     * is forceDirected() on the whole graph.
+     *
+     * @param moved Receives the nodes that are new or moved, ascending
+     */
+    static void refine(std::size_t node_count, const std::vector<Edge>& edges,
+                       std::size_t first_new_edge, std::vector<Point>& positions,
+                       std::vector<uint32_t>& moved, const ForceOptions& options);
+
+    static void refine(std::size_t node_count, const std::vector<Edge>& edges,
+                       std::size_t first_new_edge, std::vector<Point>& positions,
+                       std::vector<uint32_t>& moved) {
+        refine(node_count, edges, first_new_edge, positions, moved, ForceOptions());
+    }
+
+    struct LayeredOptions {
+        double layer_spacing = 80.0;  // vertical distance between depths
+        double node_spacing = 50.0;   // horizontal distance within a layer
+        int sweeps = 4;               // crossing-reduction passes (down, up, ...)
+    };
+
+    /**
+     * @brief Layered (Sugiyama-style) layout by breadth-first depth
+     *
+     * Layer d holds the nodes first reached at depth d of a BFS along the
+     * edges from the nodes without incoming edges (TLC's initial states);
+     * components without such a node start from their lowest index. Since
+     * BFS depth grows by at most one along an edge, no edge skips a layer
+     * downwards and no dummy nodes are needed.
+     *
+     * Crossings are reduced by barycentre sweeps: each layer is reordered
+     * by the mean position of its neighbours in the adjacent layer, using a
+     * bucket sort, so every sweep is O(nodes + edges).
+     *
+     * @param depths If non-null, receives the layer of each node
+     */
+    static void layered(std::size_t node_count, const std::vector<Edge>& edges,
+                        std::vector<Point>& positions, const LayeredOptions& options,
+                        std::vector<int>* depths = nullptr);
+
+    static void layered(std::size_t node_count, const std::vector<Edge>& edges,
+                        std::vector<Point>& positions) {
+        layered(node_count, edges, positions, LayeredOptions());
+    }
+
+    /**
+     * @brief All nodes on one circle, radius growing with the node count
+     */
+    static void circular(std::size_t node_count, std::vector<Point>& positions,
+                         double radius = 200.0);
+};
+
+} // namespace tla_visualiser
+
+#endif // GRAPH_LAYOUT_H
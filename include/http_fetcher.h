@@ -0,0 +1,106 @@
+#ifndef HTTP_FETCHER_H
+#define HTTP_FETCHER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Concurrent HTTP GETs over a bounded set of keep-alive connections
+ *
+ * Built on a curl multi handle that lives as long as the fetcher, so its
+ * connections (and TLS sessions) are reused across calls. HTTP/2 is
+ * negotiated over TLS and requests to the same host are multiplexed on
+ * one connection; plain HTTP/1.1 hosts get up to max_host_connections
+ * connections, with further requests queued until one is free.
+ *
+ * One call at a time: a fetcher is not shared between threads.
+ */
+class HttpFetcher {
+public:
+    struct Options {
+        int max_connections = 8;        // open at once, all hosts together
+        int max_host_connections = 6;   // per host; HTTP/2 multiplexes within them
+        int max_in_flight = 64;         // requests handed to curl at once
+        long connect_timeout_ms = 10000;
+        long timeout_ms = 60000;        // whole request
+        std::string user_agent = "tla_visualiser/1.0";
+    };
+
+    // Receives the body chunk by chunk; returning false aborts the request
+    using BodySink = std::function<bool(const char* data, std::size_t size)>;
+
+    struct Request {
+        std::string url;                  // percent-encoded
+        std::vector<std::string> headers; // "Name: value"
+        BodySink sink;                    // if set, the body is streamed here
+                                          // instead of kept in Response::body
+    };
+
+    struct Response {
+        std::string url;
+        long status = 0;                  // HTTP status, 0 if none was received
+        std::string body;
+        std::string error;                // transport error or "HTTP <status>"
+        std::string etag;                 // validators for conditional requests
+        std::string last_modified;
+
+        bool ok() const { return error.empty() && status >= 200 && status < 300; }
+
+        // 304 to a conditional request: not ok(), but not an error either
+        bool notModified() const { return error.empty() && status == 304; }
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t failures = 0;
+        uint64_t connections = 0;         // new connections opened
+        uint64_t bytes = 0;               // response bodies, streamed or kept
+    };
+
+    // Called after each finished request with the number finished so far
+    using ProgressCallback = std::function<void(std::size_t done, std::size_t total)>;
+
+    HttpFetcher();
+    explicit HttpFetcher(const Options& options);
+    ~HttpFetcher();
+
+    HttpFetcher(const HttpFetcher&) = delete;
+    HttpFetcher& operator=(const HttpFetcher&) = delete;
+
+    Response get(const Request& request, const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * @brief Fetch every request concurrently
+     *
+     * Setting `cancel`, from any thread, aborts the requests still running
+     * or queued within one poll interval (100 ms); their responses carry
+     * the error "cancelled".
+     *
+     * @return Responses in the order of `requests`
+     */
+    std::vector<Response> fetchAll(const std::vector<Request>& requests,
+                                   const ProgressCallback& progress = ProgressCallback(),
+                                   const std::atomic<bool>* cancel = nullptr);
+
+    Stats stats() const;
+
+    /**
+     * @brief Percent-encode a path, keeping its '/' separators
+     */
+    static std::string escapePath(const std::string& path);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace tla_visualiser
+
+#endif // HTTP_FETCHER_H
@@ -0,0 +1,131 @@
+#ifndef IMPORT_CACHE_H
+#define IMPORT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Content-addressed cache of imported files
+ *
+ * File contents are stored once per git blob SHA, the id GitHub's tree
+ * listings already give every file, so identical files on different
+ * branches or forks share one entry and a changed file can never be
+ * served under its old id. A separate index maps where a file was
+ * imported from (owner, repo, ref, path) to its blob SHA and the HTTP
+ * validators (ETag, Last-Modified) it was served with, so that it can be
+ * revalidated with a conditional request rather than downloaded again.
+ *
+ * The index is held in memory and appended to a compact binary log on
+ * disk, which is rewritten without dead records when it is reopened or
+ * grows too large; lookups never touch the filesystem. Blobs are kept
+ * under a byte budget by evicting the least recently read. Safe to share
+ * between importers.
+ */
+class ImportCache {
+public:
+    static constexpr uint64_t kDefaultMaxBytes = 256ull * 1024 * 1024;
+
+    struct Location {
+        std::string owner;
+        std::string repo;
+        std::string ref;      // branch, tag or commit
+        std::string path;
+    };
+
+    // Of the response a file was downloaded in
+    struct Validators {
+        std::string etag;
+        std::string last_modified;
+
+        bool empty() const { return etag.empty() && last_modified.empty(); }
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        uint64_t bytes = 0;         // blobs on disk
+        std::size_t blobs = 0;
+        std::size_t locations = 0;  // index entries
+    };
+
+    /**
+     * @param directory Created if missing; existing entries are picked up
+     * @param max_bytes Total size of the blobs kept
+     */
+    explicit ImportCache(const std::string& directory, uint64_t max_bytes = kDefaultMaxBytes);
+    ~ImportCache();
+
+    ImportCache(const ImportCache&) = delete;
+    ImportCache& operator=(const ImportCache&) = delete;
+
+    /**
+     * @brief Git blob id of `content` (40 hex digits), as `git hash-object` computes it
+     */
+    static std::string blobSha(std::string_view content);
+
+    /**
+     * @brief Whether a blob is stored, without reading it
+     */
+    bool contains(const std::string& sha) const;
+
+    /**
+     * @brief Read a stored blob
+     * @return false on a miss
+     */
+    bool read(const std::string& sha, std::string& content);
+
+    /**
+     * @brief Store `content` under its blob SHA
+     * @return The SHA, or empty if it could not be written or exceeds the budget alone
+     */
+    std::string store(std::string_view content);
+
+    /**
+     * @brief Blob SHA last recorded for `location`, if that blob is still stored
+     */
+    std::string resolve(const Location& location) const;
+
+    /**
+     * @brief Validators recorded for `location`, empty if none
+     */
+    Validators validators(const Location& location) const;
+
+    /**
+     * @brief Stored files recorded under a ref, as (path, blob SHA) sorted by path
+     */
+    std::vector<std::pair<std::string, std::string>> files(const std::string& owner, const std::string& repo,
+                                                           const std::string& ref) const;
+
+    /**
+     * @brief Record that `location` holds blob `sha`
+     *
+     * Empty validators keep those already recorded for the same blob.
+     */
+    void record(const Location& location, const std::string& sha, const Validators& validators = Validators());
+
+    /**
+     * @brief Remove every blob and index entry
+     */
+    void clear();
+
+    Stats stats() const;
+
+    const std::string& directory() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace tla_visualiser
+
+#endif // IMPORT_CACHE_H
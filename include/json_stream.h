@@ -0,0 +1,90 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Incremental SAX-style JSON parser
+ *
+ * Consumes a JSON document in arbitrary chunks, as it arrives from the
+ * network, and reports each value to a Handler as soon as it is complete.
+ * No tree is built: only the token currently being read (one string or
+ * number) and the stack of open containers are held, so memory use is
+ * bounded by the longest single string rather than the document size.
+ *
+ * Grammar is checked as in RFC 8259. UTF-8 is passed through unchecked,
+ * and lone UTF-16 surrogates in `\u` escapes become U+FFFD.
+ */
+class JsonStreamParser {
+public:
+    /**
+     * @brief Receives parse events in document order
+     *
+     * String views are valid only for the duration of the call.
+     */
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        virtual void startObject() {}
+        virtual void endObject() {}
+        virtual void startArray() {}
+        virtual void endArray() {}
+        virtual void key(std::string_view name) { (void)name; }
+        virtual void string(std::string_view value) { (void)value; }
+        // As written in the document, e.g. "-1.5e3"
+        virtual void number(std::string_view text) { (void)text; }
+        virtual void boolean(bool value) { (void)value; }
+        virtual void null() {}
+    };
+
+    static constexpr std::size_t kDefaultMaxToken = 1 << 20;
+
+    /**
+     * @brief Construct a parser reporting to the given handler
+     * @param handler Event receiver; must outlive the parser
+     * @param max_token Longest string or number accepted, in bytes
+     */
+    explicit JsonStreamParser(Handler& handler, std::size_t max_token = kDefaultMaxToken);
+    ~JsonStreamParser();
+
+    /**
+     * @brief Feed the next chunk of the document
+     * @param data Pointer to the chunk (may split any token)
+     * @param size Number of bytes in the chunk
+     * @return False once the document is known to be malformed
+     */
+    bool feed(const char* data, std::size_t size);
+
+    /**
+     * @brief Signal the end of the document
+     * @return True if exactly one complete value was read
+     */
+    bool finish();
+
+    bool failed() const;
+
+    /**
+     * @brief What went wrong and at which byte offset, if failed()
+     */
+    const std::string& error() const;
+
+    std::size_t bytesConsumed() const;
+
+    /**
+     * @brief Number of bytes currently held for an incomplete token
+     */
+    std::size_t bufferedBytes() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace tla_visualiser
+
+#endif // JSON_STREAM_H
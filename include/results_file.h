@@ -0,0 +1,53 @@
+#ifndef RESULTS_FILE_H
+#define RESULTS_FILE_H
+
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include "tlc_runner.h"
+
+namespace tla_visualiser {
+
+/**
+ * @brief Versioned binary format for archived TLC runs
+ *
+ * A fixed header with the run counters is followed by a section table and
+ * 8-byte aligned sections: a string table, the StateStore, transitions in
+ * compressed sparse rows by source state, invariants and counterexample
+ * traces. Unknown section kinds are skipped, so later versions can add
+ * sections without breaking older readers.
+ *
+ * States are read in place, so a memory-mapped file opens without reading
+ * the bulk of its values; the smaller sections are decoded into RunResults.
+ */
+namespace results_file {
+
+inline constexpr uint32_t kVersion = 1;
+
+/**
+ * @brief True if `data` starts with the results file magic
+ */
+bool isResultsFile(std::string_view data);
+
+/**
+ * @brief Write `results` to a seekable binary stream
+ * @return true if every write succeeded
+ */
+bool write(std::ostream& out, const TLCRunner::RunResults& results);
+
+/**
+ * @brief Decode a results file held in memory
+ * @param data File contents, 8-byte aligned (as a mapping is)
+ * @param backing Owner of `data`; kept alive by the returned states
+ * @param results Replaced on success, untouched on failure
+ * @return false if the file is not a results file of a known version or
+ *         is malformed
+ */
+bool read(std::string_view data, std::shared_ptr<const void> backing,
+          TLCRunner::RunResults& results);
+
+} // namespace results_file
+
+} // namespace tla_visualiser
+
+#endif // RESULTS_FILE_H
@@ -0,0 +1,53 @@
+#ifndef ROLE_CACHE_H
+#define ROLE_CACHE_H
+
+#include <QCache>
+#include <QVariant>
+
+namespace tla_visualiser {
+
+/**
+ * @brief LRU cache of converted role values for list models
+ *
+ * Views call data() for the same rows again and again while scrolling,
+ * and roles such as a state's variables are built as fresh
+ * QVariantList/QVariantMap/QString values each time. Models keep one of
+ * these and convert each (row, role) once; the least recently used
+ * entries are evicted past the capacity. A hit returns a QVariant sharing
+ * the cached data, so it does not allocate.
+ *
+ * Clear it whenever the model resets.
+ */
+class RoleCache {
+public:
+    static constexpr qsizetype kDefaultCapacity = 2048;
+
+    explicit RoleCache(qsizetype capacity = kDefaultCapacity) : cache_(capacity) {}
+
+    /**
+     * @brief The cached value of (row, role), built with `build()` on a miss
+     */
+    template <typename Build>
+    QVariant value(int row, int role, Build&& build) {
+        const quint64 key = (static_cast<quint64>(static_cast<quint32>(row)) << 32) |
+                            static_cast<quint32>(role);
+        if (const QVariant* hit = cache_.object(key)) {
+            return *hit;
+        }
+        auto* entry = new QVariant(build());
+        QVariant result = *entry;
+        cache_.insert(key, entry);   // takes ownership; may evict older entries
+        return result;
+    }
+
+    void clear() { cache_.clear(); }
+
+    qsizetype size() const { return cache_.size(); }
+
+private:
+    QCache<quint64, QVariant> cache_;
+};
+
+} // namespace tla_visualiser
+
+#endif // ROLE_CACHE_H
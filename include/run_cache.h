@@ -0,0 +1,85 @@
+#ifndef RUN_CACHE_H
+#define RUN_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "tlc_options.h"
+#include "tlc_runner.h"
+
+namespace tla_visualiser {
+
+/**
+ * @brief On-disk cache of finished TLC runs, keyed by what they depend on
+ *
+ * The key is a SHA-256 over the spec, every module it EXTENDS or
+ * INSTANCEs that sits next to it (transitively), the config (or, without
+ * one, the <Spec>.cfg TLC reads from beside the spec), the options
+ * that change what TLC reports and the contents of tla2tools.jar.
+ * Resource settings (workers, heap, GC, -fpmem, checkpoints) are left out:
+ * they change how fast TLC gets there, not what it finds.
+ *
+ * Entries are results files (see results_file), one per key, memory-mapped
+ * on lookup. The directory is kept under a byte budget by evicting the
+ * least recently used entries. Safe to share between runners.
+ */
+class RunCache {
+public:
+    static constexpr uint64_t kDefaultMaxBytes = 512ull * 1024 * 1024;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        uint64_t bytes = 0;         // on disk
+        std::size_t entries = 0;
+    };
+
+    /**
+     * @param directory Created if missing; existing entries are picked up
+     * @param max_bytes Total size of the entries kept
+     */
+    explicit RunCache(const std::string& directory, uint64_t max_bytes = kDefaultMaxBytes);
+    ~RunCache();
+
+    RunCache(const RunCache&) = delete;
+    RunCache& operator=(const RunCache&) = delete;
+
+    /**
+     * @brief Cache key of a run (64 hex digits)
+     * @return Empty if the spec cannot be read or the run is not cacheable
+     *         (resuming from a checkpoint)
+     */
+    std::string key(const std::string& spec_file, const std::string& config_file,
+                    const TLCOptions& options) const;
+
+    /**
+     * @brief Stored results for `key`, or nullptr on a miss
+     */
+    std::shared_ptr<const TLCRunner::RunResults> lookup(const std::string& key);
+
+    /**
+     * @brief Store the results of a finished run under `key`
+     * @return false if they could not be written or exceed the budget alone
+     */
+    bool store(const std::string& key, const TLCRunner::RunResults& results);
+
+    /**
+     * @brief Remove every entry
+     */
+    void clear();
+
+    Stats stats() const;
+
+    const std::string& directory() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace tla_visualiser
+
+#endif // RUN_CACHE_H
@@ -0,0 +1,76 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Single-writer, many-reader snapshot of a small trivially copyable value
+ *
+ * The writer never waits; readers retry only if a write overlapped their
+ * read, so a UI polling at frame rate never blocks the thread producing
+ * the value and never sees a half-written one. The value is stored in
+ * atomic words and ordered without standalone fences, which keeps it free
+ * of data races and understood by ThreadSanitizer.
+ *
+ * store() must only be called from one thread at a time.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock needs a trivially copyable type");
+
+public:
+    SeqLock() { store(T{}); }
+    explicit SeqLock(const T& value) { store(value); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    void store(const T& value) {
+        std::array<uint64_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);   // odd: write in progress
+        // Release per word: a reader that sees any new word also sees the
+        // odd sequence stored before it, and retries
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_release);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        std::array<uint64_t, kWords> words;
+        for (;;) {
+            const uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_acquire);
+            }
+            if (sequence_.load(std::memory_order_relaxed) == before) break;
+        }
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence_{0};
+    std::array<std::atomic<uint64_t>, kWords> words_{};
+};
+
+} // namespace tla_visualiser
+
+#endif // SEQLOCK_H
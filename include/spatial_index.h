@@ -0,0 +1,140 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "graph_layout.h"
+
+namespace tla_visualiser {
+
+/**
+ * @brief Grid index and level-of-detail pyramid over a graph layout
+ *
+ * Level 0 items are the nodes themselves. Level 1 merges the nodes of
+ * each cell of a square grid (about four nodes per occupied cell) into one
+ * super-node at their centroid; every further level merges 2x2 cells of
+ * the one below, up to a single item. Each level keeps its items bucketed
+ * by grid cell, plus the edges between items (deduplicated, undirected,
+ * weighted by how many graph edges they stand for).
+ *
+ * A viewer picks the level whose items are far enough apart on screen
+ * (levelFor) and asks only for the cells in its viewport, so the work per
+ * frame depends on what is visible, not on the graph size.
+ *
+ * Built once per layout, or derived from the previous index when only a
+ * few nodes moved (updated()); immutable afterwards and safe to share
+ * between threads.
+ */
+class SpatialIndex {
+public:
+    using Point = GraphLayout::Point;
+    using Edge = GraphLayout::Edge;
+
+    struct Rect {
+        double left, top, right, bottom;
+        bool contains(double x, double y) const {
+            return x >= left && x <= right && y >= top && y <= bottom;
+        }
+    };
+
+    // Inclusive range of grid cells, clamped to the grid
+    struct CellRange {
+        int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+        bool empty() const { return x1 < x0 || y1 < y0; }
+    };
+
+    struct Item {
+        float x, y;
+        uint32_t count;   // nodes merged into this item; 1 at level 0
+        uint32_t node;    // lowest node index among them
+    };
+
+    struct Link {
+        uint32_t to;
+        uint32_t weight;  // graph edges merged into this link
+    };
+
+    SpatialIndex() = default;
+    SpatialIndex(const std::vector<Point>& positions, const std::vector<Edge>& edges);
+
+    /**
+     * @brief This index with the `moved` nodes at their new positions and
+     *        edges[first_new_edge..] added
+     *
+     * Nodes at or past nodeCount() are new, whether listed or not. Only the
+     * items, cells and links the changes reach are patched; item numbers of
+     * coarser levels stay as they were, so an item left empty keeps its
+     * slot with a count of 0 (it is in no cell). The grid and bounds are
+     * kept, so this is a full build instead when a node leaves the bounds,
+     * the node count calls for a finer grid, or most nodes moved.
+     */
+    SpatialIndex updated(const std::vector<Point>& positions, const std::vector<Edge>& edges,
+                         std::size_t first_new_edge, const std::vector<uint32_t>& moved) const;
+
+    std::size_t nodeCount() const { return node_count_; }
+    std::size_t levelCount() const { return levels_.size(); }
+
+    /// Box holding all node positions; their bounding box after a full build
+    Rect bounds() const { return bounds_; }
+
+    /// Cells per side of the grid at `level`
+    int gridSize(std::size_t level) const { return levels_[level].grid; }
+
+    /// Side of one grid cell at `level`, in layout units
+    double cellSize(std::size_t level) const { return levels_[level].cell; }
+
+    /**
+     * @brief Coarsest detail that still shows items at least `min_pixels`
+     *        apart when drawn at `scale` pixels per layout unit
+     *
+     * Returns 0 (single nodes) when zoomed in far enough.
+     */
+    std::size_t levelFor(double scale, double min_pixels) const;
+
+    const std::vector<Item>& items(std::size_t level) const { return levels_[level].items; }
+
+    /// Items linked to `item`, each link listed at both ends
+    std::span<const Link> links(std::size_t level, uint32_t item) const;
+
+    /// Cells at `level` overlapping `rect`
+    CellRange cellRange(std::size_t level, const Rect& rect) const;
+
+    /// Cell of a layout position at `level`, as y * gridSize + x
+    uint32_t cellAt(std::size_t level, double x, double y) const;
+
+    /// Appends the items of every cell in `cells`, cell by cell
+    void collect(std::size_t level, const CellRange& cells, std::vector<uint32_t>& out) const;
+
+    /// Appends the items at `level` whose position lies in `rect`
+    void query(std::size_t level, const Rect& rect, std::vector<uint32_t>& out) const;
+
+private:
+    struct Level {
+        int grid = 1;
+        double cell = 1.0;
+        double spacing = 1.0;                 // typical distance between items
+        std::vector<Item> items;
+        std::vector<uint32_t> item_cells;     // cell of each item
+        std::vector<uint32_t> cell_offsets;   // grid * grid + 1
+        std::vector<uint32_t> cell_items;
+        std::vector<uint32_t> link_offsets;   // items.size() + 1
+        std::vector<Link> links;
+        std::size_t empty_items = 0;          // left with count 0 by updated()
+    };
+
+    void buildLinks(Level& level, std::vector<std::pair<uint64_t, uint32_t>>& pairs);
+    static void bucketItems(Level& level);
+    static void patchLinks(Level& level, std::vector<std::pair<uint64_t, int64_t>>& changes);
+    int64_t itemAt(std::size_t level, uint32_t cell) const;
+
+    std::size_t node_count_ = 0;
+    Rect bounds_{0, 0, 0, 0};
+    double origin_x_ = 0, origin_y_ = 0;
+    std::vector<Level> levels_;
+};
+
+} // namespace tla_visualiser
+
+#endif // SPATIAL_INDEX_H
@@ -2,13 +2,20 @@
 #define STATE_GRAPH_MODEL_H
 
 #include <QAbstractListModel>
+#include <QByteArray>
+#include <QList>
 #include <QObject>
+#include <QRectF>
 #include <QString>
+#include <QStringList>
+#include <memory>
 #include <vector>
 #include "tlc_runner.h"
 
 namespace tla_visualiser {
 
+class SpatialIndex;
+
 /**
  * @brief Qt model for displaying state/transition graph
  * 
@@ -18,8 +25,19 @@ class StateGraphModel : public QAbstractListModel {
     Q_OBJECT
     Q_PROPERTY(int nodeCount READ nodeCount NOTIFY dataChanged)
     Q_PROPERTY(int edgeCount READ edgeCount NOTIFY dataChanged)
+    Q_PROPERTY(LayoutMode layoutMode READ layoutMode WRITE setLayoutMode NOTIFY layoutModeChanged)
+    Q_PROPERTY(QByteArray edgeBuffer READ edgeBuffer NOTIFY graphUpdated)
+    Q_PROPERTY(QByteArray positionBuffer READ positionBuffer NOTIFY graphUpdated)
+    Q_PROPERTY(QStringList actionNames READ actionNames NOTIFY graphUpdated)
 
 public:
+    enum class LayoutMode {
+        Circular,
+        ForceDirected,
+        Layered      // by BFS depth from the initial states
+    };
+    Q_ENUM(LayoutMode)
+
     enum Roles {
         StateIdRole = Qt::UserRole + 1,
         StateDescriptionRole,
@@ -38,6 +56,27 @@ public:
 
     // Custom methods
     Q_INVOKABLE void loadFromResults(const TLCRunner::RunResults& results);
+
+    /**
+     * @brief Show a runner snapshot (TLCRunner::getSnapshot()) in place
+     *
+     * The model reads the snapshot's states directly and keeps it alive
+     * instead of copying them.
+     */
+    void loadFromSnapshot(std::shared_ptr<const TLCRunner::RunResults> snapshot);
+
+    /**
+     * @brief Add the states and transitions of `delta` to the graph
+     *
+     * Rows are inserted (beginInsertRows) rather than the model reset, so
+     * views keep their state and the role cache stays warm. Transitions may
+     * refer to states loaded earlier or in a later delta; the latter are
+     * drawn once their endpoints arrive. A force-directed layout settles
+     * only the new rows and the endpoints of the new transitions, and the
+     * spatial index is patched for the rows that moved; dataChanged covers
+     * just the earlier rows whose position changed.
+     */
+    Q_INVOKABLE void appendResults(const TLCRunner::RunResults& delta);
     Q_INVOKABLE void clear();
     Q_INVOKABLE QVariantList getTransitions() const;
     Q_INVOKABLE QVariantMap getStateDetails(int stateId) const;
@@ -45,8 +84,58 @@ public:
     int nodeCount() const;
     int edgeCount() const;
 
+    /**
+     * @brief Transitions packed for drawing: one int32 triple per edge
+     *
+     * (from row, to row, action id), where rows index this model and the
+     * action id indexes actionNames(). Edges with an unknown endpoint are
+     * left out until both are loaded. Built by loadFromResults() and
+     * extended by appendResults(); QML sees an ArrayBuffer to wrap in an
+     * Int32Array.
+     */
+    QByteArray edgeBuffer() const;
+
+    /**
+     * @brief Node positions packed as float32 (x, y) pairs, one per row
+     *
+     * Rebuilt whenever the layout changes, or patched for the rows
+     * appendResults() moved (graphUpdated).
+     */
+    QByteArray positionBuffer() const;
+
+    QStringList actionNames() const;
+
+    /**
+     * @brief Rows whose position lies in `rect` (layout coordinates)
+     */
+    Q_INVOKABLE QList<int> nodesInRect(const QRectF& rect) const;
+
+    /**
+     * @brief What to draw of `viewport` at `scale` pixels per layout unit
+     *
+     * Single nodes while they are at least `minPixels` apart on screen,
+     * otherwise super-nodes that each merge a grid cell of nodes. Entries
+     * are maps of x, y, count and row (the lowest row merged; the node
+     * itself when count is 1). The cost depends on the viewport, not the
+     * graph size.
+     */
+    Q_INVOKABLE QVariantList viewportItems(const QRectF& viewport, qreal scale,
+                                           qreal minPixels = 6.0) const;
+
+    /**
+     * @brief Grid and level-of-detail index over the current layout
+     *
+     * Rebuilt with every layout and patched by appendResults()
+     * (graphUpdated); null while empty.
+     */
+    std::shared_ptr<const SpatialIndex> spatialIndex() const;
+
+    LayoutMode layoutMode() const;
+    void setLayoutMode(LayoutMode mode);
+
 signals:
     void graphUpdated();
+    void layoutModeChanged();
 
 private:
     class Impl;
@@ -0,0 +1,72 @@
+#ifndef STATE_INDEX_H
+#define STATE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "tlc_runner.h"
+
+namespace tla_visualiser {
+
+/**
+ * @brief Lookup structures over a finished RunResults
+ *
+ * Maps state ids to their position in the StateStore and lists, for each
+ * state, the transitions that lead into it (compressed sparse rows over
+ * RunResults::transitions). Built once per run and shared read-only via
+ * RunResults::index, so models answer id and predecessor queries in O(1)
+ * instead of scanning states and transitions.
+ *
+ * The index holds positions only; it stays valid for any copy of the
+ * RunResults it was built from, but not once states or transitions change.
+ */
+class StateIndex {
+public:
+    StateIndex(const StateStore& states, const std::vector<TLCRunner::Transition>& transitions);
+
+    /**
+     * @brief The shared index of `results`, or a freshly built one if the
+     *        results carry none (e.g. assembled by hand)
+     */
+    static std::shared_ptr<const StateIndex> of(const TLCRunner::RunResults& results);
+
+    /**
+     * @brief Position of the state with this id in the store, or -1
+     *
+     * If several states share an id, the first one wins.
+     */
+    long long indexOf(int state_id) const;
+
+    /**
+     * @brief Positions in RunResults::transitions of the edges into the
+     *        state at `index`, in transition order
+     */
+    std::span<const uint32_t> incoming(std::size_t index) const;
+
+    /**
+     * @brief Position of the transition from `from_id` into the state at
+     *        `index`, falling back to any incoming transition; -1 if none
+     */
+    long long incomingFrom(std::size_t index, int from_id,
+                           const std::vector<TLCRunner::Transition>& transitions) const;
+
+    std::size_t stateCount() const { return state_count_; }
+
+private:
+    std::size_t state_count_ = 0;
+
+    // Ids are usually 0..n-1 in store order (TLCOutputParser numbers them
+    // that way); then no table is needed
+    bool dense_ = true;
+    std::vector<int> slot_ids_;        // open addressing, power-of-two size
+    std::vector<int32_t> slot_index_;  // -1 marks an empty slot
+
+    std::vector<uint32_t> incoming_offsets_;  // state_count_ + 1 entries
+    std::vector<uint32_t> incoming_edges_;
+};
+
+} // namespace tla_visualiser
+
+#endif // STATE_INDEX_H
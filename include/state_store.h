@@ -0,0 +1,194 @@
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tla_visualiser {
+
+namespace binary_format {
+class Writer;
+}
+
+/**
+ * @brief Compact, columnar storage for model-checker states
+ *
+ * Variable names and state descriptions are interned once; each variable
+ * is a column whose values live in one contiguous character arena indexed
+ * by offsets. States are grouped into fixed-size blocks so the arenas grow
+ * without reallocating the whole store.
+ *
+ * Accessors return std::string_view into the store; views stay valid until
+ * the store is modified or destroyed. A variable a state does not define
+ * reads as an empty value.
+ *
+ * A store can also be a zero-copy view of a results file section (see
+ * map()); states added afterwards go to new, owned blocks.
+ *
+ * Copies share blocks: copying a store costs O(blocks) plus the name and
+ * description tables, and appending to either copy afterwards clones only
+ * the last, partial block (copy-on-write). Models keep their own copy of
+ * a growing run this way without duplicating its states.
+ */
+class StateStore {
+public:
+    static constexpr std::size_t kBlockSize = 16384;
+
+    StateStore();
+    ~StateStore();
+    StateStore(const StateStore&);
+    StateStore(StateStore&&) noexcept;
+    StateStore& operator=(const StateStore&);
+    StateStore& operator=(StateStore&&) noexcept;
+
+    /**
+     * @brief Append a state
+     * @param id State identifier
+     * @param description Human-readable label (interned)
+     * @param variables Range of (name, value) pairs convertible to string_view
+     * @return Index of the new state
+     */
+    template <typename Variables>
+    std::size_t add(int id, std::string_view description, const Variables& variables) {
+        std::size_t index = beginState(id, description);
+        for (const auto& variable : variables) {
+            setValue(std::string_view(variable.first), std::string_view(variable.second));
+        }
+        endState();
+        return index;
+    }
+
+    /**
+     * @brief Append the states of `other` from position `first` on
+     * @return Index of the first appended state
+     */
+    std::size_t append(const StateStore& other, std::size_t first = 0);
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void clear();
+
+    int id(std::size_t index) const;
+    std::string_view description(std::size_t index) const;
+
+    /**
+     * @brief Number of distinct variable names (columns) seen so far
+     */
+    std::size_t variableCount() const { return names_.size(); }
+    std::string_view variableName(std::size_t column) const;
+
+    /**
+     * @brief Column index for a variable name, or -1 if unknown
+     */
+    int findVariable(std::string_view name) const;
+
+    /**
+     * @brief Value of variable `column` in state `index` (empty if unset)
+     */
+    std::string_view value(std::size_t index, std::size_t column) const;
+
+    /**
+     * @brief Visit the (name, value) pairs a state defines, in column order
+     */
+    template <typename Visitor>
+    void forEachVariable(std::size_t index, Visitor&& visit) const {
+        for (std::size_t column = 0; column < names_.size(); ++column) {
+            std::string_view v = value(index, column);
+            if (!v.empty()) {
+                visit(std::string_view(names_[column]), v);
+            }
+        }
+    }
+
+    /**
+     * @brief Approximate heap bytes held by the store
+     */
+    std::size_t memoryUsage() const;
+
+    /**
+     * @brief Write the store as a results file section
+     *
+     * The writer must be 8-byte aligned; offsets inside the section are
+     * relative to its start.
+     */
+    void write(binary_format::Writer& out) const;
+
+    /**
+     * @brief Replace the contents with a view of a section written by write()
+     *
+     * Only names, descriptions and the block directory are copied; ids and
+     * values are read in place, so pages of a mapped file are touched on
+     * first access. `section` must be 8-byte aligned.
+     *
+     * @param backing Owner of the memory, kept alive by the store and its copies
+     * @return false if the section is malformed (the store is then empty)
+     */
+    bool map(std::string_view section, std::shared_ptr<const void> backing);
+
+private:
+    struct TransparentHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view text) const {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+    using InternMap = std::unordered_map<std::string, uint32_t, TransparentHash, std::equal_to<>>;
+
+    // Values of one variable for the states of a block:
+    // value i is data[offsets[i], offsets[i + 1])
+    // Mapped blocks leave the vectors empty and use the spans instead.
+    struct Column {
+        std::vector<uint32_t> offsets;
+        std::string data;
+        std::span<const uint32_t> mapped_offsets;
+        std::string_view mapped_data;
+
+        std::span<const uint32_t> offsetSpan() const {
+            return offsets.empty() ? mapped_offsets : std::span<const uint32_t>(offsets);
+        }
+        std::string_view dataView() const {
+            return data.empty() ? mapped_data : std::string_view(data);
+        }
+    };
+
+    struct Block {
+        std::size_t first = 0;               // index of the first state
+        std::vector<int> ids;
+        std::vector<uint32_t> descriptions;  // interned description ids
+        std::vector<Column> columns;         // may be shorter than names_
+        std::span<const int> mapped_ids;
+        std::span<const uint32_t> mapped_descriptions;
+
+        std::size_t size() const { return mapped_ids.empty() ? ids.size() : mapped_ids.size(); }
+    };
+
+    std::size_t beginState(int id, std::string_view description);
+    void setValue(std::string_view name, std::string_view value);
+    void endState();
+
+    const Block& blockFor(std::size_t index, std::size_t& local) const;
+    static uint32_t intern(std::string_view text, InternMap& map, std::vector<std::string>& table);
+
+    std::vector<std::shared_ptr<Block>> blocks_;  // full blocks never change
+    std::vector<std::string> names_;
+    InternMap name_index_;
+    std::vector<std::string> description_table_;
+    InternMap description_index_;
+    std::size_t size_ = 0;
+    std::shared_ptr<const void> backing_;  // memory behind mapped blocks
+
+    // Interning shortcuts for the common case of repeated layouts
+    std::vector<uint32_t> position_columns_;
+    std::size_t next_position_ = 0;
+    uint32_t last_description_ = 0;
+};
+
+} // namespace tla_visualiser
+
+#endif // STATE_STORE_H
@@ -0,0 +1,141 @@
+#ifndef TEXT_SCAN_H
+#define TEXT_SCAN_H
+
+#include <climits>
+#include <cstddef>
+#include <string_view>
+
+namespace tla_visualiser {
+
+/**
+ * @brief Allocation-free scanning primitives over std::string_view
+ *
+ * Shared by the TLC output parser and GitHub URL parsing in place of
+ * std::regex, which is slow and allocates on every match.
+ */
+namespace text_scan {
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+inline std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+    return text;
+}
+
+inline std::string_view firstLine(std::string_view text) {
+    std::size_t end = text.find('\n');
+    return end == std::string_view::npos ? text : text.substr(0, end);
+}
+
+/**
+ * @brief Parse an unsigned decimal number at text[pos], advancing pos
+ * @return The value, or -1 if text[pos] is not a digit
+ */
+inline long long parseNumber(std::string_view text, std::size_t& pos) {
+    if (pos >= text.size() || !isDigit(text[pos])) return -1;
+    long long value = 0;
+    while (pos < text.size() && isDigit(text[pos])) {
+        if (value < LLONG_MAX / 10) value = value * 10 + (text[pos] - '0');
+        ++pos;
+    }
+    return value;
+}
+
+/**
+ * @brief Parse the count immediately preceding `suffix` in `line`
+ *
+ * E.g. 1204 for "1,204 states generated" with suffix "states generated".
+ * Thousands separators are skipped.
+ *
+ * @return The count, or -1 if suffix is absent or not preceded by a number
+ */
+inline long long countBefore(std::string_view line, std::string_view suffix) {
+    std::size_t at = line.find(suffix);
+    if (at == std::string_view::npos) return -1;
+
+    std::size_t end = at;
+    while (end > 0 && line[end - 1] == ' ') --end;
+    std::size_t begin = end;
+    while (begin > 0 && (isDigit(line[begin - 1]) || line[begin - 1] == ',')) --begin;
+    if (begin == end) return -1;
+
+    long long value = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        if (isDigit(line[i]) && value < LLONG_MAX / 10) value = value * 10 + (line[i] - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief Iterates over the '\n'-separated lines of a buffer without copying
+ */
+class LineReader {
+public:
+    explicit LineReader(std::string_view text) : text_(text) {}
+
+    bool next(std::string_view& line) {
+        if (pos_ >= text_.size()) return false;
+        std::size_t end = text_.find('\n', pos_);
+        if (end == std::string_view::npos) end = text_.size();
+        line = text_.substr(pos_, end - pos_);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        pos_ = end + 1;
+        return true;
+    }
+
+private:
+    std::string_view text_;
+    std::size_t pos_ = 0;
+};
+
+/**
+ * @brief Cursor for matching '/'-separated paths such as URLs
+ */
+class PathCursor {
+public:
+    explicit PathCursor(std::string_view text) : rest_(text) {}
+
+    /// Consume `literal` if the remaining text starts with it
+    bool skip(std::string_view literal) {
+        if (!startsWith(rest_, literal)) return false;
+        rest_.remove_prefix(literal.size());
+        return true;
+    }
+
+    /// Consume a non-empty segment up to (and including) the next '/'
+    bool segment(std::string_view& out) {
+        std::size_t slash = rest_.find('/');
+        if (slash == 0 || slash == std::string_view::npos) return false;
+        out = rest_.substr(0, slash);
+        rest_.remove_prefix(slash + 1);
+        return true;
+    }
+
+    /// Consume a non-empty final segment, allowing one trailing '/'
+    bool lastSegment(std::string_view& out) {
+        std::string_view candidate = rest_;
+        if (!candidate.empty() && candidate.back() == '/') candidate.remove_suffix(1);
+        if (candidate.empty() || candidate.find('/') != std::string_view::npos) return false;
+        out = candidate;
+        rest_ = std::string_view();
+        return true;
+    }
+
+    std::string_view rest() const { return rest_; }
+
+private:
+    std::string_view rest_;
+};
+
+} // namespace text_scan
+
+} // namespace tla_visualiser
+
+#endif // TEXT_SCAN_H
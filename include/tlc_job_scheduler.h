@@ -0,0 +1,132 @@
+#ifndef TLC_JOB_SCHEDULER_H
+#define TLC_JOB_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "tlc_runner.h"
+
+namespace tla_visualiser {
+
+/**
+ * @brief Runs many TLC model checks at once within a core budget
+ *
+ * Jobs wait in a queue ordered by priority (higher first, then in
+ * submission order) and run on a pool of TLCRunner instances that is
+ * reused across jobs. Each TLC instance gets a share of the core budget
+ * through `-workers`: when jobs start, the free cores are split evenly
+ * among those that can start now, up to a fair share of the budget
+ * between the jobs queued or running (at most max_concurrent). A job
+ * submitted alone gets every core; a sweep of many configs keeps every
+ * core busy without oversubscribing the machine.
+ *
+ * Results are kept per job and summed into throughput statistics.
+ * Callbacks run on the runner threads.
+ */
+class TLCJobScheduler {
+public:
+    using JobId = uint64_t;
+
+    struct JobSpec {
+        std::string spec_file;
+        std::string config_file;
+        int priority = 0;       // higher runs first
+        int max_workers = 0;    // cap on this job's share; 0: no cap
+        // workers is set from the job's share of the budget; a zero heap
+        // becomes an even split of the machine's memory between the
+        // max_concurrent slots, and the default GC the parallel one
+        TLCOptions options;
+    };
+
+    struct JobResult {
+        JobId id = 0;
+        JobSpec spec;
+        TLCRunner::Status status = TLCRunner::Status::NotStarted;
+        int workers = 0;                 // -workers the job ran with
+        double wall_seconds = 0.0;       // start to finish
+        std::shared_ptr<const TLCRunner::RunResults> results;
+    };
+
+    struct Stats {
+        std::size_t queued = 0;
+        std::size_t running = 0;
+        std::size_t completed = 0;
+        std::size_t failed = 0;
+        std::size_t cancelled = 0;
+        int cores_in_use = 0;
+        uint64_t states_generated = 0;   // summed over finished jobs
+        uint64_t distinct_states = 0;
+        double elapsed_seconds = 0.0;    // since the first job started
+        double states_per_second = 0.0;  // states generated / elapsed
+        double jobs_per_minute = 0.0;    // finished jobs / elapsed
+    };
+
+    /**
+     * @param core_budget Cores shared by all running jobs; 0: all hardware threads
+     * @param max_concurrent Jobs running at once; 0: one per core (one
+     *        worker each, usually the best throughput for sweeps)
+     */
+    explicit TLCJobScheduler(int core_budget = 0, int max_concurrent = 0);
+
+    /**
+     * @brief Cancels everything and waits for the running jobs to stop
+     */
+    ~TLCJobScheduler();
+
+    TLCJobScheduler(const TLCJobScheduler&) = delete;
+    TLCJobScheduler& operator=(const TLCJobScheduler&) = delete;
+
+    int coreBudget() const;
+
+    /**
+     * @brief Queue a model check; it starts as soon as cores are free
+     */
+    JobId submit(const JobSpec& spec);
+
+    /**
+     * @brief Drop a queued job or cancel a running one
+     * @return false if the job is unknown or already finished
+     */
+    bool cancel(JobId id);
+
+    void cancelAll();
+
+    /**
+     * @brief Block until no job is queued or running
+     */
+    void waitForIdle();
+
+    /**
+     * @brief Result of a finished job, if it has finished
+     */
+    std::optional<JobResult> result(JobId id) const;
+
+    /**
+     * @brief Results of all finished jobs, in finishing order
+     */
+    std::vector<JobResult> results() const;
+
+    Stats stats() const;
+
+    /**
+     * @brief Cache shared by every job's runner (see TLCRunner::setRunCache)
+     */
+    void setRunCache(std::shared_ptr<RunCache> cache);
+
+    /**
+     * @brief Called once per finished (or cancelled) job
+     */
+    void setJobFinishedCallback(std::function<void(const JobResult&)> callback);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace tla_visualiser
+
+#endif // TLC_JOB_SCHEDULER_H
@@ -0,0 +1,86 @@
+#ifndef TLC_OPTIONS_H
+#define TLC_OPTIONS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tla_visualiser {
+
+/**
+ * @brief JVM and TLC tuning for a model check
+ *
+ * Zero / empty fields leave the setting to the JVM or TLC, which is what
+ * TLCRunner uses unless told otherwise. autoSized() fills in workers,
+ * heap and GC for the machine.
+ */
+struct TLCOptions {
+    enum class GarbageCollector {
+        Default,    // whatever the JVM picks
+        Parallel,   // throughput collector; what the TLC authors recommend
+        G1
+    };
+
+    // JVM
+    std::string java = "java";
+    std::string tla2tools_jar = "tla2tools.jar";
+    int heap_mb = 0;                          // -Xmx
+    GarbageCollector gc = GarbageCollector::Default;
+    std::vector<std::string> jvm_args;        // passed before -jar
+
+    // TLC
+    int workers = 0;                          // -workers
+    double fpmem = 0.0;                       // -fpmem: share of memory for the fingerprint set (0, 1]
+    int fp_index = -1;                        // -fp: fingerprint polynomial, 0..130
+    int checkpoint_minutes = -1;              // -checkpoint; 0 disables checkpoints
+    std::string recover;                      // -recover: checkpoint directory to resume from
+    std::string metadir;                      // -metadir: where states and checkpoints go
+    std::vector<std::string> tlc_args;        // passed after the options above
+
+    // Warm host: run TLC inside one long-lived JVM (host_source, started
+    // with the JVM settings above) instead of a JVM per run. The runner
+    // falls back to a JVM per run if the host cannot start or dies.
+    bool warm_host = false;
+    std::string host_source = "tools/TLCHost.java";
+
+    /**
+     * @brief Options sized for this machine (or the given one)
+     *
+     * One worker per core, half of the physical memory as heap (at least
+     * 256 MB) and the parallel collector.
+     *
+     * @param cores 0: detect
+     * @param memory_bytes 0: detect
+     */
+    static TLCOptions autoSized(int cores = 0, uint64_t memory_bytes = 0);
+
+    /**
+     * @brief Heap for one of `jobs` JVMs sharing `memory_bytes` (0: detect)
+     */
+    static int autoHeapMb(uint64_t memory_bytes = 0, int jobs = 1);
+
+    static int detectedCores();
+
+    /// Physical memory, or 0 if it cannot be determined
+    static uint64_t detectedMemoryBytes();
+
+    /**
+     * @brief Arguments for `java`: JVM flags, -jar, TLC options, then the spec
+     */
+    std::vector<std::string> arguments(const std::string& spec_file,
+                                       const std::string& config_file = "") const;
+
+    /// The JVM flags alone (heap, GC, jvm_args)
+    std::vector<std::string> jvmArguments() const;
+
+    /// The arguments TLC itself sees: -tool, the TLC options, the spec
+    std::vector<std::string> tlcArguments(const std::string& spec_file,
+                                          const std::string& config_file = "") const;
+
+    /// Arguments for `java` to start the warm host
+    std::vector<std::string> hostArguments() const;
+};
+
+} // namespace tla_visualiser
+
+#endif // TLC_OPTIONS_H
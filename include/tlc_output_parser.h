@@ -0,0 +1,63 @@
+#ifndef TLC_OUTPUT_PARSER_H
+#define TLC_OUTPUT_PARSER_H
+
+#include <cstddef>
+#include <string>
+#include <memory>
+#include <functional>
+#include "tlc_runner.h"
+
+namespace tla_visualiser {
+
+/**
+ * @brief Incremental parser for TLC output
+ *
+ * Consumes TLC output in arbitrary chunks as it is produced and updates
+ * a RunResults structure in place. Output in `-tool` mode is framed into
+ * messages (`@!@!@STARTMSG code:class @!@!@` ... `@!@!@ENDMSG code @!@!@`);
+ * only the message currently being received is buffered, so memory use is
+ * bounded by the largest single message rather than the total output size.
+ * Unframed lines are handled as single-line messages.
+ */
+class TLCOutputParser {
+public:
+    /**
+     * @brief Construct a parser writing into the given results
+     * @param results Results to update; must outlive the parser
+     */
+    explicit TLCOutputParser(TLCRunner::RunResults& results);
+    ~TLCOutputParser();
+
+    /**
+     * @brief Feed a chunk of raw output
+     * @param data Pointer to the chunk (need not end on a line boundary)
+     * @param size Number of bytes in the chunk
+     */
+    void feed(const char* data, std::size_t size);
+
+    /**
+     * @brief Flush any trailing partial line or unterminated message
+     */
+    void finish();
+
+    /**
+     * @brief Set callback for progress updates
+     *
+     * Invoked with the number of distinct states found so far and the
+     * progress message text whenever TLC reports state-space statistics.
+     */
+    void setProgressCallback(std::function<void(int, const std::string&)> callback);
+
+    /**
+     * @brief Number of bytes currently held for incomplete lines/messages
+     */
+    std::size_t bufferedBytes() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+} // namespace tla_visualiser
+
+#endif // TLC_OUTPUT_PARSER_H
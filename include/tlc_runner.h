@@ -5,9 +5,17 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <cstdint>
+#include "state_store.h"
+#include "tlc_options.h"
+
+class QObject;
 
 namespace tla_visualiser {
 
+class StateIndex;
+class RunCache;
+
 /**
  * @brief Manages TLC model checker execution and result parsing
  * 
@@ -24,6 +32,12 @@ public:
         Cancelled
     };
 
+    /**
+     * @brief A single state as standalone strings
+     *
+     * RunResults keeps states in a StateStore; this form is for callers
+     * that need an owned copy of one state.
+     */
     struct State {
         int id;
         std::string description;
@@ -50,7 +64,7 @@ public:
 
     struct RunResults {
         Status status;
-        std::vector<State> states;
+        StateStore states;
         std::vector<Transition> transitions;
         std::vector<Invariant> invariants;
         std::vector<CounterExample> counterexamples;
@@ -58,6 +72,20 @@ public:
         int distinct_states;
         double execution_time_seconds;
         std::string error_message;
+        // Id and predecessor lookups, built once the run has finished
+        // (see StateIndex::of)
+        std::shared_ptr<const StateIndex> index;
+    };
+
+    /**
+     * @brief Live counters of a run, cheap to poll from any thread
+     */
+    struct Progress {
+        Status status = Status::NotStarted;
+        int states_generated = 0;
+        int distinct_states = 0;
+        double elapsed_seconds = 0.0;   // at the last update
+        uint64_t updates = 0;           // bumped on every change
     };
 
     TLCRunner();
@@ -72,6 +100,31 @@ public:
     bool startModelCheck(const std::string& spec_file, 
                          const std::string& config_file = "");
 
+    /**
+     * @brief JVM and TLC tuning for the next runs
+     *
+     * Defaults to TLCOptions(): every setting left to the JVM and TLC.
+     * Pass TLCOptions::autoSized() to size workers, heap and GC for the
+     * machine.
+     */
+    void setOptions(const TLCOptions& options);
+    TLCOptions options() const;
+
+    /**
+     * @brief Shorthand for setting options().workers
+     * @param workers 0 leaves it to TLC (one worker)
+     */
+    void setWorkerCount(int workers);
+
+    /**
+     * @brief Reuse earlier results of unchanged runs
+     *
+     * Before a run starts, its inputs are hashed (see RunCache::key); on a
+     * hit the stored results are published without starting TLC. Runs that
+     * complete are stored. nullptr (the default) disables caching.
+     */
+    void setRunCache(std::shared_ptr<RunCache> cache);
+
     /**
      * @brief Cancel a running model check
      */
@@ -82,22 +135,57 @@ public:
      */
     Status getStatus() const;
 
+    /**
+     * @brief Current counters of the run
+     *
+     * Published by the runner thread through a seqlock: reading never
+     * blocks it, so the UI can poll every frame.
+     */
+    Progress getProgress() const;
+
     /**
      * @brief Get model checking results
-     * @return RunResults structure with all results
+     * @return A copy of the current snapshot; see getSnapshot()
      */
     RunResults getResults() const;
 
+    /**
+     * @brief The current results, shared rather than copied
+     *
+     * Snapshots are immutable and reference-counted: the runner publishes a
+     * new one when a run starts, finishes or results are loaded, and
+     * consumers (models, exports) hold on to the one they were given, so a
+     * large run exists once in memory however many views show it. While a
+     * run is in progress this is the empty snapshot published at its start.
+     * Safe to call from any thread.
+     */
+    std::shared_ptr<const RunResults> getSnapshot() const;
+
     /**
      * @brief Set callback for status updates
+     *
+     * Runs on the runner thread unless a callback context is set.
      */
     void setStatusCallback(std::function<void(Status)> callback);
 
     /**
      * @brief Set callback for progress updates
+     *
+     * Runs on the runner thread unless a callback context is set.
      */
     void setProgressCallback(std::function<void(int, const std::string&)> callback);
 
+    /**
+     * @brief Deliver callbacks on the thread of `context` (e.g. the GUI)
+     *
+     * Callbacks are then queued to the context's event loop instead of
+     * running on the runner thread. Progress arrives as the latest update
+     * (CoalescedDelivery); status changes are all delivered, in order.
+     * Nothing is delivered once `context` is destroyed. Pass nullptr to
+     * call back on the runner thread again. Set before starting a run.
+     */
+    void setCallbackContext(QObject* context);
+
     /**
      * @brief Save run results to file
      * @param filename Path to save results
@@ -108,7 +196,7 @@ public:
     /**
      * @brief Load run results from file
      * @param filename Path to load results from
-     * @return true if loaded successfully
+     * @return true if loaded successfully; false while a run is in progress
      */
     bool loadResults(const std::string& filename);
 
@@ -4,6 +4,7 @@
 #include <QAbstractListModel>
 #include <QObject>
 #include <QString>
+#include <memory>
 #include <vector>
 #include "tlc_runner.h"
 
@@ -39,6 +40,26 @@ public:
     // Custom methods
     Q_INVOKABLE void loadTrace(const TLCRunner::CounterExample& trace,
                                const TLCRunner::RunResults& results);
+
+    /**
+     * @brief Load a trace of a runner snapshot (TLCRunner::getSnapshot())
+     *
+     * Steps read their states from the snapshot, which the model keeps
+     * alive, instead of copies.
+     */
+    void loadTrace(const TLCRunner::CounterExample& trace,
+                   std::shared_ptr<const TLCRunner::RunResults> snapshot);
+
+    /**
+     * @brief Extend the loaded trace with the states of `more`
+     *
+     * For traces that grow while a run is in progress: rows are inserted
+     * instead of the model being reset. `results` must still hold the
+     * states of the steps already loaded, e.g. a later snapshot of the same
+     * run; steps keep only positions into its state store.
+     */
+    Q_INVOKABLE void appendSteps(const TLCRunner::CounterExample& more,
+                                 const TLCRunner::RunResults& results);
     Q_INVOKABLE void clear();
     Q_INVOKABLE QVariantMap getStepDetails(int step) const;
     Q_INVOKABLE QString exportToMarkdown() const;
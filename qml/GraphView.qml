@@ -1,6 +1,7 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
+import TLAVisualiser 1.0
 
 Item {
     id: root
@@ -24,6 +25,7 @@ Item {
 
                 Label {
                     anchors.centerIn: parent
+                    visible: !graphItem.visible
                     text: "State Graph Visualization\n\n" +
                           "Nodes: " + (model ? model.nodeCount : 0) + "\n" +
                           "Edges: " + (model ? model.edgeCount : 0) + "\n\n" +
@@ -32,56 +34,14 @@ Item {
                     color: "#666666"
                 }
 
-                // Simplified graph representation (for demo)
-                Canvas {
-                    id: canvas
+                // Scene-graph renderer: geometry is built once per
+                // graphUpdated; drag to pan, wheel to zoom
+                GraphItem {
+                    id: graphItem
                     anchors.fill: parent
+                    clip: true
                     visible: model && model.nodeCount > 0
-
-                    onPaint: {
-                        if (!model || model.nodeCount === 0) return
-
-                        var ctx = getContext("2d")
-                        ctx.clearRect(0, 0, width, height)
-
-                        // Draw simple circular layout
-                        var centerX = width / 2
-                        var centerY = height / 2
-                        var radius = Math.min(width, height) / 3
-                        var nodeCount = model.nodeCount
-
-                        // Draw edges (simplified)
-                        ctx.strokeStyle = "#999999"
-                        ctx.lineWidth = 2
-                        // Edge drawing would use model.getTransitions()
-
-                        // Draw nodes (limit to 100 for performance)
-                        var maxNodesToShow = Math.min(nodeCount, 100)
-                        for (var i = 0; i < maxNodesToShow; i++) {
-                            var angle = (i / nodeCount) * 2 * Math.PI
-                            var x = centerX + radius * Math.cos(angle)
-                            var y = centerY + radius * Math.sin(angle)
-
-                            ctx.fillStyle = "#4CAF50"
-                            ctx.beginPath()
-                            ctx.arc(x, y, 20, 0, 2 * Math.PI)
-                            ctx.fill()
-
-                            ctx.fillStyle = "#ffffff"
-                            ctx.font = "12px sans-serif"
-                            ctx.textAlign = "center"
-                            ctx.textBaseline = "middle"
-                            ctx.fillText("S" + i, x, y)
-                        }
-                        
-                        // Show indicator if there are more nodes
-                        if (nodeCount > maxNodesToShow) {
-                            ctx.fillStyle = "#666666"
-                            ctx.font = "14px sans-serif"
-                            ctx.textAlign = "center"
-                            ctx.fillText("... and " + (nodeCount - maxNodesToShow) + " more states", centerX, height - 20)
-                        }
-                    }
+                    model: root.model
                 }
             }
         }
@@ -111,6 +71,26 @@ Item {
 
                     Label { text: "Transitions:" }
                     Label { text: model ? model.edgeCount : "0" }
+
+                    Label { text: "Zoom:" }
+                    RowLayout {
+                        Label { text: Math.round(graphItem.zoom * 100) + "%" }
+                        Button {
+                            text: "Fit"
+                            onClicked: graphItem.fitToView()
+                        }
+                    }
+
+                    Label { text: "Layout:" }
+                    ComboBox {
+                        Layout.fillWidth: true
+                        // Order matches StateGraphModel.LayoutMode
+                        model: ["Circular", "Force-directed", "Layered (BFS depth)"]
+                        currentIndex: root.model ? root.model.layoutMode : 1
+                        onActivated: function(index) {
+                            if (root.model) root.model.layoutMode = index
+                        }
+                    }
                 }
 
                 Rectangle {
@@ -1,27 +1,96 @@
 #include "github_importer.h"
-#include <curl/curl.h>
-#include <regex>
-#include <fstream>
-#include <sstream>
+#include "callback_context.h"
+#include "http_fetcher.h"
+#include "import_cache.h"
+#include "json_stream.h"
+#include "text_scan.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 
 namespace tla_visualiser {
 
-// Callback for CURL to write data
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
-}
-
 class GitHubImporter::Impl {
 public:
-    CURL* curl;
-    std::function<void(int)> progress_callback;
+    // What a fetch reads. Copied when it starts, so the setters never race
+    // with the I/O thread.
+    struct Settings {
+        std::string api_base = "https://api.github.com";
+        std::string raw_base = "https://raw.githubusercontent.com";
+        std::shared_ptr<ImportCache> cache;
+        bool offline = false;
+        std::function<void(int)> progress_callback;
+        std::function<void(std::size_t, std::size_t)> listing_callback;
+    };
+
+    // FetchStats, counted from whichever thread fetches
+    struct Counters {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> revalidated{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> stale{0};
+        std::atomic<uint64_t> failures{0};
+    };
+
+    // An asynchronous request, and where its callback goes
+    struct Waiter {
+        RequestId id = 0;
+        FileCallback on_file;
+        RepositoryCallback on_repository;
+        CallbackContext context;
+    };
+
+    // One fetch, shared by every request for the same URL while it is
+    // queued or running
+    struct Job {
+        bool repository = false;
+        UrlInfo url_info;
+        std::string key;
+        std::vector<Waiter> waiters;
+        std::atomic<bool> cancelled{false};
+    };
+
+    // Progress of an asynchronous import since it was last delivered
+    struct ProgressUpdate {
+        bool progress = false;
+        bool listing = false;
+        int percent = 0;
+        std::size_t entries = 0;
+        std::size_t matched = 0;
+    };
+
     std::string cache_dir;
+    mutable std::mutex settings_mutex;
+    Settings current_settings;
+    Counters counters;
+
+    // Synchronous calls from different threads take turns on it
+    std::mutex fetcher_mutex;
+    HttpFetcher fetcher;
+
+    // One I/O thread, started with the first asynchronous request
+    std::thread io_thread;
+    std::unique_ptr<HttpFetcher> io_fetcher;   // used by the I/O thread only
+    mutable std::mutex queue_mutex;
+    std::condition_variable queue_ready;
+    std::condition_variable queue_idle;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::shared_ptr<Job> running;
+    std::unordered_map<std::string, std::shared_ptr<Job>> jobs_by_key;       // queued or running
+    std::unordered_map<RequestId, std::shared_ptr<Job>> jobs_by_request;
+    RequestId next_request = 0;
+    CallbackContext context;
+    bool stopping = false;
 
     Impl() {
-        curl = curl_easy_init();
         // Create cache directory - prefer user-specific cache location
         // Fallback to a subdirectory in temp if user directories unavailable
 #ifdef _WIN32
@@ -54,69 +123,221 @@ public:
         }
 #endif
         std::filesystem::create_directories(cache_dir);
+        current_settings.cache = std::make_shared<ImportCache>(cache_dir);
     }
 
     ~Impl() {
-        if (curl) {
-            curl_easy_cleanup(curl);
+        // Queued requests are dropped without a callback; a running one is aborted
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+            if (running) running->cancelled = true;
         }
+        queue_ready.notify_all();
+        if (io_thread.joinable()) {
+            io_thread.join();
+        }
+    }
+
+    Settings currentSettings() const {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        return current_settings;
     }
 
-    std::string performRequest(const std::string& url) {
-        std::string response;
-        if (!curl) return response;
+    static void reportProgress(const Settings& settings, int percent) {
+        if (settings.progress_callback) settings.progress_callback(percent);
+    }
 
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, "tla_visualiser/1.0");
+    static std::string rawUrl(const Settings& settings, const UrlInfo& url_info, const std::string& path) {
+        return settings.raw_base + "/" + url_info.owner + "/" + url_info.repo + "/" + url_info.branch + "/" +
+               HttpFetcher::escapePath(path);
+    }
 
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "CURL error: " << curl_easy_strerror(res) << std::endl;
-            return "";
-        }
+    static std::string treeUrl(const Settings& settings, const UrlInfo& url_info) {
+        return settings.api_base + "/repos/" + url_info.owner + "/" + url_info.repo + "/git/trees/" +
+               url_info.branch + "?recursive=1";
+    }
 
-        return response;
+    static ImportCache::Location locationOf(const UrlInfo& url_info, const std::string& path) {
+        return {url_info.owner, url_info.repo, url_info.branch, path};
     }
+
+    static bool isCancelled(const std::atomic<bool>* cancel) {
+        return cancel && cancel->load();
+    }
+
+    // Stores a downloaded file and where it came from
+    static void remember(const Settings& settings, const ImportCache::Location& location,
+                         const HttpFetcher::Response& response) {
+        if (!settings.cache) return;
+        const std::string sha = settings.cache->store(response.body);
+        if (!sha.empty()) settings.cache->record(location, sha, {response.etag, response.last_modified});
+    }
+
+    // The fetches behind both the synchronous and asynchronous calls.
+    // They return false on failure or once `cancel` is set.
+    bool fetchFile(const Settings& settings, HttpFetcher& http, const UrlInfo& url_info,
+                   std::string& content, const std::atomic<bool>* cancel);
+    bool fetchRepository(const Settings& settings, HttpFetcher& http, const UrlInfo& url_info,
+                         std::vector<FileInfo>& files, const std::atomic<bool>* cancel);
+
+    RequestId submit(bool repository, const UrlInfo& url_info, std::string key, Waiter waiter);
+    bool cancel(RequestId id);
+    void ioLoop();
+    static void deliver(const Waiter& waiter, RequestStatus status,
+                        const std::shared_ptr<const std::string>& content,
+                        const std::shared_ptr<const std::vector<FileInfo>>& files);
+    static void deliverProgressTo(const CallbackContext& target, Settings& settings);
 };
 
 GitHubImporter::GitHubImporter() : pImpl(std::make_unique<Impl>()) {}
 
 GitHubImporter::~GitHubImporter() = default;
 
+namespace {
+
+// Match "<host>/owner/repo/<marker>/branch/path" starting right after host.
+// An empty marker matches "<host>/owner/repo/branch/path".
+bool matchFilePath(std::string_view text, std::string_view marker,
+                   GitHubImporter::UrlInfo& info) {
+    text_scan::PathCursor cursor(text);
+    std::string_view owner, repo, branch;
+    if (!cursor.segment(owner) || !cursor.segment(repo)) return false;
+    if (!marker.empty() && !cursor.skip(marker)) return false;
+    if (!cursor.segment(branch)) return false;
+
+    // The path runs to the end of the line
+    std::string_view path = text_scan::firstLine(cursor.rest());
+    if (path.empty()) return false;
+
+    info.owner = std::string(owner);
+    info.repo = std::string(repo);
+    info.branch = std::string(branch);
+    info.file_path = std::string(path);
+    return true;
+}
+
+// Match "owner/repo" with an optional trailing slash and nothing after it
+bool matchRepoPath(std::string_view text, GitHubImporter::UrlInfo& info) {
+    text_scan::PathCursor cursor(text);
+    std::string_view owner, repo;
+    if (!cursor.segment(owner) || !cursor.lastSegment(repo)) return false;
+
+    info.owner = std::string(owner);
+    info.repo = std::string(repo);
+    return true;
+}
+
+bool endsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// Files a repository import brings in: specs and their TLC configs
+bool isSpecFile(std::string_view path) {
+    return endsWith(path, ".tla") || endsWith(path, ".cfg");
+}
+
+/**
+ * Picks specs and configs out of a GitHub recursive tree listing,
+ *
+ *   {"sha": ..., "tree": [{"path": ..., "type": "blob", "sha": ...}, ...],
+ *    "truncated": false}
+ *
+ * as it streams through a JsonStreamParser. Only matching entries are kept.
+ */
+class TreeListing : public JsonStreamParser::Handler {
+public:
+    std::vector<GitHubImporter::FileInfo> files;
+    std::size_t entries = 0;
+    bool truncated = false;
+
+    void startObject() override {
+        if (++depth == kEntryDepth && in_tree) {
+            path.clear();
+            type.clear();
+            sha.clear();
+        }
+    }
+
+    void endObject() override {
+        if (depth-- == kEntryDepth && in_tree) {
+            ++entries;
+            if (type == "blob" && isSpecFile(path)) {
+                files.push_back({path, std::string(), sha});
+            }
+        }
+    }
+
+    void startArray() override {
+        if (++depth == kTreeDepth && last_key == "tree") in_tree = true;
+    }
+
+    void endArray() override {
+        if (depth-- == kTreeDepth) in_tree = false;
+    }
+
+    void key(std::string_view name) override {
+        last_key.assign(name);
+    }
+
+    void string(std::string_view value) override {
+        if (depth != kEntryDepth || !in_tree) return;
+        if (last_key == "path") {
+            path.assign(value);
+        } else if (last_key == "type") {
+            type.assign(value);
+        } else if (last_key == "sha") {
+            sha.assign(value);
+        }
+    }
+
+    void boolean(bool value) override {
+        if (depth == kRootDepth && last_key == "truncated") truncated = value;
+    }
+
+private:
+    static constexpr int kRootDepth = 1;
+    static constexpr int kTreeDepth = 2;
+    static constexpr int kEntryDepth = 3;
+
+    int depth = 0;
+    bool in_tree = false;
+    std::string last_key;
+    std::string path;
+    std::string type;
+    std::string sha;
+};
+
+// Try `match` after every occurrence of `host` in `url`, first match wins
+template <typename Match>
+bool matchAfterHost(std::string_view url, std::string_view host, Match match) {
+    for (std::size_t at = url.find(host); at != std::string_view::npos; at = url.find(host, at + 1)) {
+        if (match(url.substr(at + host.size()))) return true;
+    }
+    return false;
+}
+
+} // namespace
+
 GitHubImporter::UrlInfo GitHubImporter::parseUrl(const std::string& url) {
     UrlInfo info{};
     
-    // Pattern for file URL: https://github.com/owner/repo/blob/branch/path/file.tla
-    std::regex file_pattern(R"(github\.com/([^/]+)/([^/]+)/blob/([^/]+)/(.+))");
-    
-    // Pattern for raw URL: https://raw.githubusercontent.com/owner/repo/branch/path/file.tla
-    std::regex raw_pattern(R"(raw\.githubusercontent\.com/([^/]+)/([^/]+)/([^/]+)/(.+))");
-    
-    // Pattern for repo URL: https://github.com/owner/repo
-    std::regex repo_pattern(R"(github\.com/([^/]+)/([^/]+)/?$)");
-    
-    std::smatch match;
-    
-    if (std::regex_search(url, match, file_pattern)) {
-        info.owner = match[1];
-        info.repo = match[2];
-        info.branch = match[3];
-        info.file_path = match[4];
+    // File URL: https://github.com/owner/repo/blob/branch/path/file.tla
+    if (matchAfterHost(url, "github.com/", [&info](std::string_view rest) {
+            return matchFilePath(rest, "blob/", info);
+        })) {
         info.is_file_url = true;
         info.is_raw_url = false;
-    } else if (std::regex_search(url, match, raw_pattern)) {
-        info.owner = match[1];
-        info.repo = match[2];
-        info.branch = match[3];
-        info.file_path = match[4];
+    // Raw URL: https://raw.githubusercontent.com/owner/repo/branch/path/file.tla
+    } else if (matchAfterHost(url, "raw.githubusercontent.com/", [&info](std::string_view rest) {
+            return matchFilePath(rest, "", info);
+        })) {
         info.is_file_url = true;
         info.is_raw_url = true;
-    } else if (std::regex_search(url, match, repo_pattern)) {
-        info.owner = match[1];
-        info.repo = match[2];
+    // Repo URL: https://github.com/owner/repo
+    } else if (matchAfterHost(url, "github.com/", [&info](std::string_view rest) {
+            return matchRepoPath(rest, info);
+        })) {
         info.branch = "main"; // Default branch
         info.is_file_url = false;
         info.is_raw_url = false;
@@ -125,84 +346,431 @@ GitHubImporter::UrlInfo GitHubImporter::parseUrl(const std::string& url) {
     return info;
 }
 
-std::string GitHubImporter::fetchFile(const UrlInfo& url_info) {
-    // Check cache first
-    std::string cached = loadFromCache(url_info);
-    if (!cached.empty()) {
-        return cached;
+bool GitHubImporter::Impl::fetchFile(const Settings& settings, HttpFetcher& http, const UrlInfo& url_info,
+                                     std::string& content, const std::atomic<bool>* cancel) {
+    const ImportCache::Location location = locationOf(url_info, url_info.file_path);
+    std::string cached;
+    const std::string sha = settings.cache ? settings.cache->resolve(location) : std::string();
+    const bool have = !sha.empty() && settings.cache->read(sha, cached);
+
+    if (settings.offline) {
+        if (have) {
+            ++counters.hits;
+            content = std::move(cached);
+            return true;
+        }
+        ++counters.failures;
+        std::cerr << "Offline: " << url_info.file_path << " is not cached" << std::endl;
+        return false;
     }
 
-    // Build raw URL
-    std::string raw_url = "https://raw.githubusercontent.com/" +
-                         url_info.owner + "/" +
-                         url_info.repo + "/" +
-                         url_info.branch + "/" +
-                         url_info.file_path;
+    // A cached copy is revalidated: unchanged, it costs a 304 and no body
+    HttpFetcher::Request request{rawUrl(settings, url_info, url_info.file_path), {}};
+    if (have) {
+        const ImportCache::Validators validators = settings.cache->validators(location);
+        if (!validators.etag.empty()) {
+            request.headers.push_back("If-None-Match: " + validators.etag);
+        }
+        if (!validators.last_modified.empty()) {
+            request.headers.push_back("If-Modified-Since: " + validators.last_modified);
+        }
+    }
+    HttpFetcher::Response response = http.get(request, cancel);
+    if (isCancelled(cancel)) return false;
+    if (have && response.notModified()) {
+        ++counters.revalidated;
+        content = std::move(cached);
+        return true;
+    }
+    if (!response.ok()) {
+        std::cerr << "HTTP error: " << response.error << " (" << request.url << ")" << std::endl;
+        // Unreachable or failing server: better the last known copy than
+        // none. A 404 means the file is gone.
+        if (have && (response.status == 0 || response.status >= 500)) {
+            ++counters.stale;
+            content = std::move(cached);
+            return true;
+        }
+        ++counters.failures;
+        return false;
+    }
 
-    std::string content = pImpl->performRequest(raw_url);
-    
-    if (!content.empty()) {
-        cacheContent(url_info, content);
+    ++counters.misses;
+    remember(settings, location, response);
+    content = std::move(response.body);
+    return true;
+}
+
+bool GitHubImporter::Impl::fetchRepository(const Settings& settings, HttpFetcher& http, const UrlInfo& url_info,
+                                           std::vector<FileInfo>& files, const std::atomic<bool>* cancel) {
+    reportProgress(settings, 0);
+
+    if (settings.offline) {
+        // No listing without the network: whatever was imported from this
+        // branch before
+        if (settings.cache) {
+            for (auto& [path, sha] : settings.cache->files(url_info.owner, url_info.repo, url_info.branch)) {
+                FileInfo file{path, std::string(), sha};
+                if (isSpecFile(path) && settings.cache->read(sha, file.content)) {
+                    ++counters.hits;
+                    files.push_back(std::move(file));
+                }
+            }
+        }
+        reportProgress(settings, 100);
+        return true;
     }
-    
+
+    // One request lists the whole tree
+    const std::string api_url = treeUrl(settings, url_info);
+
+    // The listing runs to tens of MB for large monorepos: parse it as it
+    // arrives and keep only the entries an import needs
+    TreeListing listing;
+    JsonStreamParser parser(listing);
+    std::size_t reported = 0;
+    HttpFetcher::Request request{api_url, {"Accept: application/vnd.github+json"}};
+    request.sink = [&settings, &parser, &listing, &reported](const char* data, std::size_t size) {
+        if (!parser.feed(data, size)) return false;
+        if (listing.entries != reported && settings.listing_callback) {
+            reported = listing.entries;
+            settings.listing_callback(listing.entries, listing.files.size());
+        }
+        return true;
+    };
+    HttpFetcher::Response tree = http.get(request, cancel);
+    if (isCancelled(cancel)) return false;
+    // A listing the parser rejected was aborted, which curl reports as a
+    // write error
+    if (!tree.ok() && (tree.status >= 300 || !parser.failed())) {
+        std::cerr << "HTTP error: " << tree.error << " (" << api_url << ")" << std::endl;
+        return false;
+    }
+    if (parser.failed() || !parser.finish()) {
+        std::cerr << "Malformed tree listing: " << parser.error() << " (" << api_url << ")" << std::endl;
+        return false;
+    }
+    if (listing.truncated) {
+        std::cerr << "Warning: GitHub truncated the tree listing of " << url_info.owner << "/"
+                  << url_info.repo << "; some files are missing" << std::endl;
+    }
+    std::vector<FileInfo> listed = std::move(listing.files);
+    if (listed.empty()) {
+        reportProgress(settings, 100);
+        return true;
+    }
+    reportProgress(settings, 5);
+
+    // Blobs cached under their SHA need no request, whichever branch or
+    // fork they were first imported from
+    std::vector<bool> have(listed.size(), false);
+    std::vector<std::size_t> requested;   // index into listed per request
+    std::vector<HttpFetcher::Request> requests;
+    for (std::size_t i = 0; i < listed.size(); ++i) {
+        if (settings.cache && settings.cache->read(listed[i].sha, listed[i].content)) {
+            have[i] = true;
+            ++counters.hits;
+            settings.cache->record(locationOf(url_info, listed[i].path), listed[i].sha);
+        } else {
+            requested.push_back(i);
+            requests.push_back({rawUrl(settings, url_info, listed[i].path), {}});
+        }
+    }
+
+    // Then every other spec and config at once, over a few reused connections
+    const std::size_t cached = listed.size() - requests.size();
+    std::vector<HttpFetcher::Response> responses = http.fetchAll(
+        requests, [&settings, cached, total = listed.size()](std::size_t done, std::size_t) {
+            reportProgress(settings, 5 + static_cast<int>(95 * (cached + done) / total));
+        }, cancel);
+    if (isCancelled(cancel)) return false;
+    if (requests.empty()) reportProgress(settings, 100);
+
+    for (std::size_t k = 0; k < requests.size(); ++k) {
+        FileInfo& file = listed[requested[k]];
+        if (!responses[k].ok()) {
+            std::cerr << "HTTP error: " << responses[k].error << " (" << responses[k].url << ")" << std::endl;
+            ++counters.failures;
+            continue;
+        }
+        ++counters.misses;
+        remember(settings, locationOf(url_info, file.path), responses[k]);
+        file.content = std::move(responses[k].body);
+        have[requested[k]] = true;
+    }
+
+    // Keep what arrived; a file that failed is left out
+    files.reserve(listed.size());
+    for (std::size_t i = 0; i < listed.size(); ++i) {
+        if (have[i]) files.push_back(std::move(listed[i]));
+    }
+    return true;
+}
+
+GitHubImporter::RequestId GitHubImporter::Impl::submit(bool repository, const UrlInfo& url_info,
+                                                       std::string key, Waiter waiter) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    waiter.id = ++next_request;
+    waiter.context = context;
+    const RequestId id = waiter.id;
+
+    std::shared_ptr<Job>& job = jobs_by_key[key];
+    if (!job) {
+        job = std::make_shared<Job>();
+        job->repository = repository;
+        job->url_info = url_info;
+        job->key = std::move(key);
+        queue.push_back(job);
+        queue_ready.notify_one();
+    }
+    job->waiters.push_back(std::move(waiter));
+    jobs_by_request.emplace(id, job);
+
+    if (!io_thread.joinable()) {
+        io_thread = std::thread(&Impl::ioLoop, this);
+    }
+    return id;
+}
+
+bool GitHubImporter::Impl::cancel(RequestId id) {
+    Waiter waiter;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        auto found = jobs_by_request.find(id);
+        if (found == jobs_by_request.end()) return false;
+        std::shared_ptr<Job> job = std::move(found->second);
+        jobs_by_request.erase(found);
+
+        auto it = std::find_if(job->waiters.begin(), job->waiters.end(),
+                               [id](const Waiter& w) { return w.id == id; });
+        waiter = std::move(*it);
+        job->waiters.erase(it);
+
+        // Nobody is left waiting for the fetch
+        if (job->waiters.empty()) {
+            job->cancelled = true;
+            auto keyed = jobs_by_key.find(job->key);
+            if (keyed != jobs_by_key.end() && keyed->second == job) jobs_by_key.erase(keyed);
+            queue.erase(std::remove(queue.begin(), queue.end(), job), queue.end());
+            if (queue.empty() && !running) queue_idle.notify_all();
+        }
+    }
+    static const auto no_content = std::make_shared<const std::string>();
+    static const auto no_files = std::make_shared<const std::vector<FileInfo>>();
+    deliver(waiter, RequestStatus::Cancelled, no_content, no_files);
+    return true;
+}
+
+void GitHubImporter::Impl::ioLoop() {
+    io_fetcher = std::make_unique<HttpFetcher>();
+    for (;;) {
+        std::shared_ptr<Job> job;
+        CallbackContext progress_context;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_ready.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) break;
+            job = queue.front();
+            queue.pop_front();
+            running = job;
+            progress_context = context;
+        }
+
+        Settings job_settings = currentSettings();
+        deliverProgressTo(progress_context, job_settings);
+        std::string content;
+        std::vector<FileInfo> files;
+        const bool ok = job->repository
+            ? fetchRepository(job_settings, *io_fetcher, job->url_info, files, &job->cancelled)
+            : fetchFile(job_settings, *io_fetcher, job->url_info, content, &job->cancelled);
+
+        // Requests from here on start a new fetch, even from the callbacks below
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (stopping) break;   // the importer is going away: no callbacks
+            auto keyed = jobs_by_key.find(job->key);
+            if (keyed != jobs_by_key.end() && keyed->second == job) jobs_by_key.erase(keyed);
+            waiters = std::move(job->waiters);
+            for (const Waiter& waiter : waiters) jobs_by_request.erase(waiter.id);
+        }
+
+        // Every waiter left wants the result; cancelled ones were told already
+        const RequestStatus status = ok ? RequestStatus::Completed : RequestStatus::Failed;
+        auto shared_content = std::make_shared<const std::string>(std::move(content));
+        auto shared_files = std::make_shared<const std::vector<FileInfo>>(std::move(files));
+        for (const Waiter& waiter : waiters) {
+            deliver(waiter, status, shared_content, shared_files);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            running.reset();
+            if (queue.empty()) queue_idle.notify_all();
+        }
+    }
+}
+
+void GitHubImporter::Impl::deliver(const Waiter& waiter, RequestStatus status,
+                                   const std::shared_ptr<const std::string>& content,
+                                   const std::shared_ptr<const std::vector<FileInfo>>& files) {
+    auto call = [on_file = waiter.on_file, on_repository = waiter.on_repository, status, content, files] {
+        if (on_file) on_file(status, *content);
+        if (on_repository) on_repository(status, *files);
+    };
+    waiter.context.post(std::move(call));
+}
+
+void GitHubImporter::Impl::deliverProgressTo(const CallbackContext& target, Settings& job_settings) {
+    if (!target || (!job_settings.progress_callback && !job_settings.listing_callback)) return;
+
+    CoalescedDelivery<ProgressUpdate> pending(target, [progress = job_settings.progress_callback,
+                                                       listing = job_settings.listing_callback](ProgressUpdate update) {
+        if (update.listing && listing) listing(update.entries, update.matched);
+        if (update.progress && progress) progress(update.percent);
+    });
+    if (job_settings.progress_callback) {
+        job_settings.progress_callback = [pending](int percent) {
+            pending.update([percent](ProgressUpdate& update) {
+                update.percent = percent;
+                update.progress = true;
+            });
+        };
+    }
+    if (job_settings.listing_callback) {
+        job_settings.listing_callback = [pending](std::size_t entries, std::size_t matched) {
+            pending.update([entries, matched](ProgressUpdate& update) {
+                update.entries = entries;
+                update.matched = matched;
+                update.listing = true;
+            });
+        };
+    }
+}
+
+std::string GitHubImporter::fetchFile(const UrlInfo& url_info) {
+    const Impl::Settings settings = pImpl->currentSettings();
+    std::lock_guard<std::mutex> lock(pImpl->fetcher_mutex);
+    std::string content;
+    pImpl->fetchFile(settings, pImpl->fetcher, url_info, content, nullptr);
     return content;
 }
 
 std::vector<GitHubImporter::FileInfo> GitHubImporter::fetchRepository(const UrlInfo& url_info) {
+    const Impl::Settings settings = pImpl->currentSettings();
+    std::lock_guard<std::mutex> lock(pImpl->fetcher_mutex);
     std::vector<FileInfo> files;
-    
-    // Use GitHub API to list repository contents
-    std::string api_url = "https://api.github.com/repos/" +
-                         url_info.owner + "/" +
-                         url_info.repo + "/git/trees/" +
-                         url_info.branch + "?recursive=1";
-    
-    std::string response = pImpl->performRequest(api_url);
-    
-    // Parse response and find .tla files (simplified - real implementation would use JSON parser)
-    // For now, return empty vector as this requires JSON parsing library
-    
+    pImpl->fetchRepository(settings, pImpl->fetcher, url_info, files, nullptr);
     return files;
 }
 
+GitHubImporter::RequestId GitHubImporter::fetchFileAsync(const UrlInfo& url_info, FileCallback callback) {
+    Impl::Waiter waiter;
+    waiter.on_file = std::move(callback);
+    const std::string key = "file " + Impl::rawUrl(pImpl->currentSettings(), url_info, url_info.file_path);
+    return pImpl->submit(false, url_info, key, std::move(waiter));
+}
+
+GitHubImporter::RequestId GitHubImporter::fetchRepositoryAsync(const UrlInfo& url_info,
+                                                               RepositoryCallback callback) {
+    Impl::Waiter waiter;
+    waiter.on_repository = std::move(callback);
+    const std::string key = "tree " + Impl::treeUrl(pImpl->currentSettings(), url_info);
+    return pImpl->submit(true, url_info, key, std::move(waiter));
+}
+
+bool GitHubImporter::cancel(RequestId id) {
+    return pImpl->cancel(id);
+}
+
+void GitHubImporter::cancelAll() {
+    std::vector<RequestId> ids;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->queue_mutex);
+        for (const auto& [id, job] : pImpl->jobs_by_request) ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    for (RequestId id : ids) pImpl->cancel(id);
+}
+
+void GitHubImporter::waitForIdle() {
+    std::unique_lock<std::mutex> lock(pImpl->queue_mutex);
+    pImpl->queue_idle.wait(lock, [this] { return pImpl->queue.empty() && !pImpl->running; });
+}
+
+std::size_t GitHubImporter::pendingRequests() const {
+    std::lock_guard<std::mutex> lock(pImpl->queue_mutex);
+    return pImpl->jobs_by_request.size();
+}
+
+void GitHubImporter::setCallbackContext(QObject* context) {
+    CallbackContext next(context);
+    std::lock_guard<std::mutex> lock(pImpl->queue_mutex);
+    pImpl->context = std::move(next);
+}
+
 void GitHubImporter::cacheContent(const UrlInfo& url_info, const std::string& content) {
-    std::string cache_file = pImpl->cache_dir + "/" +
-                            url_info.owner + "_" +
-                            url_info.repo + "_" +
-                            url_info.branch + "_" +
-                            url_info.file_path;
-    
-    // Replace both forward and backward slashes with underscores
-    std::replace(cache_file.begin(), cache_file.end(), '/', '_');
-    std::replace(cache_file.begin(), cache_file.end(), '\\', '_');
-    
-    std::ofstream out(cache_file);
-    if (out) {
-        out << content;
+    const std::shared_ptr<ImportCache> cache = importCache();
+    if (!cache) return;
+    const std::string sha = cache->store(content);
+    if (!sha.empty()) {
+        cache->record(Impl::locationOf(url_info, url_info.file_path), sha);
     }
 }
 
 std::string GitHubImporter::loadFromCache(const UrlInfo& url_info) {
-    std::string cache_file = pImpl->cache_dir + "/" +
-                            url_info.owner + "_" +
-                            url_info.repo + "_" +
-                            url_info.branch + "_" +
-                            url_info.file_path;
-    
-    // Replace both forward and backward slashes with underscores
-    std::replace(cache_file.begin(), cache_file.end(), '/', '_');
-    std::replace(cache_file.begin(), cache_file.end(), '\\', '_');
-    
-    std::ifstream in(cache_file);
-    if (!in) return "";
-    
-    std::stringstream buffer;
-    buffer << in.rdbuf();
-    return buffer.str();
+    const std::shared_ptr<ImportCache> cache = importCache();
+    if (!cache) return "";
+    std::string content;
+    const std::string sha = cache->resolve(Impl::locationOf(url_info, url_info.file_path));
+    if (sha.empty() || !cache->read(sha, content)) return "";
+    return content;
+}
+
+void GitHubImporter::setImportCache(std::shared_ptr<ImportCache> cache) {
+    std::lock_guard<std::mutex> lock(pImpl->settings_mutex);
+    pImpl->current_settings.cache = std::move(cache);
+}
+
+std::shared_ptr<ImportCache> GitHubImporter::importCache() const {
+    std::lock_guard<std::mutex> lock(pImpl->settings_mutex);
+    return pImpl->current_settings.cache;
+}
+
+void GitHubImporter::setOfflineMode(bool offline) {
+    std::lock_guard<std::mutex> lock(pImpl->settings_mutex);
+    pImpl->current_settings.offline = offline;
+}
+
+bool GitHubImporter::offlineMode() const {
+    std::lock_guard<std::mutex> lock(pImpl->settings_mutex);
+    return pImpl->current_settings.offline;
+}
+
+GitHubImporter::FetchStats GitHubImporter::fetchStats() const {
+    FetchStats stats;
+    stats.hits = pImpl->counters.hits;
+    stats.revalidated = pImpl->counters.revalidated;
+    stats.misses = pImpl->counters.misses;
+    stats.stale = pImpl->counters.stale;
+    stats.failures = pImpl->counters.failures;
+    return stats;
+}
+
+void GitHubImporter::setBaseUrls(const std::string& api_base, const std::string& raw_base) {
+    std::lock_guard<std::mutex> lock(pImpl->settings_mutex);
+    pImpl->current_settings.api_base = api_base;
+    pImpl->current_settings.raw_base = raw_base;
 }
 
 void GitHubImporter::setProgressCallback(std::function<void(int)> callback) {
-    pImpl->progress_callback = callback;
+    std::lock_guard<std::mutex> lock(pImpl->settings_mutex);
+    pImpl->current_settings.progress_callback = callback;
+}
+
+void GitHubImporter::setListingCallback(std::function<void(std::size_t, std::size_t)> callback) {
+    std::lock_guard<std::mutex> lock(pImpl->settings_mutex);
+    pImpl->current_settings.listing_callback = callback;
 }
 
 } // namespace tla_visualiser
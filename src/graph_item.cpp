@@ -0,0 +1,477 @@
+#include "graph_item.h"
+#include "spatial_index.h"
+#include <QMatrix4x4>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+#include <QSGTransformNode>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tla_visualiser {
+
+namespace {
+
+// Vertices per geometry node. Bounded so one batch never needs a huge
+// single upload and the renderer can still merge or cull batches.
+constexpr int kBatchVertices = 1 << 16;
+
+// Margin kept around the graph by fitToView(), in pixels
+constexpr qreal kFitMargin = 10.0;
+
+// Level of detail: items closer than this on screen are merged
+constexpr qreal kMinItemPixels = 6.0;
+
+// Geometry is built and cached per tile of kTileCells x kTileCells grid
+// cells of the current detail level. Hidden tiles stay cached (up to
+// kMaxTiles) so panning back or zooming across a level boundary is free.
+constexpr int kTileCells = 16;
+constexpr std::size_t kMaxTiles = 512;
+
+struct Style {
+    qreal node_radius = 8.0;
+    QColor node_color;
+    QColor edge_color;
+};
+
+// One tile in layout coordinates: edges of its items and a square per item
+struct TileContent {
+    std::vector<QLineF> lines;
+    std::vector<QRectF> squares;
+    QRectF bounds;
+};
+
+TileContent buildTile(const SpatialIndex& index, std::size_t level,
+                      const SpatialIndex::CellRange& cells, qreal node_radius) {
+    TileContent tile;
+    std::vector<uint32_t> members;
+    index.collect(level, cells, members);
+
+    const auto& items = index.items(level);
+    const double cell = index.cellSize(level);
+    const int grid = index.gridSize(level);
+    auto in_tile = [&](const SpatialIndex::Item& item) {
+        const uint32_t c = index.cellAt(level, item.x, item.y);
+        const int cx = static_cast<int>(c % grid), cy = static_cast<int>(c / grid);
+        return cx >= cells.x0 && cx <= cells.x1 && cy >= cells.y0 && cy <= cells.y1;
+    };
+
+    qreal reach = node_radius;
+    for (uint32_t i : members) {
+        const SpatialIndex::Item& item = items[i];
+        // Super-nodes grow with the nodes they merge, within their cell
+        const qreal r = level == 0 || item.count == 1
+            ? node_radius
+            : std::max(node_radius, std::min(0.45 * cell, 0.15 * cell * std::sqrt(item.count)));
+        reach = std::max(reach, r);
+        tile.squares.emplace_back(item.x - r, item.y - r, 2 * r, 2 * r);
+
+        // Edges inside the tile are drawn once, edges leaving it by both
+        // tiles, so a tile never depends on its neighbours being shown
+        for (const SpatialIndex::Link& link : index.links(level, i)) {
+            const SpatialIndex::Item& other = items[link.to];
+            if (link.to < i && in_tile(other)) continue;
+            tile.lines.emplace_back(item.x, item.y, other.x, other.y);
+        }
+    }
+    tile.bounds = QRectF(index.bounds().left + cells.x0 * cell - reach,
+                         index.bounds().top + cells.y0 * cell - reach,
+                         (cells.x1 - cells.x0 + 1) * cell + 2 * reach,
+                         (cells.y1 - cells.y0 + 1) * cell + 2 * reach);
+    return tile;
+}
+
+QSGGeometryNode* makeBatch(int vertex_count, unsigned int drawing_mode, const QColor& color) {
+    auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), vertex_count);
+    geometry->setDrawingMode(drawing_mode);
+    geometry->setLineWidth(1);
+
+    auto* material = new QSGFlatColorMaterial;
+    material->setColor(color);
+
+    auto* node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setFlag(QSGNode::OwnsGeometry);
+    node->setMaterial(material);
+    node->setFlag(QSGNode::OwnsMaterial);
+    return node;
+}
+
+// Hardware backends: edges as line batches, items as two-triangle quads
+void appendBatches(QSGNode* parent, const TileContent& tile, const Style& style) {
+    std::size_t e = 0;
+    while (e < tile.lines.size()) {
+        const std::size_t batch = std::min<std::size_t>(tile.lines.size() - e, kBatchVertices / 2);
+        QSGGeometryNode* node = makeBatch(static_cast<int>(2 * batch), QSGGeometry::DrawLines,
+                                          style.edge_color);
+        QSGGeometry::Point2D* v = node->geometry()->vertexDataAsPoint2D();
+        for (std::size_t end = e + batch; e < end; ++e) {
+            const QLineF& line = tile.lines[e];
+            (v++)->set(line.x1(), line.y1());
+            (v++)->set(line.x2(), line.y2());
+        }
+        node->markDirty(QSGNode::DirtyGeometry);
+        parent->appendChildNode(node);
+    }
+
+    std::size_t n = 0;
+    while (n < tile.squares.size()) {
+        const std::size_t batch = std::min<std::size_t>(tile.squares.size() - n, kBatchVertices / 6);
+        QSGGeometryNode* node = makeBatch(static_cast<int>(6 * batch), QSGGeometry::DrawTriangles,
+                                          style.node_color);
+        QSGGeometry::Point2D* v = node->geometry()->vertexDataAsPoint2D();
+        for (std::size_t end = n + batch; n < end; ++n) {
+            const QRectF& r = tile.squares[n];
+            const float x0 = r.left(), y0 = r.top(), x1 = r.right(), y1 = r.bottom();
+            v[0].set(x0, y0);
+            v[1].set(x1, y0);
+            v[2].set(x0, y1);
+            v[3].set(x1, y0);
+            v[4].set(x1, y1);
+            v[5].set(x0, y1);
+            v += 6;
+        }
+        node->markDirty(QSGNode::DirtyGeometry);
+        parent->appendChildNode(node);
+    }
+}
+
+// Software backend: custom geometry is not drawn there, so a tile paints
+// its lines and squares with one drawLines and one drawRects call. The
+// transform node above supplies pan and zoom.
+class SoftwareTileNode : public QSGRenderNode {
+public:
+    SoftwareTileNode(QQuickWindow* window, TileContent tile, const Style& style)
+        : window_(window), tile_(std::move(tile)), style_(style) {}
+
+    void render(const RenderState* state) override {
+        QSGRendererInterface* renderer = window_->rendererInterface();
+        auto* painter = static_cast<QPainter*>(
+            renderer->getResource(window_, QSGRendererInterface::PainterResource));
+        if (!painter) return;
+
+        const QRegion* clip = state->clipRegion();
+        if (clip && !clip->isEmpty()) painter->setClipRegion(*clip, Qt::ReplaceClip);
+        painter->setTransform(matrix()->toTransform());
+        painter->setOpacity(inheritedOpacity());
+        painter->setRenderHint(QPainter::Antialiasing, false);
+
+        painter->setPen(QPen(style_.edge_color, 0));   // cosmetic: 1px at any zoom
+        painter->setBrush(Qt::NoBrush);
+        painter->drawLines(tile_.lines.data(), static_cast<int>(tile_.lines.size()));
+
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(style_.node_color);
+        painter->drawRects(tile_.squares.data(), static_cast<int>(tile_.squares.size()));
+    }
+
+    StateFlags changedStates() const override { return {}; }
+    RenderingFlags flags() const override { return BoundedRectRendering; }
+    QRectF rect() const override { return tile_.bounds; }
+
+private:
+    QQuickWindow* window_;
+    TileContent tile_;
+    Style style_;
+};
+
+// Parent of one tile's geometry; hiding it skips the whole subtree
+class TileNode : public QSGNode {
+public:
+    bool isSubtreeBlocked() const override { return hidden; }
+
+    void setHidden(bool value) {
+        if (value == hidden) return;
+        hidden = value;
+        markDirty(QSGNode::DirtySubtreeBlocked);
+    }
+
+    bool hidden = false;
+    uint64_t last_frame = 0;
+};
+
+uint64_t tileKey(std::size_t level, int tx, int ty) {
+    return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(ty) << 24) |
+           static_cast<uint64_t>(tx);
+}
+
+} // namespace
+
+class GraphItem::Impl {
+public:
+    QPointer<StateGraphModel> model;
+    QMetaObject::Connection graph_connection;
+
+    qreal zoom = 1.0;
+    QPointF pan;
+    bool user_moved = false;   // stop auto-fitting once the user navigates
+    QPointF drag_from;
+
+    Style style;
+    std::shared_ptr<const SpatialIndex> index;
+    QRectF bounds;              // layout coordinates, nodes included
+    bool scene_dirty = true;
+
+    // Owned by the scene graph (children of the root node); touched only
+    // in updatePaintNode, while the GUI thread waits
+    std::unordered_map<uint64_t, TileNode*> tiles;
+    uint64_t frame = 0;
+
+    void updateBounds() {
+        if (!index || index->nodeCount() == 0) {
+            bounds = QRectF();
+            return;
+        }
+        const SpatialIndex::Rect b = index->bounds();
+        const qreal r = style.node_radius;
+        bounds = QRectF(QPointF(b.left - r, b.top - r), QPointF(b.right + r, b.bottom + r));
+    }
+
+    std::size_t detailLevel() const {
+        return index ? index->levelFor(zoom, kMinItemPixels) : 0;
+    }
+
+    QMatrix4x4 transform() const {
+        QMatrix4x4 matrix;
+        matrix.translate(static_cast<float>(pan.x()), static_cast<float>(pan.y()));
+        matrix.scale(static_cast<float>(zoom));
+        return matrix;
+    }
+
+    void clearTiles(QSGNode* root) {
+        while (QSGNode* child = root->firstChild()) {
+            root->removeChildNode(child);
+            delete child;
+        }
+        tiles.clear();
+    }
+
+    // Shows the tiles covering `view` (layout coordinates) at `level`,
+    // building the missing ones; everything else is hidden
+    void showTiles(QSGNode* root, QQuickWindow* window, std::size_t level, const QRectF& view) {
+        ++frame;
+        const SpatialIndex::CellRange cells = index->cellRange(
+            level, {view.left(), view.top(), view.right(), view.bottom()});
+        const bool software = window->rendererInterface()->graphicsApi() ==
+                              QSGRendererInterface::Software;
+
+        if (!cells.empty()) {
+            const int grid = index->gridSize(level);
+            for (int ty = cells.y0 / kTileCells; ty <= cells.y1 / kTileCells; ++ty) {
+                for (int tx = cells.x0 / kTileCells; tx <= cells.x1 / kTileCells; ++tx) {
+                    TileNode*& tile = tiles[tileKey(level, tx, ty)];
+                    if (!tile) {
+                        SpatialIndex::CellRange range{tx * kTileCells, ty * kTileCells,
+                                                      std::min(grid, (tx + 1) * kTileCells) - 1,
+                                                      std::min(grid, (ty + 1) * kTileCells) - 1};
+                        TileContent content = buildTile(*index, level, range, style.node_radius);
+                        tile = new TileNode;
+                        if (software) {
+                            tile->appendChildNode(new SoftwareTileNode(window, std::move(content), style));
+                        } else {
+                            appendBatches(tile, content, style);
+                        }
+                        root->appendChildNode(tile);
+                    }
+                    tile->setHidden(false);
+                    tile->last_frame = frame;
+                }
+            }
+        }
+
+        std::vector<std::pair<uint64_t, uint64_t>> hidden;   // (last frame, key)
+        for (const auto& [key, tile] : tiles) {
+            if (tile->last_frame == frame) continue;
+            tile->setHidden(true);
+            hidden.push_back({tile->last_frame, key});
+        }
+        if (tiles.size() > kMaxTiles) {
+            // Drop the tiles unseen for longest
+            const std::size_t excess = std::min(tiles.size() - kMaxTiles, hidden.size());
+            std::partial_sort(hidden.begin(), hidden.begin() + excess, hidden.end());
+            for (std::size_t i = 0; i < excess; ++i) {
+                TileNode* tile = tiles[hidden[i].second];
+                root->removeChildNode(tile);
+                delete tile;
+                tiles.erase(hidden[i].second);
+            }
+        }
+    }
+};
+
+GraphItem::GraphItem(QQuickItem* parent)
+    : QQuickItem(parent), pImpl(std::make_unique<Impl>()) {
+    pImpl->style.node_color = QColor("#4CAF50");
+    pImpl->style.edge_color = QColor("#999999");
+    setFlag(ItemHasContents);
+    setAcceptedMouseButtons(Qt::LeftButton);
+}
+
+GraphItem::~GraphItem() = default;
+
+StateGraphModel* GraphItem::model() const {
+    return pImpl->model;
+}
+
+void GraphItem::setModel(StateGraphModel* model) {
+    if (model == pImpl->model) return;
+    disconnect(pImpl->graph_connection);
+    pImpl->model = model;
+    if (model) {
+        pImpl->graph_connection = connect(model, &StateGraphModel::graphUpdated,
+                                          this, &GraphItem::reloadGraph);
+    }
+    pImpl->user_moved = false;
+    reloadGraph();
+    emit modelChanged();
+}
+
+qreal GraphItem::zoom() const {
+    return pImpl->zoom;
+}
+
+void GraphItem::setZoom(qreal zoom) {
+    if (!(zoom > 0) || qFuzzyCompare(zoom, pImpl->zoom)) return;
+    const int level = detailLevel();
+    pImpl->zoom = zoom;
+    update();
+    emit zoomChanged();
+    if (detailLevel() != level) emit detailLevelChanged();
+}
+
+QPointF GraphItem::pan() const {
+    return pImpl->pan;
+}
+
+void GraphItem::setPan(const QPointF& pan) {
+    if (pan == pImpl->pan) return;
+    pImpl->pan = pan;
+    update();
+    emit panChanged();
+}
+
+qreal GraphItem::nodeRadius() const {
+    return pImpl->style.node_radius;
+}
+
+void GraphItem::setNodeRadius(qreal radius) {
+    if (qFuzzyCompare(radius, pImpl->style.node_radius)) return;
+    pImpl->style.node_radius = radius;
+    pImpl->updateBounds();
+    pImpl->scene_dirty = true;
+    update();
+    emit nodeRadiusChanged();
+}
+
+QColor GraphItem::nodeColor() const {
+    return pImpl->style.node_color;
+}
+
+void GraphItem::setNodeColor(const QColor& color) {
+    if (color == pImpl->style.node_color) return;
+    pImpl->style.node_color = color;
+    pImpl->scene_dirty = true;
+    update();
+    emit nodeColorChanged();
+}
+
+QColor GraphItem::edgeColor() const {
+    return pImpl->style.edge_color;
+}
+
+void GraphItem::setEdgeColor(const QColor& color) {
+    if (color == pImpl->style.edge_color) return;
+    pImpl->style.edge_color = color;
+    pImpl->scene_dirty = true;
+    update();
+    emit edgeColorChanged();
+}
+
+int GraphItem::detailLevel() const {
+    return static_cast<int>(pImpl->detailLevel());
+}
+
+void GraphItem::fitToView() {
+    const QRectF& bounds = pImpl->bounds;
+    if (bounds.isEmpty() || width() <= 2 * kFitMargin || height() <= 2 * kFitMargin) return;
+
+    const qreal zoom = std::min((width() - 2 * kFitMargin) / bounds.width(),
+                                (height() - 2 * kFitMargin) / bounds.height());
+    setZoom(zoom);
+    setPan(QPointF(width() / 2, height() / 2) - bounds.center() * zoom);
+}
+
+void GraphItem::reloadGraph() {
+    pImpl->index = pImpl->model ? pImpl->model->spatialIndex() : nullptr;
+    pImpl->updateBounds();
+    pImpl->scene_dirty = true;
+    if (!pImpl->user_moved) fitToView();
+    update();
+}
+
+QSGNode* GraphItem::updatePaintNode(QSGNode* old_node, UpdatePaintNodeData*) {
+    auto* root = static_cast<QSGTransformNode*>(old_node);
+    if (!root) {
+        // First frame, or the scene graph was released with our nodes
+        root = new QSGTransformNode;
+        pImpl->tiles.clear();
+        pImpl->scene_dirty = false;
+    }
+    if (pImpl->scene_dirty) {
+        pImpl->clearTiles(root);
+        pImpl->scene_dirty = false;
+    }
+
+    // Pan and zoom only move the transform; geometry is built per tile
+    // the first time the tile is in view at the current detail level
+    root->setMatrix(pImpl->transform());
+    if (pImpl->index && pImpl->index->nodeCount() > 0) {
+        const QRectF view((QPointF(0, 0) - pImpl->pan) / pImpl->zoom,
+                          QSizeF(width(), height()) / pImpl->zoom);
+        pImpl->showTiles(root, window(), pImpl->detailLevel(), view);
+    }
+    return root;
+}
+
+void GraphItem::geometryChange(const QRectF& new_geometry, const QRectF& old_geometry) {
+    QQuickItem::geometryChange(new_geometry, old_geometry);
+    if (!pImpl->user_moved && new_geometry.size() != old_geometry.size()) fitToView();
+}
+
+void GraphItem::mousePressEvent(QMouseEvent* event) {
+    pImpl->drag_from = event->position();
+    event->accept();
+}
+
+void GraphItem::mouseMoveEvent(QMouseEvent* event) {
+    pImpl->user_moved = true;
+    setPan(pImpl->pan + event->position() - pImpl->drag_from);
+    pImpl->drag_from = event->position();
+    event->accept();
+}
+
+void GraphItem::mouseReleaseEvent(QMouseEvent* event) {
+    event->accept();
+}
+
+void GraphItem::wheelEvent(QWheelEvent* event) {
+    // 120 units per notch; one notch zooms by ~20%, keeping the point
+    // under the cursor fixed
+    const qreal factor = std::pow(1.2, event->angleDelta().y() / 120.0);
+    const QPointF cursor = event->position();
+    pImpl->user_moved = true;
+    setPan(cursor - (cursor - pImpl->pan) * factor);
+    setZoom(pImpl->zoom * factor);
+    event->accept();
+}
+
+} // namespace tla_visualiser
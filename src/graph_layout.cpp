@@ -0,0 +1,648 @@
+#include "graph_layout.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace tla_visualiser {
+
+namespace {
+
+// Deeper cells hold nodes that (nearly) coincide; stop splitting there.
+// Float cell bounds cannot resolve much further anyway.
+constexpr int kMaxDepth = 24;
+constexpr double kMinDistance2 = 1e-6;
+
+uint64_t mix64(uint64_t x) {
+    // splitmix64 finaliser
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Deterministic value in [-0.5, 0.5) so layouts are reproducible
+double jitter(uint64_t seed) {
+    return static_cast<double>(mix64(seed) >> 11) * 0x1.0p-53 - 0.5;
+}
+
+template <typename Body>
+void parallelFor(std::size_t count, unsigned threads, const Body& body) {
+    if (threads <= 1 || count < 4096) {
+        body(std::size_t(0), count);
+        return;
+    }
+    std::size_t chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t begin = chunk; begin < count; begin += chunk) {
+        workers.emplace_back(body, begin, std::min(count, begin + chunk));
+    }
+    body(std::size_t(0), std::min(count, chunk));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+uint64_t spreadBits(uint32_t v) {
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+// Node indices sorted along a Z-order curve. Visiting nodes in this order
+// keeps consecutive quadtree walks on the same cells, which matters more
+// for speed than anything else in the force loop.
+void spatialOrder(const std::vector<GraphLayout::Point>& points, std::vector<uint32_t>& order) {
+    double min_x = points[0].first, max_x = min_x;
+    double min_y = points[0].second, max_y = min_y;
+    for (const auto& [x, y] : points) {
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
+    double scale = 65535.0 / std::max({max_x - min_x, max_y - min_y, 1e-9});
+    std::vector<std::pair<uint64_t, uint32_t>> keyed(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        auto qx = static_cast<uint32_t>((points[i].first - min_x) * scale);
+        auto qy = static_cast<uint32_t>((points[i].second - min_y) * scale);
+        keyed[i] = {spreadBits(qx) | (spreadBits(qy) << 1), static_cast<uint32_t>(i)};
+    }
+    std::sort(keyed.begin(), keyed.end());
+    order.resize(points.size());
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+        order[i] = keyed[i].second;
+    }
+}
+
+/**
+ * Barnes-Hut quadtree over the node positions of one iteration. Each cell
+ * stores the total mass and centre of mass of the nodes below it, so the
+ * repulsion of a distant cell is one term instead of one per node.
+ */
+class QuadTree {
+public:
+    void build(const std::vector<GraphLayout::Point>& points, const std::vector<uint32_t>& order) {
+        cells_.clear();
+        sums_.clear();
+        if (points.empty()) return;
+        cells_.reserve(points.size() * 2 + 4);
+        sums_.reserve(points.size() * 2 + 4);
+
+        double min_x = points[0].first, max_x = min_x;
+        double min_y = points[0].second, max_y = min_y;
+        for (const auto& [x, y] : points) {
+            min_x = std::min(min_x, x);
+            max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y);
+            max_y = std::max(max_y, y);
+        }
+        Cell root;
+        root.cx = static_cast<float>((min_x + max_x) / 2);
+        root.cy = static_cast<float>((min_y + max_y) / 2);
+        root.half = static_cast<float>(std::max(max_x - min_x, max_y - min_y) / 2 + 1.0);
+        cells_.push_back(root);
+        sums_.push_back({0, 0});
+
+        for (uint32_t i : order) {
+            insert(points, static_cast<int32_t>(i));
+        }
+        for (std::size_t c = 0; c < cells_.size(); ++c) {
+            if (cells_[c].mass > 0) {
+                cells_[c].mx = static_cast<float>(sums_[c].first / cells_[c].mass);
+                cells_[c].my = static_cast<float>(sums_[c].second / cells_[c].mass);
+            }
+        }
+    }
+
+    // Repulsive force k^2 / d on node i from every other node
+    void repulsion(const std::vector<GraphLayout::Point>& points, std::size_t i,
+                   double k2, double theta2, double& fx, double& fy) const {
+        const double x = points[i].first;
+        const double y = points[i].second;
+        int32_t stack[4 * kMaxDepth + 8];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Cell& cell = cells_[stack[--top]];
+            if (cell.mass == 0) continue;
+
+            double dx = x - cell.mx;
+            double dy = y - cell.my;
+            double d2 = dx * dx + dy * dy;
+            bool inside = std::abs(x - cell.cx) <= cell.half && std::abs(y - cell.cy) <= cell.half;
+
+            if (cell.child >= 0) {
+                double width = 2 * cell.half;
+                if (inside || width * width >= theta2 * d2) {
+                    for (int q = 0; q < 4; ++q) stack[top++] = cell.child + q;
+                    continue;
+                }
+            }
+
+            double mass = cell.mass;
+            if (cell.child < 0 && cell.body == static_cast<int32_t>(i)) {
+                mass -= 1;  // the node itself (plus any coincident ones)
+                if (mass == 0) continue;
+            }
+            if (d2 < kMinDistance2) {
+                // Coincident nodes: push apart in a fixed pseudo-random direction
+                dx = jitter(i * 2 + 1);
+                dy = jitter(i * 2 + 2);
+                d2 = dx * dx + dy * dy + kMinDistance2;
+            }
+            double f = mass * k2 / d2;
+            fx += dx * f;
+            fy += dy * f;
+        }
+    }
+
+private:
+    // 32 bytes, so two cells share a cache line; float precision is
+    // ample for forces
+    struct Cell {
+        float cx = 0, cy = 0, half = 0;   // square bounds
+        float mx = 0, my = 0;             // centre of mass
+        float mass = 0;
+        int32_t child = -1;               // first of four children, or -1 for a leaf
+        int32_t body = -1;                // node held by a leaf
+    };
+
+    std::vector<Cell> cells_;
+    std::vector<std::pair<double, double>> sums_;  // position sums while building
+
+    static int quadrant(const Cell& cell, double x, double y) {
+        return (x >= cell.cx ? 1 : 0) + (y >= cell.cy ? 2 : 0);
+    }
+
+    void insert(const std::vector<GraphLayout::Point>& points, int32_t body) {
+        const double x = points[body].first;
+        const double y = points[body].second;
+        int32_t c = 0;
+        for (int depth = 0;; ++depth) {
+            sums_[c].first += x;
+            sums_[c].second += y;
+            cells_[c].mass += 1;
+
+            if (cells_[c].child < 0) {
+                if (cells_[c].body < 0) {
+                    cells_[c].body = body;
+                    return;
+                }
+                if (depth >= kMaxDepth) {
+                    return;  // keep coincident nodes aggregated in this leaf
+                }
+                // Split the leaf and push its node down one level
+                int32_t first = static_cast<int32_t>(cells_.size());
+                float half = cells_[c].half / 2;
+                for (int q = 0; q < 4; ++q) {
+                    Cell child;
+                    child.half = half;
+                    child.cx = cells_[c].cx + (q & 1 ? half : -half);
+                    child.cy = cells_[c].cy + (q & 2 ? half : -half);
+                    cells_.push_back(child);
+                    sums_.push_back({0, 0});
+                }
+                int32_t existing = cells_[c].body;
+                double ex = points[existing].first;
+                double ey = points[existing].second;
+                int32_t moved = first + quadrant(cells_[c], ex, ey);
+                cells_[moved].body = existing;
+                cells_[moved].mass = 1;
+                sums_[moved] = {ex, ey};
+                cells_[c].child = first;
+                cells_[c].body = -1;
+            }
+            c = cells_[c].child + quadrant(cells_[c], x, y);
+        }
+    }
+};
+
+// Start of new node i: beside the mean of its neighbours placed before it
+// (lower indices), or anywhere in `extent` if there are none
+GraphLayout::Point startPosition(std::size_t i, const uint32_t* first, const uint32_t* last,
+                                 const std::vector<GraphLayout::Point>& positions,
+                                 double k, double extent) {
+    double sx = 0, sy = 0;
+    int placed = 0;
+    for (const uint32_t* n = first; n != last; ++n) {
+        if (*n < i) {
+            sx += positions[*n].first;
+            sy += positions[*n].second;
+            ++placed;
+        }
+    }
+    if (placed > 0) {
+        return {sx / placed + k * jitter(i * 2), sy / placed + k * jitter(i * 2 + 1)};
+    }
+    return {extent * jitter(i * 2), extent * jitter(i * 2 + 1)};
+}
+
+} // namespace
+
+void GraphLayout::forceDirected(std::size_t node_count, const std::vector<Edge>& edges,
+                                std::vector<Point>& positions, const ForceOptions& options) {
+    if (positions.size() > node_count) {
+        positions.resize(node_count);
+    }
+    if (node_count == 0) return;
+
+    // Undirected adjacency (CSR) so attraction can be summed per node
+    std::vector<uint32_t> offsets(node_count + 1, 0);
+    for (const auto& [from, to] : edges) {
+        if (from == to || from >= node_count || to >= node_count) continue;
+        ++offsets[from + 1];
+        ++offsets[to + 1];
+    }
+    for (std::size_t i = 0; i < node_count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<uint32_t> neighbours(offsets[node_count]);
+    {
+        std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+        for (const auto& [from, to] : edges) {
+            if (from == to || from >= node_count || to >= node_count) continue;
+            neighbours[next[from]++] = to;
+            neighbours[next[to]++] = from;
+        }
+    }
+
+    const double k = options.edge_length;
+    const double extent = k * std::sqrt(static_cast<double>(node_count));
+
+    // New nodes start beside an already placed neighbour, or at random
+    const std::size_t known = positions.size();
+    positions.resize(node_count);
+    for (std::size_t i = known; i < node_count; ++i) {
+        positions[i] = startPosition(i, neighbours.data() + offsets[i], neighbours.data() + offsets[i + 1],
+                                     positions, k, extent);
+    }
+
+    // Maximum step per iteration, cooled geometrically. A warm start only
+    // needs to settle the new nodes, so it starts cooler, runs shorter and
+    // lets the nodes already placed move a tenth as far.
+    const bool warm = known * 2 >= node_count;
+    const double settled_step = warm ? 0.1 : 1.0;
+    double temperature = warm ? k * 2 : std::max(k, extent / 10);
+    const double final_temperature = k * 0.02;
+    const int iterations = std::max(1, warm ? options.iterations / 4 : options.iterations);
+    const double cooling = std::pow(final_temperature / temperature, 1.0 / iterations);
+
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threads = std::max(1u, threads);
+    const double k2 = k * k;
+    const double theta2 = options.theta * options.theta;
+
+    QuadTree tree;
+    std::vector<Point> next(node_count);
+    std::vector<uint32_t> order;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        // Nodes move little per iteration, so the order can be refreshed lazily
+        if (iteration % 8 == 0) {
+            spatialOrder(positions, order);
+        }
+        tree.build(positions, order);
+        parallelFor(node_count, threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t slot = begin; slot < end; ++slot) {
+                const std::size_t i = order[slot];
+                double fx = 0, fy = 0;
+                tree.repulsion(positions, i, k2, theta2, fx, fy);
+
+                const double x = positions[i].first;
+                const double y = positions[i].second;
+                for (uint32_t e = offsets[i]; e < offsets[i + 1]; ++e) {
+                    // Attraction d^2 / k towards each neighbour
+                    double dx = positions[neighbours[e]].first - x;
+                    double dy = positions[neighbours[e]].second - y;
+                    double d = std::sqrt(dx * dx + dy * dy);
+                    fx += dx * d / k;
+                    fy += dy * d / k;
+                }
+
+                double length = std::sqrt(fx * fx + fy * fy);
+                if (length > 0 && std::isfinite(length)) {
+                    double limit = i < known ? temperature * settled_step : temperature;
+                    double step = std::min(length, limit) / length;
+                    next[i] = {x + fx * step, y + fy * step};
+                } else {
+                    next[i] = positions[i];
+                }
+            }
+        });
+        positions.swap(next);
+        temperature *= cooling;
+    }
+}
+
+void GraphLayout::refine(std::size_t node_count, const std::vector<Edge>& edges,
+                         std::size_t first_new_edge, std::vector<Point>& positions,
+                         std::vector<uint32_t>& moved, const ForceOptions& options) {
+    if (positions.size() > node_count) {
+        positions.resize(node_count);
+    }
+    moved.clear();
+    const std::size_t known = positions.size();
+
+    // Free nodes: the new ones and the endpoints of the new edges
+    std::vector<int32_t> slot(node_count, -1);
+    auto unpin = [&](uint32_t node) {
+        if (slot[node] < 0) {
+            slot[node] = static_cast<int32_t>(moved.size());
+            moved.push_back(node);
+        }
+    };
+    for (std::size_t i = known; i < node_count; ++i) {
+        unpin(static_cast<uint32_t>(i));
+    }
+    for (std::size_t e = first_new_edge; e < edges.size(); ++e) {
+        const auto [from, to] = edges[e];
+        if (from == to || from >= node_count || to >= node_count) continue;
+        unpin(from);
+        unpin(to);
+    }
+    if (moved.empty()) return;
+
+    // Once most nodes move, pinning the rest saves little
+    if (moved.size() * 2 > node_count) {
+        forceDirected(node_count, edges, positions, options);
+        moved.resize(node_count);
+        for (std::size_t i = 0; i < node_count; ++i) moved[i] = static_cast<uint32_t>(i);
+        return;
+    }
+    std::sort(moved.begin(), moved.end());
+    const std::size_t count = moved.size();
+    for (std::size_t j = 0; j < count; ++j) {
+        slot[moved[j]] = static_cast<int32_t>(j);
+    }
+
+    // Neighbours of the free nodes only (CSR by slot)
+    std::vector<uint32_t> offsets(count + 1, 0);
+    for (const auto& [from, to] : edges) {
+        if (from == to || from >= node_count || to >= node_count) continue;
+        if (slot[from] >= 0) ++offsets[slot[from] + 1];
+        if (slot[to] >= 0) ++offsets[slot[to] + 1];
+    }
+    for (std::size_t j = 0; j < count; ++j) {
+        offsets[j + 1] += offsets[j];
+    }
+    std::vector<uint32_t> neighbours(offsets[count]);
+    {
+        std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+        for (const auto& [from, to] : edges) {
+            if (from == to || from >= node_count || to >= node_count) continue;
+            if (slot[from] >= 0) neighbours[next[slot[from]]++] = to;
+            if (slot[to] >= 0) neighbours[next[slot[to]]++] = from;
+        }
+    }
+
+    const double k = options.edge_length;
+    const double extent = k * std::sqrt(static_cast<double>(node_count));
+    positions.resize(node_count);
+    for (std::size_t j = 0; j < count; ++j) {
+        if (moved[j] >= known) {
+            positions[moved[j]] = startPosition(moved[j], neighbours.data() + offsets[j],
+                                                neighbours.data() + offsets[j + 1], positions, k, extent);
+        }
+    }
+
+    // The pinned nodes never move, so their repulsion comes from one tree;
+    // the free nodes get a small tree of their own per iteration
+    std::vector<uint32_t> order;
+    order.reserve(node_count - count);
+    for (std::size_t i = 0; i < node_count; ++i) {
+        if (slot[i] < 0) order.push_back(static_cast<uint32_t>(i));
+    }
+    QuadTree pinned;
+    pinned.build(positions, order);
+
+    // The same schedule as a warm start of forceDirected()
+    double temperature = k * 2;
+    const double final_temperature = k * 0.02;
+    const int iterations = std::max(1, options.iterations / 4);
+    const double cooling = std::pow(final_temperature / temperature, 1.0 / iterations);
+
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threads = std::max(1u, threads);
+    const double k2 = k * k;
+    const double theta2 = options.theta * options.theta;
+
+    QuadTree tree;
+    std::vector<Point> current(count);
+    std::vector<Point> next(count);
+    std::vector<uint32_t> local;
+    for (std::size_t j = 0; j < count; ++j) {
+        current[j] = positions[moved[j]];
+    }
+    const std::vector<Point> start = current;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        if (iteration % 8 == 0) {
+            spatialOrder(current, local);
+        }
+        tree.build(current, local);
+        parallelFor(count, threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; ++j) {
+                const std::size_t i = moved[j];
+                double fx = 0, fy = 0;
+                pinned.repulsion(positions, i, k2, theta2, fx, fy);
+                tree.repulsion(current, j, k2, theta2, fx, fy);
+
+                const double x = current[j].first;
+                const double y = current[j].second;
+                for (uint32_t e = offsets[j]; e < offsets[j + 1]; ++e) {
+                    const uint32_t n = neighbours[e];
+                    const Point& other = slot[n] >= 0 ? current[slot[n]] : positions[n];
+                    double dx = other.first - x;
+                    double dy = other.second - y;
+                    double d = std::sqrt(dx * dx + dy * dy);
+                    fx += dx * d / k;
+                    fy += dy * d / k;
+                }
+
+                double length = std::sqrt(fx * fx + fy * fy);
+                if (length > 0 && std::isfinite(length)) {
+                    double limit = i < known ? temperature * 0.1 : temperature;
+                    double step = std::min(length, limit) / length;
+                    next[j] = {x + fx * step, y + fy * step};
+                } else {
+                    next[j] = current[j];
+                }
+            }
+        });
+        current.swap(next);
+        // The pinned tree reads positions[i] of the node it is asked about
+        for (std::size_t j = 0; j < count; ++j) {
+            positions[moved[j]] = current[j];
+        }
+        temperature *= cooling;
+    }
+
+    // Report only the nodes that moved (or are new)
+    std::size_t kept = 0;
+    for (std::size_t j = 0; j < count; ++j) {
+        if (moved[j] >= known || current[j] != start[j]) moved[kept++] = moved[j];
+    }
+    moved.resize(kept);
+}
+
+void GraphLayout::layered(std::size_t node_count, const std::vector<Edge>& edges,
+                          std::vector<Point>& positions, const LayeredOptions& options,
+                          std::vector<int>* depths) {
+    positions.assign(node_count, {0.0, 0.0});
+    if (depths) depths->assign(node_count, 0);
+    if (node_count == 0) return;
+
+    // Outgoing edges for the BFS and undirected ones for the sweeps (CSR)
+    std::vector<uint32_t> out_offsets(node_count + 1, 0);
+    std::vector<uint32_t> all_offsets(node_count + 1, 0);
+    std::vector<uint32_t> in_degree(node_count, 0);
+    for (const auto& [from, to] : edges) {
+        if (from == to || from >= node_count || to >= node_count) continue;
+        ++out_offsets[from + 1];
+        ++all_offsets[from + 1];
+        ++all_offsets[to + 1];
+        ++in_degree[to];
+    }
+    for (std::size_t i = 0; i < node_count; ++i) {
+        out_offsets[i + 1] += out_offsets[i];
+        all_offsets[i + 1] += all_offsets[i];
+    }
+    std::vector<uint32_t> out_targets(out_offsets[node_count]);
+    std::vector<uint32_t> neighbours(all_offsets[node_count]);
+    {
+        std::vector<uint32_t> next_out(out_offsets.begin(), out_offsets.end() - 1);
+        std::vector<uint32_t> next_all(all_offsets.begin(), all_offsets.end() - 1);
+        for (const auto& [from, to] : edges) {
+            if (from == to || from >= node_count || to >= node_count) continue;
+            out_targets[next_out[from]++] = to;
+            neighbours[next_all[from]++] = to;
+            neighbours[next_all[to]++] = from;
+        }
+    }
+
+    // Breadth-first depths; discovery order seeds the order within layers
+    std::vector<int> depth(node_count, -1);
+    std::vector<uint32_t> queue;
+    queue.reserve(node_count);
+    std::size_t head = 0;
+    auto search = [&]() {
+        while (head < queue.size()) {
+            uint32_t u = queue[head++];
+            for (uint32_t e = out_offsets[u]; e < out_offsets[u + 1]; ++e) {
+                uint32_t v = out_targets[e];
+                if (depth[v] < 0) {
+                    depth[v] = depth[u] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+    };
+    for (std::size_t i = 0; i < node_count; ++i) {
+        if (in_degree[i] == 0) {
+            depth[i] = 0;
+            queue.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    search();
+    for (std::size_t i = 0; i < node_count; ++i) {
+        if (depth[i] < 0) {
+            depth[i] = 0;
+            queue.push_back(static_cast<uint32_t>(i));
+            search();
+        }
+    }
+
+    // Group nodes by layer (stable in discovery order)
+    int layer_count = 0;
+    for (int d : depth) layer_count = std::max(layer_count, d + 1);
+    std::vector<uint32_t> layer_start(layer_count + 1, 0);
+    for (int d : depth) ++layer_start[d + 1];
+    for (int d = 0; d < layer_count; ++d) layer_start[d + 1] += layer_start[d];
+    std::vector<uint32_t> order(node_count);   // nodes, layer by layer
+    std::vector<uint32_t> slot(node_count);    // position of a node within its layer
+    {
+        std::vector<uint32_t> next(layer_start.begin(), layer_start.end() - 1);
+        for (uint32_t u : queue) {
+            uint32_t at = next[depth[u]]++;
+            order[at] = u;
+            slot[u] = at - layer_start[depth[u]];
+        }
+    }
+
+    // Barycentre sweeps, alternating downwards and upwards
+    std::vector<uint32_t> bucket_of(node_count);
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> reordered;
+    auto reorder = [&](int layer, int reference) {
+        uint32_t begin = layer_start[layer];
+        uint32_t width = layer_start[layer + 1] - begin;
+        double reference_width = layer_start[reference + 1] - layer_start[reference];
+        if (width < 2) return;
+
+        counts.assign(width + 1, 0);
+        for (uint32_t p = 0; p < width; ++p) {
+            uint32_t u = order[begin + p];
+            double sum = 0;
+            uint32_t count = 0;
+            for (uint32_t e = all_offsets[u]; e < all_offsets[u + 1]; ++e) {
+                uint32_t v = neighbours[e];
+                if (depth[v] == reference) {
+                    sum += slot[v] + 0.5;
+                    ++count;
+                }
+            }
+            // Normalised barycentre in [0, 1); nodes without neighbours
+            // there keep their current relative place
+            double key = count ? sum / count / reference_width : (p + 0.5) / width;
+            uint32_t bucket = std::min<uint32_t>(width - 1, static_cast<uint32_t>(key * width));
+            bucket_of[u] = bucket;
+            ++counts[bucket + 1];
+        }
+        for (uint32_t b = 0; b < width; ++b) counts[b + 1] += counts[b];
+        reordered.resize(width);
+        for (uint32_t p = 0; p < width; ++p) {
+            uint32_t u = order[begin + p];
+            reordered[counts[bucket_of[u]]++] = u;
+        }
+        for (uint32_t p = 0; p < width; ++p) {
+            order[begin + p] = reordered[p];
+            slot[reordered[p]] = p;
+        }
+    };
+    for (int sweep = 0; sweep < options.sweeps; ++sweep) {
+        if (sweep % 2 == 0) {
+            for (int d = 1; d < layer_count; ++d) reorder(d, d - 1);
+        } else {
+            for (int d = layer_count - 2; d >= 0; --d) reorder(d, d + 1);
+        }
+    }
+
+    for (std::size_t u = 0; u < node_count; ++u) {
+        double width = layer_start[depth[u] + 1] - layer_start[depth[u]];
+        positions[u] = {(slot[u] - (width - 1) / 2) * options.node_spacing,
+                        depth[u] * options.layer_spacing};
+    }
+    if (depths) *depths = std::move(depth);
+}
+
+void GraphLayout::circular(std::size_t node_count, std::vector<Point>& positions, double radius) {
+    positions.clear();
+    if (node_count == 0) return;
+    positions.reserve(node_count);
+
+    // Adjust radius based on number of nodes for better spacing
+    double n = static_cast<double>(node_count);
+    if (node_count > 10) {
+        radius *= 1.0 + std::log(n / 10.0);
+    }
+    double angle_step = 2.0 * M_PI / n;
+    for (std::size_t i = 0; i < node_count; ++i) {
+        double angle = i * angle_step;
+        positions.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+    }
+}
+
+} // namespace tla_visualiser
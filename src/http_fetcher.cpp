@@ -0,0 +1,289 @@
+#include "http_fetcher.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <mutex>
+#include <string_view>
+
+namespace tla_visualiser {
+
+namespace {
+
+// Upper bound on a curl_multi_poll wait; it returns as soon as a socket is ready
+constexpr int kPollMs = 100;
+
+size_t appendBody(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<const char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+bool equalsIgnoringCase(std::string_view a, std::string_view b) {
+    auto lower = [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; };
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [&lower](char x, char y) {
+        return lower(x) == lower(y);
+    });
+}
+
+// Called once per header line, status lines included
+size_t captureHeader(char* buffer, size_t size, size_t nitems, void* userp) {
+    auto* response = static_cast<HttpFetcher::Response*>(userp);
+    std::string_view line(buffer, size * nitems);
+    if (line.substr(0, 5) == "HTTP/") {
+        // A new response (after a redirect or 100 Continue)
+        response->etag.clear();
+        response->last_modified.clear();
+        return size * nitems;
+    }
+    const std::size_t colon = line.find(':');
+    if (colon == std::string_view::npos) return size * nitems;
+    const std::string_view name = line.substr(0, colon);
+    std::string_view value = line.substr(colon + 1);
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == '\r' || value.back() == '\n' || value.back() == ' ')) {
+        value.remove_suffix(1);
+    }
+    if (equalsIgnoringCase(name, "ETag")) {
+        response->etag.assign(value);
+    } else if (equalsIgnoringCase(name, "Last-Modified")) {
+        response->last_modified.assign(value);
+    }
+    return size * nitems;
+}
+
+void initCurl() {
+    // curl_global_init is not thread-safe in older libcurl versions
+    static std::once_flag once;
+    std::call_once(once, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+} // namespace
+
+class HttpFetcher::Impl {
+public:
+    struct Transfer {
+        CURL* easy = nullptr;
+        curl_slist* headers = nullptr;
+        Response* response = nullptr;
+        const BodySink* sink = nullptr;
+        uint64_t streamed = 0;
+    };
+
+    static size_t streamBody(void* contents, size_t size, size_t nmemb, void* userp) {
+        auto* transfer = static_cast<Transfer*>(userp);
+        const size_t bytes = size * nmemb;
+        transfer->streamed += bytes;
+        // Anything but `bytes` makes curl fail the transfer with CURLE_WRITE_ERROR
+        return (*transfer->sink)(static_cast<const char*>(contents), bytes) ? bytes : 0;
+    }
+
+    Options options;
+    CURLM* multi = nullptr;
+    std::vector<CURL*> idle;   // easy handles kept for reuse
+    Stats counters;
+
+    explicit Impl(const Options& opts) : options(opts) {
+        initCurl();
+        multi = curl_multi_init();
+        if (!multi) return;
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(std::max(1, options.max_connections)));
+        curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(std::max(1, options.max_host_connections)));
+        // Connections kept open between calls
+        curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(std::max(1, options.max_connections)));
+    }
+
+    ~Impl() {
+        for (CURL* easy : idle) {
+            curl_easy_cleanup(easy);
+        }
+        if (multi) {
+            curl_multi_cleanup(multi);
+        }
+    }
+
+    CURL* acquireEasy() {
+        if (!idle.empty()) {
+            CURL* easy = idle.back();
+            idle.pop_back();
+            return easy;
+        }
+        return curl_easy_init();
+    }
+
+    bool start(Transfer& transfer, const Request& request) {
+        transfer.easy = acquireEasy();
+        if (!transfer.easy) return false;
+        CURL* easy = transfer.easy;
+        transfer.response->url = request.url;
+
+        curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+        if (request.sink) {
+            transfer.sink = &request.sink;
+            curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, streamBody);
+            curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer);
+        } else {
+            curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, appendBody);
+            curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer.response->body);
+        }
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, captureHeader);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, transfer.response);
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, &transfer);
+        curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(easy, CURLOPT_USERAGENT, options.user_agent.c_str());
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, options.connect_timeout_ms);
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, options.timeout_ms);
+        curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        // HTTP/2 where TLS allows it; wait for a connection that can
+        // multiplex rather than opening another one
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+
+        for (const auto& header : request.headers) {
+            transfer.headers = curl_slist_append(transfer.headers, header.c_str());
+        }
+        if (transfer.headers) {
+            curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer.headers);
+        }
+        return curl_multi_add_handle(multi, easy) == CURLM_OK;
+    }
+
+    void finish(Transfer& transfer, CURLcode result) {
+        Response& response = *transfer.response;
+        if (transfer.easy) {
+            curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &response.status);
+            long connects = 0;
+            curl_easy_getinfo(transfer.easy, CURLINFO_NUM_CONNECTS, &connects);
+            counters.connections += static_cast<uint64_t>(std::max(0L, connects));
+            curl_multi_remove_handle(multi, transfer.easy);
+            curl_easy_reset(transfer.easy);
+            idle.push_back(transfer.easy);
+            transfer.easy = nullptr;
+        }
+        if (transfer.headers) {
+            curl_slist_free_all(transfer.headers);
+            transfer.headers = nullptr;
+        }
+
+        // An error status wins over a sink that gave up on the error page
+        const bool http_error = (response.status < 200 || response.status >= 300) && response.status != 304;
+        if (result != CURLE_OK && (response.status == 0 || !http_error)) {
+            response.error = curl_easy_strerror(result);
+        } else if (http_error) {
+            response.error = "HTTP " + std::to_string(response.status);
+        }
+        ++counters.requests;
+        if (!response.ok() && !response.notModified()) ++counters.failures;
+        counters.bytes += response.body.size() + transfer.streamed;
+    }
+};
+
+HttpFetcher::HttpFetcher() : HttpFetcher(Options()) {}
+
+HttpFetcher::HttpFetcher(const Options& options) : pImpl(std::make_unique<Impl>(options)) {}
+
+HttpFetcher::~HttpFetcher() = default;
+
+HttpFetcher::Response HttpFetcher::get(const Request& request, const std::atomic<bool>* cancel) {
+    return std::move(fetchAll({request}, ProgressCallback(), cancel).front());
+}
+
+std::vector<HttpFetcher::Response> HttpFetcher::fetchAll(const std::vector<Request>& requests,
+                                                         const ProgressCallback& progress,
+                                                         const std::atomic<bool>* cancel) {
+    std::vector<Response> responses(requests.size());
+    if (requests.empty()) return responses;
+    if (!pImpl->multi) {
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            responses[i].url = requests[i].url;
+            responses[i].error = "curl unavailable";
+        }
+        return responses;
+    }
+
+    // Transfers are addressed through CURLOPT_PRIVATE, so they must not move
+    std::vector<Impl::Transfer> transfers(requests.size());
+    std::size_t next = 0;
+    std::size_t in_flight = 0;
+    std::size_t done = 0;
+    const std::size_t window = static_cast<std::size_t>(std::max(1, pImpl->options.max_in_flight));
+
+    auto finished = [&](Impl::Transfer& transfer, CURLcode result) {
+        pImpl->finish(transfer, result);
+        ++done;
+        if (progress) progress(done, requests.size());
+    };
+    auto startNext = [&] {
+        while (next < requests.size() && in_flight < window) {
+            Impl::Transfer& transfer = transfers[next];
+            transfer.response = &responses[next];
+            const Request& request = requests[next];
+            ++next;
+            if (pImpl->start(transfer, request)) {
+                ++in_flight;
+            } else {
+                finished(transfer, CURLE_FAILED_INIT);
+            }
+        }
+    };
+
+    startNext();
+    while (in_flight > 0) {
+        if (cancel && cancel->load()) {
+            // Running transfers give their connections back; queued ones never start
+            for (std::size_t i = 0; i < next; ++i) {
+                if (!transfers[i].easy) continue;
+                pImpl->finish(transfers[i], CURLE_ABORTED_BY_CALLBACK);
+                responses[i].error = "cancelled";
+            }
+            for (; next < requests.size(); ++next) {
+                responses[next].url = requests[next].url;
+                responses[next].error = "cancelled";
+            }
+            break;
+        }
+
+        int running = 0;
+        curl_multi_perform(pImpl->multi, &running);
+
+        int queued = 0;
+        while (CURLMsg* message = curl_multi_info_read(pImpl->multi, &queued)) {
+            if (message->msg != CURLMSG_DONE) continue;
+            Impl::Transfer* transfer = nullptr;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+            const CURLcode result = message->data.result;
+            --in_flight;
+            finished(*transfer, result);
+        }
+        startNext();
+
+        if (in_flight > 0) {
+            curl_multi_poll(pImpl->multi, nullptr, 0, kPollMs, nullptr);
+        }
+    }
+    return responses;
+}
+
+HttpFetcher::Stats HttpFetcher::stats() const {
+    return pImpl->counters;
+}
+
+std::string HttpFetcher::escapePath(const std::string& path) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string escaped;
+    escaped.reserve(path.size());
+    for (unsigned char c : path) {
+        const bool unreserved = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+                                || c == '-' || c == '_' || c == '.' || c == '~' || c == '/';
+        if (unreserved) {
+            escaped += static_cast<char>(c);
+        } else {
+            escaped += '%';
+            escaped += hex[c >> 4];
+            escaped += hex[c & 0x0f];
+        }
+    }
+    return escaped;
+}
+
+} // namespace tla_visualiser
@@ -0,0 +1,421 @@
+#include "import_cache.h"
+#include <QCryptographicHash>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace tla_visualiser {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Index file: this magic, then one record per recorded location,
+//   u16 key length | key | 20-byte blob SHA | u16 length | ETag
+//   | u16 length | Last-Modified
+// with lengths little-endian and the key being owner, repo, ref and path
+// separated by NULs. Later records for a key replace earlier ones.
+constexpr std::string_view kIndexMagic = "TLAVIDX2";
+constexpr std::size_t kShaBytes = 20;
+constexpr std::size_t kMaxField = 0xffff;
+
+// Dead records tolerated in the index before it is rewritten
+constexpr std::size_t kCompactSlack = 1024;
+
+constexpr std::string_view kPartial = ".partial";
+
+bool readFile(const fs::path& path, std::string& contents) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// SHAs name files, so only accept what blobSha() produces
+bool isValidSha(const std::string& sha) {
+    return sha.size() == 2 * kShaBytes && std::all_of(sha.begin(), sha.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+int hexValue(char c) {
+    return c <= '9' ? c - '0' : c - 'a' + 10;
+}
+
+std::string toHex(const char* raw) {
+    static const char* hex = "0123456789abcdef";
+    std::string text(2 * kShaBytes, '0');
+    for (std::size_t i = 0; i < kShaBytes; ++i) {
+        const auto byte = static_cast<unsigned char>(raw[i]);
+        text[2 * i] = hex[byte >> 4];
+        text[2 * i + 1] = hex[byte & 0x0f];
+    }
+    return text;
+}
+
+std::string indexPrefix(const std::string& owner, const std::string& repo, const std::string& ref) {
+    std::string prefix;
+    prefix.reserve(owner.size() + repo.size() + ref.size() + 3);
+    prefix += owner;
+    prefix += '\0';
+    prefix += repo;
+    prefix += '\0';
+    prefix += ref;
+    prefix += '\0';
+    return prefix;
+}
+
+std::string indexKey(const ImportCache::Location& location) {
+    return indexPrefix(location.owner, location.repo, location.ref) + location.path;
+}
+
+void appendField(std::string& out, const std::string& field) {
+    out += static_cast<char>(field.size() & 0xff);
+    out += static_cast<char>(field.size() >> 8);
+    out += field;
+}
+
+// Reads a field written by appendField at data[pos], advancing pos
+bool readField(const std::string& data, std::size_t& pos, std::string& field) {
+    if (data.size() - pos < 2) return false;
+    const std::size_t length = static_cast<unsigned char>(data[pos]) |
+                               static_cast<std::size_t>(static_cast<unsigned char>(data[pos + 1])) << 8;
+    if (data.size() - pos - 2 < length) return false;
+    field.assign(data, pos + 2, length);
+    pos += 2 + length;
+    return true;
+}
+
+struct IndexEntry {
+    std::string sha;
+    ImportCache::Validators validators;
+};
+
+void appendRecord(std::string& out, const std::string& key, const IndexEntry& entry) {
+    appendField(out, key);
+    for (std::size_t i = 0; i < kShaBytes; ++i) {
+        out += static_cast<char>(hexValue(entry.sha[2 * i]) << 4 | hexValue(entry.sha[2 * i + 1]));
+    }
+    appendField(out, entry.validators.etag);
+    appendField(out, entry.validators.last_modified);
+}
+
+// Reads one record at data[pos], advancing pos; false if it is cut short
+bool readRecord(const std::string& data, std::size_t& pos, std::string& key, IndexEntry& entry) {
+    std::size_t at = pos;
+    if (!readField(data, at, key) || data.size() - at < kShaBytes) return false;
+    entry.sha = toHex(data.data() + at);
+    at += kShaBytes;
+    if (!readField(data, at, entry.validators.etag) || !readField(data, at, entry.validators.last_modified)) {
+        return false;
+    }
+    pos = at;
+    return true;
+}
+
+} // namespace
+
+class ImportCache::Impl {
+public:
+    struct Blob {
+        uint64_t bytes;
+        uint64_t last_used;   // from `clock`; higher is more recent
+    };
+
+    std::string directory;
+    uint64_t max_bytes;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Blob> blobs;
+    std::unordered_map<std::string, IndexEntry> index;    // by indexKey()
+    std::size_t index_records = 0;                        // in the file, live or not
+    std::ofstream index_log;
+    uint64_t clock = 0;
+    uint64_t bytes = 0;
+    Stats counters;
+    std::atomic<uint64_t> partial_files{0};
+
+    Impl(const std::string& dir, uint64_t budget) : directory(dir), max_bytes(budget) {
+        std::error_code error;
+        fs::create_directories(blobDirectory(), error);
+        scanBlobs();
+        loadIndex();
+    }
+
+    fs::path blobDirectory() const {
+        return fs::path(directory) / "blobs";
+    }
+
+    fs::path blobPath(const std::string& sha) const {
+        return blobDirectory() / sha;
+    }
+
+    fs::path indexPath() const {
+        return fs::path(directory) / "index";
+    }
+
+    // Picks up blobs left by earlier sessions, oldest first so that their
+    // modification times carry the LRU order over
+    void scanBlobs() {
+        std::vector<std::pair<fs::file_time_type, std::pair<std::string, uint64_t>>> found;
+        std::error_code error;
+        for (const auto& item : fs::directory_iterator(blobDirectory(), error)) {
+            const std::string name = item.path().filename().string();
+            if (name.find(kPartial) != std::string::npos) {
+                fs::remove(item.path(), error);   // a store that did not finish
+                continue;
+            }
+            if (!isValidSha(name)) continue;
+            const uintmax_t size = item.file_size(error);
+            if (error) continue;
+            found.push_back({item.last_write_time(error), {name, size}});
+        }
+        std::sort(found.begin(), found.end());
+        for (const auto& [time, blob] : found) {
+            blobs[blob.first] = {blob.second, ++clock};
+            bytes += blob.second;
+        }
+        evict("");
+    }
+
+    void loadIndex() {
+        std::string data;
+        bool clean = readFile(indexPath(), data) && data.compare(0, kIndexMagic.size(), kIndexMagic) == 0;
+        std::size_t pos = clean ? kIndexMagic.size() : data.size();
+        std::string key;
+        IndexEntry entry;
+        while (pos < data.size() && readRecord(data, pos, key, entry)) {
+            index[key] = std::move(entry);
+            ++index_records;
+        }
+        clean = clean && pos == data.size();   // else a record was cut short
+
+        // Entries whose blob was evicted are dead too
+        for (auto it = index.begin(); it != index.end();) {
+            it = blobs.count(it->second.sha) ? std::next(it) : index.erase(it);
+        }
+        if (!clean || index_records != index.size()) {
+            writeIndex();
+        }
+    }
+
+    // Called with the lock held
+    void writeIndex() {
+        index_log.close();
+        std::string data(kIndexMagic);
+        for (const auto& [key, entry] : index) {
+            appendRecord(data, key, entry);
+        }
+        fs::path partial = indexPath();
+        partial += std::string(kPartial);
+        {
+            std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        std::error_code error;
+        fs::rename(partial, indexPath(), error);
+        if (error) fs::remove(partial, error);
+        index_records = index.size();
+    }
+
+    // Called with the lock held
+    void logRecord(const std::string& key, const IndexEntry& entry) {
+        if (index_records > 2 * index.size() + kCompactSlack) {
+            writeIndex();
+            return;
+        }
+        if (!index_log.is_open()) {
+            index_log.open(indexPath(), std::ios::binary | std::ios::app);
+        }
+        std::string record;
+        appendRecord(record, key, entry);
+        index_log.write(record.data(), static_cast<std::streamsize>(record.size()));
+        index_log.flush();
+        ++index_records;
+    }
+
+    // Called with the lock held
+    void evict(const std::string& keep) {
+        while (bytes > max_bytes) {
+            auto oldest = blobs.end();
+            for (auto it = blobs.begin(); it != blobs.end(); ++it) {
+                if (it->first == keep) continue;
+                if (oldest == blobs.end() || it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            if (oldest == blobs.end()) break;
+            remove(oldest);
+            ++counters.evictions;
+        }
+    }
+
+    void remove(std::unordered_map<std::string, Blob>::iterator it) {
+        std::error_code error;
+        fs::remove(blobPath(it->first), error);
+        bytes -= it->second.bytes;
+        blobs.erase(it);
+    }
+};
+
+ImportCache::ImportCache(const std::string& directory, uint64_t max_bytes)
+    : pImpl(std::make_unique<Impl>(directory, max_bytes)) {}
+
+ImportCache::~ImportCache() = default;
+
+const std::string& ImportCache::directory() const {
+    return pImpl->directory;
+}
+
+std::string ImportCache::blobSha(std::string_view content) {
+    const std::string header = "blob " + std::to_string(content.size());
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(header.data(), static_cast<qsizetype>(header.size() + 1));   // with its NUL
+    hash.addData(content.data(), static_cast<qsizetype>(content.size()));
+    return hash.result().toHex().toStdString();
+}
+
+bool ImportCache::contains(const std::string& sha) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->blobs.count(sha) > 0;
+}
+
+bool ImportCache::read(const std::string& sha, std::string& content) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->blobs.find(sha);
+    if (it == pImpl->blobs.end()) {
+        ++pImpl->counters.misses;
+        return false;
+    }
+    const fs::path path = pImpl->blobPath(sha);
+    if (!readFile(path, content) || content.size() != it->second.bytes) {
+        // Removed or damaged behind our back: it will be fetched again
+        content.clear();
+        pImpl->remove(it);
+        ++pImpl->counters.misses;
+        return false;
+    }
+    it->second.last_used = ++pImpl->clock;
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    ++pImpl->counters.hits;
+    return true;
+}
+
+std::string ImportCache::store(std::string_view content) {
+    if (content.size() > pImpl->max_bytes) return {};
+    const std::string sha = blobSha(content);
+    {
+        // Identical content is already there, whatever it was imported as
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        auto it = pImpl->blobs.find(sha);
+        if (it != pImpl->blobs.end()) {
+            it->second.last_used = ++pImpl->clock;
+            return sha;
+        }
+    }
+
+    // Written aside and renamed into place, so a read never sees half a blob
+    const fs::path path = pImpl->blobPath(sha);
+    fs::path partial = path;
+    partial += std::string(kPartial) + std::to_string(++pImpl->partial_files);
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(content.data(), static_cast<std::streamsize>(content.size())) || !out.flush()) {
+            out.close();
+            std::error_code error;
+            fs::remove(partial, error);
+            return {};
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    std::error_code error;
+    fs::rename(partial, path, error);
+    if (error) {
+        fs::remove(partial, error);
+        return {};
+    }
+    if (!pImpl->blobs.count(sha)) {
+        pImpl->bytes += content.size();
+        ++pImpl->counters.stores;
+    }
+    pImpl->blobs[sha] = {content.size(), ++pImpl->clock};
+    pImpl->evict(sha);
+    return sha;
+}
+
+std::string ImportCache::resolve(const Location& location) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->index.find(indexKey(location));
+    if (it == pImpl->index.end() || !pImpl->blobs.count(it->second.sha)) return {};
+    return it->second.sha;
+}
+
+ImportCache::Validators ImportCache::validators(const Location& location) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->index.find(indexKey(location));
+    if (it == pImpl->index.end() || !pImpl->blobs.count(it->second.sha)) return {};
+    return it->second.validators;
+}
+
+std::vector<std::pair<std::string, std::string>> ImportCache::files(const std::string& owner,
+                                                                    const std::string& repo,
+                                                                    const std::string& ref) const {
+    const std::string prefix = indexPrefix(owner, repo, ref);
+    std::vector<std::pair<std::string, std::string>> found;
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    for (const auto& [key, entry] : pImpl->index) {
+        if (key.compare(0, prefix.size(), prefix) != 0 || !pImpl->blobs.count(entry.sha)) continue;
+        found.emplace_back(key.substr(prefix.size()), entry.sha);
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+void ImportCache::record(const Location& location, const std::string& sha, const Validators& validators) {
+    if (!isValidSha(sha)) return;
+    const std::string key = indexKey(location);
+    if (key.size() > kMaxField) return;
+    IndexEntry entry{sha, validators};
+    if (entry.validators.etag.size() > kMaxField || entry.validators.last_modified.size() > kMaxField) {
+        entry.validators = Validators();
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->index.find(key);
+    if (it != pImpl->index.end() && it->second.sha == sha) {
+        if (entry.validators.empty()) return;
+        if (it->second.validators.etag == entry.validators.etag &&
+            it->second.validators.last_modified == entry.validators.last_modified) {
+            return;
+        }
+    }
+    pImpl->index[key] = entry;
+    pImpl->logRecord(key, entry);
+}
+
+void ImportCache::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    while (!pImpl->blobs.empty()) {
+        pImpl->remove(pImpl->blobs.begin());
+    }
+    pImpl->index.clear();
+    pImpl->writeIndex();
+}
+
+ImportCache::Stats ImportCache::stats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    Stats stats = pImpl->counters;
+    stats.bytes = pImpl->bytes;
+    stats.blobs = pImpl->blobs.size();
+    stats.locations = pImpl->index.size();
+    return stats;
+}
+
+} // namespace tla_visualiser
@@ -0,0 +1,412 @@
+#include "json_stream.h"
+#include <cstdint>
+#include <vector>
+
+namespace tla_visualiser {
+
+namespace {
+
+constexpr uint32_t kReplacementCharacter = 0xFFFD;
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isNumberChar(char c) {
+    return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isValidNumber(std::string_view text) {
+    std::size_t i = 0;
+    auto digits = [&] {
+        std::size_t start = i;
+        while (i < text.size() && isDigit(text[i])) ++i;
+        return i > start;
+    };
+    if (i < text.size() && text[i] == '-') ++i;
+    if (i < text.size() && text[i] == '0') {
+        ++i;
+    } else if (!digits()) {
+        return false;
+    }
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        if (!digits()) return false;
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        ++i;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) ++i;
+        if (!digits()) return false;
+    }
+    return i == text.size();
+}
+
+void appendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+} // namespace
+
+class JsonStreamParser::Impl {
+public:
+    enum class Mode {
+        Value,            // any value
+        FirstValueOrEnd,  // after '['
+        FirstKeyOrEnd,    // after '{'
+        Key,              // after ',' in an object
+        Colon,
+        AfterValue,       // ',' or the closing bracket
+        String,
+        Escape,           // after '\'
+        Unicode,          // the hex digits of \uXXXX
+        Number,
+        Literal,          // true, false or null
+        Done,
+        Failed
+    };
+
+    Handler& handler;
+    std::size_t max_token;
+    Mode mode = Mode::Value;
+    std::vector<char> open;        // '{' or '[' per enclosing container
+    std::string token;             // string, number or literal being read
+    bool token_is_key = false;
+    uint32_t code_unit = 0;
+    int hex_digits = 0;
+    uint32_t high_surrogate = 0;   // waiting for its low half
+    std::size_t consumed = 0;
+    std::string error;
+
+    Impl(Handler& h, std::size_t limit) : handler(h), max_token(limit) {}
+
+    void fail(const char* what, std::size_t offset) {
+        if (mode == Mode::Failed) return;
+        mode = Mode::Failed;
+        error = std::string(what) + " at byte " + std::to_string(offset);
+    }
+
+    bool append(const char* begin, const char* end, std::size_t offset) {
+        if (token.size() + static_cast<std::size_t>(end - begin) > max_token) {
+            fail("token too long", offset);
+            return false;
+        }
+        token.append(begin, end);
+        return true;
+    }
+
+    void flushSurrogate() {
+        if (high_surrogate) {
+            appendUtf8(token, kReplacementCharacter);
+            high_surrogate = 0;
+        }
+    }
+
+    void valueDone() {
+        mode = open.empty() ? Mode::Done : Mode::AfterValue;
+    }
+
+    void endString() {
+        if (token_is_key) {
+            handler.key(token);
+            mode = Mode::Colon;
+        } else {
+            handler.string(token);
+            valueDone();
+        }
+    }
+
+    void endNumber(std::size_t offset) {
+        if (!isValidNumber(token)) {
+            fail("malformed number", offset);
+            return;
+        }
+        handler.number(token);
+        valueDone();
+    }
+
+    void endLiteral(std::size_t offset) {
+        if (token == "true") {
+            handler.boolean(true);
+        } else if (token == "false") {
+            handler.boolean(false);
+        } else if (token == "null") {
+            handler.null();
+        } else {
+            fail("unknown literal", offset);
+            return;
+        }
+        valueDone();
+    }
+
+    void close(char bracket) {
+        open.pop_back();
+        if (bracket == '{') {
+            handler.endObject();
+        } else {
+            handler.endArray();
+        }
+        valueDone();
+    }
+
+    void beginValue(char c, std::size_t offset) {
+        token.clear();
+        if (c == '{') {
+            open.push_back('{');
+            handler.startObject();
+            mode = Mode::FirstKeyOrEnd;
+        } else if (c == '[') {
+            open.push_back('[');
+            handler.startArray();
+            mode = Mode::FirstValueOrEnd;
+        } else if (c == '"') {
+            token_is_key = false;
+            mode = Mode::String;
+        } else if (c == '-' || isDigit(c)) {
+            token += c;
+            mode = Mode::Number;
+        } else if (c >= 'a' && c <= 'z') {
+            token += c;
+            mode = Mode::Literal;
+        } else {
+            fail("unexpected character", offset);
+        }
+    }
+
+    // One character outside any token
+    void structural(char c, std::size_t offset) {
+        if (isWhitespace(c)) return;
+        switch (mode) {
+        case Mode::FirstValueOrEnd:
+            if (c == ']') {
+                close('[');
+                return;
+            }
+            beginValue(c, offset);
+            return;
+        case Mode::Value:
+            beginValue(c, offset);
+            return;
+        case Mode::FirstKeyOrEnd:
+            if (c == '}') {
+                close('{');
+                return;
+            }
+            [[fallthrough]];
+        case Mode::Key:
+            if (c != '"') {
+                fail("expected a key", offset);
+                return;
+            }
+            token.clear();
+            token_is_key = true;
+            mode = Mode::String;
+            return;
+        case Mode::Colon:
+            if (c != ':') {
+                fail("expected ':'", offset);
+                return;
+            }
+            mode = Mode::Value;
+            return;
+        case Mode::AfterValue:
+            if (c == ',') {
+                mode = open.back() == '{' ? Mode::Key : Mode::Value;
+            } else if ((c == '}' || c == ']') && c == (open.back() == '{' ? '}' : ']')) {
+                close(open.back());
+            } else {
+                fail("expected ',' or a closing bracket", offset);
+            }
+            return;
+        case Mode::Done:
+            fail("data after the document", offset);
+            return;
+        default:
+            return;
+        }
+    }
+
+    // Copies the run of plain characters at once; returns where it stopped
+    const char* readString(const char* p, const char* end, const char* base) {
+        if (high_surrogate && *p != '\\') flushSurrogate();
+        const char* run = p;
+        for (; p < end; ++p) {
+            const unsigned char c = static_cast<unsigned char>(*p);
+            if (c == '"' || c == '\\') {
+                if (!append(run, p, consumed + (p - base))) return p;
+                if (c == '"') {
+                    endString();
+                } else {
+                    mode = Mode::Escape;
+                }
+                return p + 1;
+            }
+            if (c < 0x20) {
+                fail("control character in string", consumed + (p - base));
+                return p;
+            }
+        }
+        append(run, p, consumed + (p - base));
+        return p;
+    }
+
+    void escape(char c, std::size_t offset) {
+        if (c == 'u') {
+            code_unit = 0;
+            hex_digits = 0;
+            mode = Mode::Unicode;
+            return;
+        }
+        flushSurrogate();
+        char decoded;
+        switch (c) {
+        case '"': decoded = '"'; break;
+        case '\\': decoded = '\\'; break;
+        case '/': decoded = '/'; break;
+        case 'b': decoded = '\b'; break;
+        case 'f': decoded = '\f'; break;
+        case 'n': decoded = '\n'; break;
+        case 'r': decoded = '\r'; break;
+        case 't': decoded = '\t'; break;
+        default:
+            fail("invalid escape", offset);
+            return;
+        }
+        if (append(&decoded, &decoded + 1, offset)) mode = Mode::String;
+    }
+
+    void unicodeDigit(char c, std::size_t offset) {
+        const int value = hexValue(c);
+        if (value < 0) {
+            fail("invalid \\u escape", offset);
+            return;
+        }
+        code_unit = (code_unit << 4) | static_cast<uint32_t>(value);
+        if (++hex_digits < 4) return;
+
+        if (code_unit >= 0xDC00 && code_unit <= 0xDFFF && high_surrogate) {
+            const uint32_t code = 0x10000 + ((high_surrogate - 0xD800) << 10) + (code_unit - 0xDC00);
+            high_surrogate = 0;
+            appendUtf8(token, code);
+        } else {
+            flushSurrogate();
+            if (code_unit >= 0xD800 && code_unit <= 0xDBFF) {
+                high_surrogate = code_unit;
+            } else if (code_unit >= 0xDC00 && code_unit <= 0xDFFF) {
+                appendUtf8(token, kReplacementCharacter);
+            } else {
+                appendUtf8(token, code_unit);
+            }
+        }
+        if (token.size() > max_token) {
+            fail("token too long", offset);
+            return;
+        }
+        mode = Mode::String;
+    }
+
+    bool feed(const char* data, std::size_t size) {
+        const char* p = data;
+        const char* end = data + size;
+        while (p < end && mode != Mode::Failed) {
+            const std::size_t offset = consumed + static_cast<std::size_t>(p - data);
+            switch (mode) {
+            case Mode::String:
+                p = readString(p, end, data);
+                break;
+            case Mode::Escape:
+                escape(*p++, offset);
+                break;
+            case Mode::Unicode:
+                unicodeDigit(*p++, offset);
+                break;
+            case Mode::Number:
+                if (isNumberChar(*p)) {
+                    if (append(p, p + 1, offset)) ++p;
+                } else {
+                    endNumber(offset);   // *p is looked at again
+                }
+                break;
+            case Mode::Literal:
+                if (*p >= 'a' && *p <= 'z' && token.size() < 5) {
+                    token += *p++;
+                } else {
+                    endLiteral(offset);
+                }
+                break;
+            default:
+                structural(*p++, offset);
+                break;
+            }
+        }
+        consumed += size;
+        return mode != Mode::Failed;
+    }
+
+    bool finish() {
+        if (mode == Mode::Number) {
+            endNumber(consumed);
+        } else if (mode == Mode::Literal) {
+            endLiteral(consumed);
+        }
+        if (mode == Mode::Done) return true;
+        fail(consumed == 0 ? "empty document" : "unexpected end of document", consumed);
+        return false;
+    }
+};
+
+JsonStreamParser::JsonStreamParser(Handler& handler, std::size_t max_token)
+    : pImpl(std::make_unique<Impl>(handler, max_token)) {}
+
+JsonStreamParser::~JsonStreamParser() = default;
+
+bool JsonStreamParser::feed(const char* data, std::size_t size) {
+    return pImpl->feed(data, size);
+}
+
+bool JsonStreamParser::finish() {
+    return pImpl->finish();
+}
+
+bool JsonStreamParser::failed() const {
+    return pImpl->mode == Impl::Mode::Failed;
+}
+
+const std::string& JsonStreamParser::error() const {
+    return pImpl->error;
+}
+
+std::size_t JsonStreamParser::bytesConsumed() const {
+    return pImpl->consumed;
+}
+
+std::size_t JsonStreamParser::bufferedBytes() const {
+    return pImpl->token.size();
+}
+
+} // namespace tla_visualiser
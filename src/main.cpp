@@ -5,6 +5,7 @@
 #include "github_importer.h"
 #include "tlc_runner.h"
 #include "state_graph_model.h"
+#include "graph_item.h"
 #include "trace_viewer_model.h"
 
 int main(int argc, char *argv[]) {
@@ -18,6 +19,7 @@ int main(int argc, char *argv[]) {
     // Register types for QML
     qmlRegisterType<tla_visualiser::StateGraphModel>("TLAVisualiser", 1, 0, "StateGraphModel");
     qmlRegisterType<tla_visualiser::TraceViewerModel>("TLAVisualiser", 1, 0, "TraceViewerModel");
+    qmlRegisterType<tla_visualiser::GraphItem>("TLAVisualiser", 1, 0, "GraphItem");
 
     QQmlApplicationEngine engine;
     
@@ -0,0 +1,399 @@
+#include "results_file.h"
+#include "binary_format.h"
+#include "state_index.h"
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tla_visualiser {
+namespace results_file {
+
+namespace {
+
+using binary_format::Reader;
+using binary_format::Writer;
+
+constexpr char kMagic[8] = {'T', 'L', 'A', 'V', 'R', 'E', 'S', '\0'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;  // kByteOrderMark as the writer stored it
+    uint32_t section_count;
+    int32_t status;
+    int32_t states_generated;
+    int32_t distinct_states;
+    double execution_time_seconds;
+};
+
+enum SectionKind : uint32_t {
+    StringsSection = 1,
+    StatesSection = 2,
+    TransitionsSection = 3,
+    InvariantsSection = 4,
+    TracesSection = 5,
+};
+
+struct SectionEntry {
+    uint32_t kind;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+constexpr uint32_t kSectionCount = 5;
+
+// String table section: u64 count, u64 offsets[count + 1], characters.
+// Index 0 is the run's error message.
+class StringTable {
+public:
+    uint32_t add(std::string_view text) {
+        auto it = ids_.find(text);
+        if (it != ids_.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(strings_.size());
+        strings_.push_back(text);
+        ids_.emplace(text, id);
+        return id;
+    }
+
+    void write(Writer& out) const {
+        out.pod(uint64_t(strings_.size()));
+        uint64_t offset = 0;
+        out.pod(offset);
+        for (std::string_view text : strings_) {
+            offset += text.size();
+            out.pod(offset);
+        }
+        for (std::string_view text : strings_) {
+            out.bytes(text.data(), text.size());
+        }
+    }
+
+private:
+    // Views into `results`, which outlives the table
+    std::vector<std::string_view> strings_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+};
+
+struct InvariantEntry {
+    uint32_t name;
+    uint32_t passed;
+    uint32_t error_message;
+    int32_t error_state_id;
+};
+
+struct TraceEntry {
+    uint32_t description;
+    uint32_t reserved;
+    uint64_t step_count;
+};
+
+// Transitions section: u64 state_count, edge_count, extra_count, then
+// u64 offsets[state_count + 1] (by source position in the StateStore),
+// int32 targets[edge_count], uint32 actions[edge_count], and for edges
+// whose source is not a stored state int32 from/to and uint32 actions.
+void writeTransitions(Writer& out, const TLCRunner::RunResults& results, StringTable& strings) {
+    std::shared_ptr<const StateIndex> index = StateIndex::of(results);
+    const auto& transitions = results.transitions;
+    std::size_t state_count = results.states.size();
+
+    std::vector<uint64_t> offsets(state_count + 1, 0);
+    std::vector<long long> sources(transitions.size());
+    std::vector<std::size_t> extra;
+    for (std::size_t t = 0; t < transitions.size(); ++t) {
+        sources[t] = index->indexOf(transitions[t].from_state);
+        if (sources[t] >= 0) {
+            ++offsets[static_cast<std::size_t>(sources[t]) + 1];
+        } else {
+            extra.push_back(t);
+        }
+    }
+    for (std::size_t i = 0; i < state_count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    uint64_t edge_count = offsets[state_count];
+
+    std::vector<int32_t> targets(edge_count);
+    std::vector<uint32_t> actions(edge_count);
+    std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+    for (std::size_t t = 0; t < transitions.size(); ++t) {
+        if (sources[t] >= 0) {
+            uint64_t slot = next[static_cast<std::size_t>(sources[t])]++;
+            targets[slot] = transitions[t].to_state;
+            actions[slot] = strings.add(transitions[t].action);
+        }
+    }
+
+    out.pod(uint64_t(state_count));
+    out.pod(edge_count);
+    out.pod(uint64_t(extra.size()));
+    out.array(offsets.data(), offsets.size());
+    out.array(targets.data(), targets.size());
+    out.align();
+    out.array(actions.data(), actions.size());
+    out.align();
+    for (std::size_t t : extra) out.pod(int32_t(transitions[t].from_state));
+    out.align();
+    for (std::size_t t : extra) out.pod(int32_t(transitions[t].to_state));
+    out.align();
+    for (std::size_t t : extra) out.pod(strings.add(transitions[t].action));
+    out.align();
+}
+
+void writeInvariants(Writer& out, const TLCRunner::RunResults& results, StringTable& strings) {
+    out.pod(uint64_t(results.invariants.size()));
+    for (const auto& invariant : results.invariants) {
+        InvariantEntry entry{};
+        entry.name = strings.add(invariant.name);
+        entry.passed = invariant.passed ? 1 : 0;
+        entry.error_message = strings.add(invariant.error_message);
+        entry.error_state_id = invariant.error_state_id;
+        out.pod(entry);
+    }
+}
+
+void writeTraces(Writer& out, const TLCRunner::RunResults& results, StringTable& strings) {
+    out.pod(uint64_t(results.counterexamples.size()));
+    for (const auto& trace : results.counterexamples) {
+        TraceEntry entry{};
+        entry.description = strings.add(trace.description);
+        entry.step_count = trace.state_sequence.size();
+        out.pod(entry);
+    }
+    for (const auto& trace : results.counterexamples) {
+        for (int id : trace.state_sequence) out.pod(int32_t(id));
+    }
+    out.align();
+}
+
+class StringReader {
+public:
+    bool load(std::string_view section) {
+        Reader in(section.data(), section.size());
+        if (!in.pod(count_) || count_ >= (section.size() - 8) / 8) return false;
+        if (!in.array(8, count_ + 1, offsets_)) return false;
+        chars_ = section.substr(8 + (count_ + 1) * 8);
+        return true;
+    }
+
+    bool get(uint32_t id, std::string& out) const {
+        if (id >= count_) return false;
+        uint64_t begin = offsets_[id];
+        uint64_t end = offsets_[id + 1];
+        if (begin > end || end > chars_.size()) return false;
+        out.assign(chars_.data() + begin, end - begin);
+        return true;
+    }
+
+private:
+    uint64_t count_ = 0;
+    const uint64_t* offsets_ = nullptr;
+    std::string_view chars_;
+};
+
+bool readTransitions(std::string_view section, const StringReader& strings,
+                     TLCRunner::RunResults& results) {
+    Reader in(section.data(), section.size());
+    uint64_t state_count = 0, edge_count = 0, extra_count = 0;
+    if (!in.pod(state_count) || !in.pod(edge_count) || !in.pod(extra_count) ||
+        state_count != results.states.size()) {
+        return false;
+    }
+
+    using binary_format::padded;
+    const uint64_t* offsets = nullptr;
+    const int32_t* targets = nullptr;
+    const uint32_t* actions = nullptr;
+    const int32_t* extra_from = nullptr;
+    const int32_t* extra_to = nullptr;
+    const uint32_t* extra_actions = nullptr;
+    uint64_t at = in.position();
+    if (!in.array(at, state_count + 1, offsets)) return false;
+    at += (state_count + 1) * 8;
+    if (!in.array(at, edge_count, targets)) return false;
+    at += padded(edge_count * 4);
+    if (!in.array(at, edge_count, actions)) return false;
+    at += padded(edge_count * 4);
+    if (!in.array(at, extra_count, extra_from)) return false;
+    at += padded(extra_count * 4);
+    if (!in.array(at, extra_count, extra_to)) return false;
+    at += padded(extra_count * 4);
+    if (!in.array(at, extra_count, extra_actions)) return false;
+
+    // Action names repeat heavily; decode each table entry once
+    std::unordered_map<uint32_t, std::string> names;
+    auto actionName = [&](uint32_t id, std::string& out) {
+        auto it = names.find(id);
+        if (it == names.end()) {
+            std::string name;
+            if (!strings.get(id, name)) return false;
+            it = names.emplace(id, std::move(name)).first;
+        }
+        out = it->second;
+        return true;
+    };
+
+    std::vector<TLCRunner::Transition> transitions;
+    transitions.reserve(edge_count + extra_count);
+    uint64_t previous = 0;
+    for (uint64_t source = 0; source < state_count; ++source) {
+        uint64_t begin = offsets[source], end = offsets[source + 1];
+        if (begin != previous || end < begin || end > edge_count) return false;
+        previous = end;
+        int from = results.states.id(source);
+        for (uint64_t e = begin; e < end; ++e) {
+            TLCRunner::Transition transition{from, targets[e], std::string()};
+            if (!actionName(actions[e], transition.action)) return false;
+            transitions.push_back(std::move(transition));
+        }
+    }
+    if (previous != edge_count) return false;
+    for (uint64_t e = 0; e < extra_count; ++e) {
+        TLCRunner::Transition transition{extra_from[e], extra_to[e], std::string()};
+        if (!actionName(extra_actions[e], transition.action)) return false;
+        transitions.push_back(std::move(transition));
+    }
+
+    results.transitions = std::move(transitions);
+    return true;
+}
+
+bool readInvariants(std::string_view section, const StringReader& strings,
+                    TLCRunner::RunResults& results) {
+    Reader in(section.data(), section.size());
+    uint64_t count = 0;
+    if (!in.pod(count) || count > section.size() / sizeof(InvariantEntry)) return false;
+    for (uint64_t i = 0; i < count; ++i) {
+        InvariantEntry entry{};
+        if (!in.pod(entry)) return false;
+        TLCRunner::Invariant invariant{};
+        if (!strings.get(entry.name, invariant.name) ||
+            !strings.get(entry.error_message, invariant.error_message)) {
+            return false;
+        }
+        invariant.passed = entry.passed != 0;
+        invariant.error_state_id = entry.error_state_id;
+        results.invariants.push_back(std::move(invariant));
+    }
+    return true;
+}
+
+bool readTraces(std::string_view section, const StringReader& strings,
+                TLCRunner::RunResults& results) {
+    Reader in(section.data(), section.size());
+    uint64_t count = 0;
+    if (!in.pod(count) || count > section.size() / sizeof(TraceEntry)) return false;
+
+    std::vector<TraceEntry> entries(count);
+    for (auto& entry : entries) {
+        if (!in.pod(entry)) return false;
+    }
+    uint64_t at = in.position();
+    for (const auto& entry : entries) {
+        const int32_t* steps = nullptr;
+        if (!in.array(at, entry.step_count, steps)) return false;
+        at += entry.step_count * 4;
+        TLCRunner::CounterExample trace;
+        if (!strings.get(entry.description, trace.description)) return false;
+        trace.state_sequence.assign(steps, steps + entry.step_count);
+        results.counterexamples.push_back(std::move(trace));
+    }
+    return true;
+}
+
+} // namespace
+
+bool isResultsFile(std::string_view data) {
+    return data.size() >= sizeof(kMagic) && std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+bool write(std::ostream& out, const TLCRunner::RunResults& results) {
+    std::streampos start = out.tellp();
+    Writer writer(out);
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.section_count = kSectionCount;
+    header.status = static_cast<int32_t>(results.status);
+    header.states_generated = results.states_generated;
+    header.distinct_states = results.distinct_states;
+    header.execution_time_seconds = results.execution_time_seconds;
+    writer.pod(header);
+
+    // Section table, filled in once the section sizes are known
+    SectionEntry sections[kSectionCount] = {};
+    uint64_t table_position = writer.position();
+    writer.array(sections, kSectionCount);
+
+    StringTable strings;
+    strings.add(results.error_message);
+
+    auto section = [&writer](SectionEntry& entry, uint32_t kind, auto&& body) {
+        writer.align();
+        entry.kind = kind;
+        entry.offset = writer.position();
+        body();
+        entry.size = writer.position() - entry.offset;
+    };
+    section(sections[0], StatesSection, [&] { results.states.write(writer); });
+    section(sections[1], TransitionsSection, [&] { writeTransitions(writer, results, strings); });
+    section(sections[2], InvariantsSection, [&] { writeInvariants(writer, results, strings); });
+    section(sections[3], TracesSection, [&] { writeTraces(writer, results, strings); });
+    section(sections[4], StringsSection, [&] { strings.write(writer); });
+    writer.align();
+
+    std::streampos end = out.tellp();
+    out.seekp(start + std::streamoff(table_position));
+    out.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+    out.seekp(end);
+    return out.good();
+}
+
+bool read(std::string_view data, std::shared_ptr<const void> backing,
+          TLCRunner::RunResults& results) {
+    Reader in(data.data(), data.size());
+    FileHeader header{};
+    if (!isResultsFile(data) || !in.pod(header) || header.version != kVersion ||
+        header.byte_order != kByteOrderMark || header.status < 0 ||
+        header.status > static_cast<int32_t>(TLCRunner::Status::Cancelled)) {
+        return false;
+    }
+
+    std::string_view found[TracesSection + 1];
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        SectionEntry entry{};
+        if (!in.pod(entry) || entry.offset > data.size() || entry.size > data.size() - entry.offset) {
+            return false;
+        }
+        if (entry.kind <= TracesSection) {
+            found[entry.kind] = data.substr(entry.offset, entry.size);
+        }
+    }
+
+    TLCRunner::RunResults loaded{};
+    loaded.status = static_cast<TLCRunner::Status>(header.status);
+    loaded.states_generated = header.states_generated;
+    loaded.distinct_states = header.distinct_states;
+    loaded.execution_time_seconds = header.execution_time_seconds;
+
+    StringReader strings;
+    if (!strings.load(found[StringsSection]) || !strings.get(0, loaded.error_message)) {
+        return false;
+    }
+    if (!loaded.states.map(found[StatesSection], std::move(backing)) ||
+        !readTransitions(found[TransitionsSection], strings, loaded) ||
+        !readInvariants(found[InvariantsSection], strings, loaded) ||
+        !readTraces(found[TracesSection], strings, loaded)) {
+        return false;
+    }
+
+    results = std::move(loaded);
+    return true;
+}
+
+} // namespace results_file
+} // namespace tla_visualiser
@@ -0,0 +1,363 @@
+#include "run_cache.h"
+#include "results_file.h"
+#include "state_index.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QString>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace tla_visualiser {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view kExtension = ".tlcres";
+constexpr std::string_view kPartial = ".partial";
+
+bool readFile(const fs::path& path, std::string& contents) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Keys name files, so only accept what key() produces
+bool isValidKey(const std::string& key) {
+    return key.size() == 64 && std::all_of(key.begin(), key.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+bool isIdentifierChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Module names after EXTENDS (a comma-separated list) and INSTANCE.
+// Comments are not skipped: a name mentioned in one only costs a lookup.
+std::vector<std::string> referencedModules(std::string_view text) {
+    std::vector<std::string> names;
+    std::size_t pos = 0;
+    auto skipSpace = [&] {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) {
+            ++pos;
+        }
+    };
+    auto identifier = [&] {
+        const std::size_t start = pos;
+        while (pos < text.size() && isIdentifierChar(text[pos])) ++pos;
+        return text.substr(start, pos - start);
+    };
+
+    while (pos < text.size()) {
+        if (!isIdentifierChar(text[pos])) {
+            ++pos;
+            continue;
+        }
+        const std::string_view word = identifier();
+        if (word == "EXTENDS") {
+            for (;;) {
+                skipSpace();
+                const std::string_view name = identifier();
+                if (name.empty()) break;
+                names.emplace_back(name);
+                skipSpace();
+                if (pos >= text.size() || text[pos] != ',') break;
+                ++pos;
+            }
+        } else if (word == "INSTANCE") {
+            skipSpace();
+            const std::string_view name = identifier();
+            if (!name.empty()) names.emplace_back(name);
+        }
+    }
+    return names;
+}
+
+// Fields are length-prefixed so that no two inputs can run together
+void addField(QCryptographicHash& hash, std::string_view tag, std::string_view data) {
+    char length[8];
+    uint64_t size = data.size();
+    for (char& byte : length) {
+        byte = static_cast<char>(size & 0xff);
+        size >>= 8;
+    }
+    hash.addData(tag.data(), static_cast<qsizetype>(tag.size()));
+    hash.addData(length, sizeof(length));
+    hash.addData(data.data(), static_cast<qsizetype>(data.size()));
+}
+
+} // namespace
+
+class RunCache::Impl {
+public:
+    struct Entry {
+        uint64_t bytes;
+        uint64_t last_used;   // from `clock`; higher is more recent
+    };
+
+    std::string directory;
+    uint64_t max_bytes;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    uint64_t clock = 0;
+    uint64_t bytes = 0;
+    Stats counters;
+    std::atomic<uint64_t> partial_files{0};
+
+    // Digest of tla2tools.jar, recomputed when the file changes
+    mutable std::mutex jar_mutex;
+    mutable std::string jar_path;
+    mutable uintmax_t jar_size = 0;
+    mutable fs::file_time_type jar_time;
+    mutable std::string jar_digest;
+
+    Impl(const std::string& dir, uint64_t budget) : directory(dir), max_bytes(budget) {
+        std::error_code error;
+        fs::create_directories(directory, error);
+        scan();
+    }
+
+    fs::path pathOf(const std::string& key) const {
+        return fs::path(directory) / (key + std::string(kExtension));
+    }
+
+    // Picks up entries left by earlier sessions, oldest first so that
+    // their modification times carry the LRU order over
+    void scan() {
+        std::vector<std::pair<fs::file_time_type, std::pair<std::string, uint64_t>>> found;
+        std::error_code error;
+        for (const auto& item : fs::directory_iterator(directory, error)) {
+            const fs::path& path = item.path();
+            const std::string name = path.filename().string();
+            if (name.find(kPartial) != std::string::npos) {
+                fs::remove(path, error);   // a store that did not finish
+                continue;
+            }
+            if (path.extension() != kExtension || !isValidKey(path.stem().string())) continue;
+            const uintmax_t size = item.file_size(error);
+            if (error) continue;
+            found.push_back({item.last_write_time(error), {path.stem().string(), size}});
+        }
+        std::sort(found.begin(), found.end());
+        for (const auto& [time, entry] : found) {
+            entries[entry.first] = {entry.second, ++clock};
+            bytes += entry.second;
+        }
+        evict("");
+    }
+
+    // Called with the lock held
+    void evict(const std::string& keep) {
+        while (bytes > max_bytes) {
+            auto oldest = entries.end();
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->first == keep) continue;
+                if (oldest == entries.end() || it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            if (oldest == entries.end()) break;
+            remove(oldest);
+            ++counters.evictions;
+        }
+    }
+
+    void remove(std::unordered_map<std::string, Entry>::iterator it) {
+        std::error_code error;
+        fs::remove(pathOf(it->first), error);
+        bytes -= it->second.bytes;
+        entries.erase(it);
+    }
+
+    std::string jarDigest(const std::string& path) const {
+        std::error_code error;
+        const uintmax_t size = fs::file_size(path, error);
+        if (error) return "missing:" + path;
+        const fs::file_time_type time = fs::last_write_time(path, error);
+
+        std::lock_guard<std::mutex> lock(jar_mutex);
+        if (path == jar_path && size == jar_size && time == jar_time) return jar_digest;
+
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return "missing:" + path;
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        char buffer[64 * 1024];
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+            hash.addData(buffer, static_cast<qsizetype>(in.gcount()));
+        }
+        jar_path = path;
+        jar_size = size;
+        jar_time = time;
+        jar_digest = hash.result().toHex().toStdString();
+        return jar_digest;
+    }
+};
+
+RunCache::RunCache(const std::string& directory, uint64_t max_bytes)
+    : pImpl(std::make_unique<Impl>(directory, max_bytes)) {}
+
+RunCache::~RunCache() = default;
+
+const std::string& RunCache::directory() const {
+    return pImpl->directory;
+}
+
+std::string RunCache::key(const std::string& spec_file, const std::string& config_file,
+                          const TLCOptions& options) const {
+    // A resumed run continues from its checkpoint, whatever the inputs
+    if (!options.recover.empty()) return {};
+
+    std::string spec;
+    if (!readFile(spec_file, spec)) return {};
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    addField(hash, "spec", spec);
+
+    // Modules next to the spec, transitively. Library modules (Naturals,
+    // Sequences, ...) are not found there and count by name.
+    const fs::path spec_path(spec_file);
+    std::set<std::string> seen{spec_path.stem().string()};
+    std::vector<std::string> pending = referencedModules(spec);
+    std::map<std::string, std::string> modules;   // sorted: the key must not depend on discovery order
+    while (!pending.empty()) {
+        std::string name = std::move(pending.back());
+        pending.pop_back();
+        if (!seen.insert(name).second) continue;
+        std::string text;
+        if (readFile(spec_path.parent_path() / (name + ".tla"), text)) {
+            for (auto& next : referencedModules(text)) pending.push_back(std::move(next));
+        }
+        modules.emplace(std::move(name), std::move(text));
+    }
+    for (const auto& [name, text] : modules) {
+        addField(hash, "module", name);
+        addField(hash, "text", text);
+    }
+
+    // TLCRunner runs without a config it cannot find, and TLC then reads
+    // <Spec>.cfg from beside the spec
+    std::string config;
+    if ((!config_file.empty() && readFile(config_file, config)) ||
+        readFile(fs::path(spec_path).replace_extension(".cfg"), config)) {
+        addField(hash, "config", config);
+    }
+
+    addField(hash, "fp", std::to_string(options.fp_index));
+    for (const auto& arg : options.tlc_args) {
+        addField(hash, "arg", arg);
+    }
+    addField(hash, "tla2tools", pImpl->jarDigest(options.tla2tools_jar));
+
+    return hash.result().toHex().toStdString();
+}
+
+std::shared_ptr<const TLCRunner::RunResults> RunCache::lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = isValidKey(key) ? pImpl->entries.find(key) : pImpl->entries.end();
+    if (it == pImpl->entries.end()) {
+        ++pImpl->counters.misses;
+        return nullptr;
+    }
+
+    // Mapped like TLCRunner::loadResults: the states are read in place and
+    // keep the QFile alive. POSIX keeps the mapping valid if the entry is
+    // evicted meanwhile.
+    const fs::path path = pImpl->pathOf(key);
+    auto file = std::make_shared<QFile>(QString::fromStdString(path.string()));
+    TLCRunner::RunResults loaded{};
+    bool ok = false;
+    if (file->open(QIODevice::ReadOnly)) {
+        const qint64 size = file->size();
+        const uchar* mapped = size > 0 ? file->map(0, size) : nullptr;
+        if (mapped) {
+            std::string_view data(reinterpret_cast<const char*>(mapped), static_cast<std::size_t>(size));
+            ok = results_file::isResultsFile(data) && results_file::read(data, file, loaded);
+        }
+    }
+    if (!ok) {
+        // Unreadable or damaged: drop it, the run will be redone
+        file.reset();
+        pImpl->remove(it);
+        ++pImpl->counters.misses;
+        return nullptr;
+    }
+
+    it->second.last_used = ++pImpl->clock;
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    ++pImpl->counters.hits;
+
+    loaded.index = std::make_shared<const StateIndex>(loaded.states, loaded.transitions);
+    return std::make_shared<const TLCRunner::RunResults>(std::move(loaded));
+}
+
+bool RunCache::store(const std::string& key, const TLCRunner::RunResults& results) {
+    if (!isValidKey(key)) return false;
+
+    // Written aside and renamed into place, so a lookup never maps a
+    // half-written entry
+    const fs::path path = pImpl->pathOf(key);
+    fs::path partial = path;
+    partial += std::string(kPartial) + std::to_string(++pImpl->partial_files);
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        if (!out || !results_file::write(out, results) || !out.flush()) {
+            out.close();
+            std::error_code error;
+            fs::remove(partial, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    const uintmax_t size = fs::file_size(partial, error);
+    if (error || size > pImpl->max_bytes) {
+        fs::remove(partial, error);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    fs::rename(partial, path, error);
+    if (error) {
+        fs::remove(partial, error);
+        return false;
+    }
+    auto it = pImpl->entries.find(key);
+    if (it != pImpl->entries.end()) {
+        pImpl->bytes -= it->second.bytes;
+    }
+    pImpl->entries[key] = {size, ++pImpl->clock};
+    pImpl->bytes += size;
+    ++pImpl->counters.stores;
+    pImpl->evict(key);
+    return true;
+}
+
+void RunCache::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    while (!pImpl->entries.empty()) {
+        pImpl->remove(pImpl->entries.begin());
+    }
+}
+
+RunCache::Stats RunCache::stats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    Stats stats = pImpl->counters;
+    stats.bytes = pImpl->bytes;
+    stats.entries = pImpl->entries.size();
+    return stats;
+}
+
+} // namespace tla_visualiser
@@ -0,0 +1,549 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tla_visualiser {
+
+namespace {
+
+// Finest grid: about this many nodes per cell if they were spread evenly
+constexpr std::size_t kNodesPerCell = 4;
+// Caps the finest grid at 1024 x 1024 cells (4 MB of cell offsets)
+constexpr int kMaxGrid = 1024;
+
+uint64_t pairKey(uint32_t a, uint32_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// Counting sort of `count` entries into `cells` buckets; fills the CSR
+// offsets and the entries in bucket order (stable)
+template <typename CellOf>
+void bucket(std::size_t count, std::size_t cells, const CellOf& cell_of,
+            std::vector<uint32_t>& offsets, std::vector<uint32_t>& entries) {
+    offsets.assign(cells + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        ++offsets[cell_of(i) + 1];
+    }
+    for (std::size_t c = 0; c < cells; ++c) {
+        offsets[c + 1] += offsets[c];
+    }
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    entries.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        entries[next[cell_of(i)]++] = static_cast<uint32_t>(i);
+    }
+}
+
+// Finest grid for `count` nodes; a power of two
+int gridFor(std::size_t count) {
+    int grid = 1;
+    while (grid < kMaxGrid && static_cast<std::size_t>(grid) * grid * kNodesPerCell < count) {
+        grid *= 2;
+    }
+    return grid;
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(const std::vector<Point>& positions, const std::vector<Edge>& edges)
+    : node_count_(positions.size()) {
+    if (positions.empty()) {
+        levels_.emplace_back();
+        levels_.back().cell_offsets.assign(2, 0);
+        levels_.back().link_offsets.assign(1, 0);
+        return;
+    }
+
+    bounds_ = {positions[0].first, positions[0].second, positions[0].first, positions[0].second};
+    for (const auto& [x, y] : positions) {
+        bounds_.left = std::min(bounds_.left, x);
+        bounds_.right = std::max(bounds_.right, x);
+        bounds_.top = std::min(bounds_.top, y);
+        bounds_.bottom = std::max(bounds_.bottom, y);
+    }
+    origin_x_ = bounds_.left;
+    origin_y_ = bounds_.top;
+    double side = std::max(bounds_.right - bounds_.left, bounds_.bottom - bounds_.top);
+    if (!(side > 0)) side = 1.0;
+
+    const int grid = gridFor(node_count_);
+
+    // Level 0: the nodes, bucketed by finest cell
+    Level nodes;
+    nodes.grid = grid;
+    nodes.cell = side / grid;
+    nodes.items.resize(node_count_);
+    for (std::size_t i = 0; i < node_count_; ++i) {
+        nodes.items[i] = {static_cast<float>(positions[i].first),
+                          static_cast<float>(positions[i].second), 1, static_cast<uint32_t>(i)};
+    }
+    levels_.push_back(std::move(nodes));
+
+    // Finest cell of each item of the level being merged
+    std::vector<uint32_t> item_cell(node_count_);
+    for (std::size_t i = 0; i < node_count_; ++i) {
+        item_cell[i] = cellAt(0, positions[i].first, positions[i].second);
+    }
+    {
+        Level& level = levels_[0];
+        bucket(node_count_, static_cast<std::size_t>(grid) * grid,
+               [&item_cell](std::size_t i) { return item_cell[i]; },
+               level.cell_offsets, level.cell_items);
+        level.item_cells = item_cell;
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> pairs;
+    pairs.reserve(edges.size());
+    for (const auto& [from, to] : edges) {
+        if (from != to && from < node_count_ && to < node_count_) {
+            pairs.push_back({pairKey(from, to), 1});
+        }
+    }
+    buildLinks(levels_[0], pairs);
+
+    // Levels 1..: one item per occupied cell, halving the grid each time
+    int child_grid = grid;
+    for (int parent_grid = grid; ; parent_grid /= 2) {
+        const Level& child = levels_.back();
+        const int shrink = child_grid / parent_grid;   // 1 for level 1, else 2
+
+        Level level;
+        level.grid = parent_grid;
+        level.cell = side / parent_grid;
+        level.spacing = level.cell;
+
+        const std::size_t cells = static_cast<std::size_t>(parent_grid) * parent_grid;
+        std::vector<uint32_t> parent_cell(child.items.size());
+        for (std::size_t i = 0; i < child.items.size(); ++i) {
+            const uint32_t c = item_cell[i];
+            const uint32_t cx = (c % child_grid) / shrink;
+            const uint32_t cy = (c / child_grid) / shrink;
+            parent_cell[i] = cy * parent_grid + cx;
+        }
+
+        // Occupied cells in cell order become the items
+        std::vector<int32_t> item_of_cell(cells, -1);
+        std::vector<double> sum_x, sum_y;
+        std::vector<uint32_t> parent_of(child.items.size());
+        for (std::size_t i = 0; i < child.items.size(); ++i) {
+            item_of_cell[parent_cell[i]] = 0;
+        }
+        std::vector<uint32_t> new_item_cell;
+        for (std::size_t c = 0; c < cells; ++c) {
+            if (item_of_cell[c] < 0) continue;
+            item_of_cell[c] = static_cast<int32_t>(level.items.size());
+            level.items.push_back({0, 0, 0, UINT32_MAX});
+            new_item_cell.push_back(static_cast<uint32_t>(c));
+        }
+        sum_x.assign(level.items.size(), 0);
+        sum_y.assign(level.items.size(), 0);
+        for (std::size_t i = 0; i < child.items.size(); ++i) {
+            const Item& from = child.items[i];
+            const uint32_t p = static_cast<uint32_t>(item_of_cell[parent_cell[i]]);
+            parent_of[i] = p;
+            Item& into = level.items[p];
+            into.count += from.count;
+            into.node = std::min(into.node, from.node);
+            sum_x[p] += static_cast<double>(from.x) * from.count;
+            sum_y[p] += static_cast<double>(from.y) * from.count;
+        }
+        for (std::size_t p = 0; p < level.items.size(); ++p) {
+            level.items[p].x = static_cast<float>(sum_x[p] / level.items[p].count);
+            level.items[p].y = static_cast<float>(sum_y[p] / level.items[p].count);
+        }
+        bucket(level.items.size(), cells,
+               [&new_item_cell](std::size_t i) { return new_item_cell[i]; },
+               level.cell_offsets, level.cell_items);
+        level.item_cells = new_item_cell;
+
+        // Links of the merged items; `pairs` holds the child level's links
+        for (auto& [key, weight] : pairs) {
+            key = pairKey(parent_of[key >> 32], parent_of[key & 0xFFFFFFFFu]);
+        }
+        pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+                                   [](const auto& pair) {
+                                       return (pair.first >> 32) == (pair.first & 0xFFFFFFFFu);
+                                   }),
+                    pairs.end());
+        buildLinks(level, pairs);
+
+        if (levels_.size() == 1) {
+            // Nodes are about sqrt(count per occupied cell) to a cell side apart
+            levels_[0].spacing = levels_[0].cell *
+                std::sqrt(static_cast<double>(level.items.size()) / node_count_);
+        }
+        item_cell = std::move(new_item_cell);
+        child_grid = parent_grid;
+        levels_.push_back(std::move(level));
+        if (parent_grid == 1) break;
+    }
+}
+
+SpatialIndex SpatialIndex::updated(const std::vector<Point>& positions, const std::vector<Edge>& edges,
+                                   std::size_t first_new_edge, const std::vector<uint32_t>& moved) const {
+    const std::size_t count = positions.size();
+    std::vector<uint32_t> changed;
+    changed.reserve(moved.size() + (count > node_count_ ? count - node_count_ : 0));
+    for (uint32_t i : moved) {
+        if (i < node_count_ && i < count) changed.push_back(i);
+    }
+    for (std::size_t i = node_count_; i < count; ++i) {
+        changed.push_back(static_cast<uint32_t>(i));
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    bool rebuild = node_count_ == 0 || count < node_count_ || gridFor(count) != levels_[0].grid ||
+                   changed.size() * 2 > count;
+    for (std::size_t i = 0; i < changed.size() && !rebuild; ++i) {
+        rebuild = !bounds_.contains(positions[changed[i]].first, positions[changed[i]].second);
+    }
+    if (rebuild) {
+        return SpatialIndex(positions, edges);
+    }
+
+    SpatialIndex next(*this);
+    next.node_count_ = count;
+
+    // Level 0: the nodes themselves
+    Level& nodes = next.levels_[0];
+    nodes.items.resize(count);
+    nodes.item_cells.resize(count);
+    bool regroup = false;
+    for (uint32_t i : changed) {
+        const double x = positions[i].first;
+        const double y = positions[i].second;
+        nodes.items[i] = {static_cast<float>(x), static_cast<float>(y), 1, i};
+        const uint32_t cell = cellAt(0, x, y);
+        regroup |= i >= node_count_ || cell != nodes.item_cells[i];
+        nodes.item_cells[i] = cell;
+    }
+    if (regroup) {
+        bucketItems(nodes);
+    }
+    std::vector<std::pair<uint64_t, int64_t>> link_changes;
+    for (std::size_t e = first_new_edge; e < edges.size(); ++e) {
+        const auto [from, to] = edges[e];
+        if (from != to && from < count && to < count) {
+            link_changes.push_back({pairKey(from, to), 1});
+        }
+    }
+    patchLinks(nodes, link_changes);
+
+    // Each coarser level: re-merge the cells its changed children left or
+    // joined, and move their links' weight to the new pair of parents
+    for (std::size_t level = 0; level + 1 < levels_.size(); ++level) {
+        const Level& old_child = levels_[level];
+        const Level& child = next.levels_[level];
+        Level& parent = next.levels_[level + 1];
+        const int shrink = child.grid / parent.grid;
+        auto parentCell = [&](uint32_t cell) {
+            const uint32_t cx = (cell % child.grid) / shrink;
+            const uint32_t cy = (cell / child.grid) / shrink;
+            return cy * parent.grid + cx;
+        };
+        auto oldParent = [&](uint32_t c) -> int64_t {
+            if (c >= old_child.items.size() || old_child.items[c].count == 0) return -1;
+            return itemAt(level + 1, parentCell(old_child.item_cells[c]));
+        };
+        auto newParent = [&](uint32_t c) -> int64_t {
+            if (child.items[c].count == 0) return -1;
+            return next.itemAt(level + 1, parentCell(child.item_cells[c]));
+        };
+
+        std::vector<uint32_t> cells;
+        for (uint32_t c : changed) {
+            if (c < old_child.items.size() && old_child.items[c].count > 0) {
+                cells.push_back(parentCell(old_child.item_cells[c]));
+            }
+            if (child.items[c].count > 0) {
+                cells.push_back(parentCell(child.item_cells[c]));
+            }
+        }
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+        std::vector<uint32_t> changed_parents;
+        bool regroup_parent = false;
+        for (uint32_t cell : cells) {
+            const uint32_t px = cell % parent.grid;
+            const uint32_t py = cell / parent.grid;
+            Item merged{0, 0, 0, UINT32_MAX};
+            double sum_x = 0, sum_y = 0;
+            for (int dy = 0; dy < shrink; ++dy) {
+                // The child cells of one row are one contiguous run
+                const std::size_t row = static_cast<std::size_t>(py * shrink + dy) * child.grid + px * shrink;
+                for (uint32_t k = child.cell_offsets[row]; k < child.cell_offsets[row + shrink]; ++k) {
+                    const Item& from = child.items[child.cell_items[k]];
+                    merged.count += from.count;
+                    merged.node = std::min(merged.node, from.node);
+                    sum_x += static_cast<double>(from.x) * from.count;
+                    sum_y += static_cast<double>(from.y) * from.count;
+                }
+            }
+            // The parent cells are not regrouped yet, so this is the old item
+            int64_t p = next.itemAt(level + 1, cell);
+            if (merged.count > 0) {
+                merged.x = static_cast<float>(sum_x / merged.count);
+                merged.y = static_cast<float>(sum_y / merged.count);
+                if (p < 0) {
+                    p = static_cast<int64_t>(parent.items.size());
+                    parent.items.push_back(merged);
+                    parent.item_cells.push_back(cell);
+                    regroup_parent = true;
+                } else {
+                    parent.items[p] = merged;
+                }
+            } else if (p >= 0) {
+                parent.items[p] = {0, 0, 0, UINT32_MAX};
+                ++parent.empty_items;
+                regroup_parent = true;
+            } else {
+                continue;
+            }
+            changed_parents.push_back(static_cast<uint32_t>(p));
+        }
+        if (regroup_parent) {
+            bucketItems(parent);
+        }
+
+        // A link moves to another pair of parents only if one of its ends
+        // changed parent: those are taken off the old pair and put on the
+        // new one, each link once, from its lower such end. Any other link
+        // whose weight changed passes the change on as it is.
+        std::vector<uint32_t> rehomed;
+        for (uint32_t c : changed) {
+            if (oldParent(c) != newParent(c)) rehomed.push_back(c);
+        }
+        auto isRehomed = [&rehomed](uint32_t c) {
+            return std::binary_search(rehomed.begin(), rehomed.end(), c);
+        };
+
+        std::vector<std::pair<uint64_t, int64_t>> parent_changes;
+        auto add = [&parent_changes](int64_t from, int64_t to, int64_t weight) {
+            if (from >= 0 && to >= 0 && from != to) {
+                parent_changes.push_back({pairKey(static_cast<uint32_t>(from), static_cast<uint32_t>(to)), weight});
+            }
+        };
+        for (uint32_t c : rehomed) {
+            if (c < old_child.items.size()) {
+                for (const Link& link : links(level, c)) {
+                    if (link.to < c && isRehomed(link.to)) continue;
+                    add(oldParent(c), oldParent(link.to), -static_cast<int64_t>(link.weight));
+                }
+            }
+            for (const Link& link : next.links(level, c)) {
+                if (link.to < c && isRehomed(link.to)) continue;
+                add(newParent(c), newParent(link.to), link.weight);
+            }
+        }
+        for (const auto& [key, change] : link_changes) {
+            const auto a = static_cast<uint32_t>(key >> 32);
+            const auto b = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+            if (!isRehomed(a) && !isRehomed(b)) add(newParent(a), newParent(b), change);
+        }
+        patchLinks(parent, parent_changes);
+
+        changed = std::move(changed_parents);
+        std::sort(changed.begin(), changed.end());
+        link_changes = std::move(parent_changes);
+    }
+
+    // Empty items are only skipped over; once they pile up, start afresh
+    std::size_t items = 0, empty = 0;
+    for (const Level& level : next.levels_) {
+        items += level.items.size();
+        empty += level.empty_items;
+    }
+    if (empty * 4 > items) {
+        return SpatialIndex(positions, edges);
+    }
+    if (next.levels_.size() > 1) {
+        const Level& merged = next.levels_[1];
+        next.levels_[0].spacing = next.levels_[0].cell *
+            std::sqrt(static_cast<double>(merged.items.size() - merged.empty_items) / count);
+    }
+    return next;
+}
+
+void SpatialIndex::bucketItems(Level& level) {
+    // As bucket(), leaving out the empty items
+    const std::size_t cells = static_cast<std::size_t>(level.grid) * level.grid;
+    level.cell_offsets.assign(cells + 1, 0);
+    for (std::size_t i = 0; i < level.items.size(); ++i) {
+        if (level.items[i].count > 0) ++level.cell_offsets[level.item_cells[i] + 1];
+    }
+    for (std::size_t c = 0; c < cells; ++c) {
+        level.cell_offsets[c + 1] += level.cell_offsets[c];
+    }
+    std::vector<uint32_t> next(level.cell_offsets.begin(), level.cell_offsets.end() - 1);
+    level.cell_items.resize(level.cell_offsets[cells]);
+    for (std::size_t i = 0; i < level.items.size(); ++i) {
+        if (level.items[i].count > 0) level.cell_items[next[level.item_cells[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+void SpatialIndex::patchLinks(Level& level, std::vector<std::pair<uint64_t, int64_t>>& changes) {
+    // Merge changes to the same pair; `changes` keeps the nonzero sums
+    std::sort(changes.begin(), changes.end());
+    std::size_t unique = 0;
+    for (std::size_t i = 0; i < changes.size(); ++i) {
+        if (unique > 0 && changes[unique - 1].first == changes[i].first) {
+            changes[unique - 1].second += changes[i].second;
+        } else {
+            if (unique > 0 && changes[unique - 1].second == 0) --unique;
+            changes[unique++] = changes[i];
+        }
+    }
+    if (unique > 0 && changes[unique - 1].second == 0) --unique;
+    changes.resize(unique);
+
+    const std::size_t count = level.items.size();
+    level.link_offsets.resize(count + 1, level.link_offsets.back());
+    // Each item's links are sorted by target (buildLinks() emits them so)
+    auto find = [&level](uint32_t a, uint32_t b) -> Link* {
+        Link* first = level.links.data() + level.link_offsets[a];
+        Link* last = level.links.data() + level.link_offsets[a + 1];
+        Link* at = std::lower_bound(first, last, b, [](const Link& link, uint32_t to) { return link.to < to; });
+        return at != last && at->to == b ? at : nullptr;
+    };
+
+    // Existing links change weight in place; new and emptied ones need
+    // the lists rebuilt
+    std::vector<std::pair<uint32_t, Link>> added;
+    bool emptied = false;
+    for (const auto& [key, change] : changes) {
+        const auto a = static_cast<uint32_t>(key >> 32);
+        const auto b = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+        if (Link* ab = find(a, b)) {
+            const auto weight = static_cast<uint32_t>(std::max<int64_t>(0, ab->weight + change));
+            ab->weight = weight;
+            find(b, a)->weight = weight;
+            emptied |= weight == 0;
+        } else if (change > 0) {
+            added.push_back({a, {b, static_cast<uint32_t>(change)}});
+            added.push_back({b, {a, static_cast<uint32_t>(change)}});
+        }
+    }
+    if (added.empty() && !emptied) return;
+
+    std::sort(added.begin(), added.end(), [](const auto& x, const auto& y) {
+        return x.first != y.first ? x.first < y.first : x.second.to < y.second.to;
+    });
+    std::vector<uint32_t> offsets(count + 1, 0);
+    std::vector<Link> links;
+    links.reserve(level.links.size() + added.size());
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        // Merge the added links in, keeping the targets sorted
+        offsets[i] = static_cast<uint32_t>(links.size());
+        for (uint32_t e = level.link_offsets[i]; e < level.link_offsets[i + 1]; ++e) {
+            for (; k < added.size() && added[k].first == i && added[k].second.to < level.links[e].to; ++k) {
+                links.push_back(added[k].second);
+            }
+            if (level.links[e].weight > 0) links.push_back(level.links[e]);
+        }
+        for (; k < added.size() && added[k].first == i; ++k) {
+            links.push_back(added[k].second);
+        }
+    }
+    offsets[count] = static_cast<uint32_t>(links.size());
+    level.link_offsets = std::move(offsets);
+    level.links = std::move(links);
+}
+
+int64_t SpatialIndex::itemAt(std::size_t level, uint32_t cell) const {
+    // Coarser levels hold at most one item per cell
+    const Level& l = levels_[level];
+    if (l.cell_offsets[cell] == l.cell_offsets[cell + 1]) return -1;
+    return l.cell_items[l.cell_offsets[cell]];
+}
+
+void SpatialIndex::buildLinks(Level& level, std::vector<std::pair<uint64_t, uint32_t>>& pairs) {
+    // Merge duplicates, summing weights; `pairs` keeps the merged list
+    std::sort(pairs.begin(), pairs.end());
+    std::size_t unique = 0;
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        if (unique > 0 && pairs[unique - 1].first == pairs[i].first) {
+            pairs[unique - 1].second += pairs[i].second;
+        } else {
+            pairs[unique++] = pairs[i];
+        }
+    }
+    pairs.resize(unique);
+
+    const std::size_t count = level.items.size();
+    level.link_offsets.assign(count + 1, 0);
+    for (const auto& [key, weight] : pairs) {
+        ++level.link_offsets[(key >> 32) + 1];
+        ++level.link_offsets[(key & 0xFFFFFFFFu) + 1];
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        level.link_offsets[i + 1] += level.link_offsets[i];
+    }
+    std::vector<uint32_t> next(level.link_offsets.begin(), level.link_offsets.end() - 1);
+    level.links.resize(2 * pairs.size());
+    for (const auto& [key, weight] : pairs) {
+        const auto a = static_cast<uint32_t>(key >> 32);
+        const auto b = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+        level.links[next[a]++] = {b, weight};
+        level.links[next[b]++] = {a, weight};
+    }
+}
+
+std::size_t SpatialIndex::levelFor(double scale, double min_pixels) const {
+    for (std::size_t level = 0; level + 1 < levels_.size(); ++level) {
+        if (levels_[level].spacing * scale >= min_pixels) return level;
+    }
+    return levels_.size() - 1;
+}
+
+std::span<const SpatialIndex::Link> SpatialIndex::links(std::size_t level, uint32_t item) const {
+    const Level& l = levels_[level];
+    return std::span<const Link>(l.links).subspan(l.link_offsets[item],
+                                                  l.link_offsets[item + 1] - l.link_offsets[item]);
+}
+
+SpatialIndex::CellRange SpatialIndex::cellRange(std::size_t level, const Rect& rect) const {
+    const Level& l = levels_[level];
+    const double x0 = std::floor((rect.left - origin_x_) / l.cell);
+    const double x1 = std::floor((rect.right - origin_x_) / l.cell);
+    const double y0 = std::floor((rect.top - origin_y_) / l.cell);
+    const double y1 = std::floor((rect.bottom - origin_y_) / l.cell);
+    // The last row and column also hold positions exactly on the far edge
+    if (x1 < 0 || y1 < 0 || x0 > l.grid || y0 > l.grid || node_count_ == 0) return {};
+    const double last = l.grid - 1.0;
+    return {static_cast<int>(std::clamp(x0, 0.0, last)), static_cast<int>(std::clamp(y0, 0.0, last)),
+            static_cast<int>(std::min(x1, last)), static_cast<int>(std::min(y1, last))};
+}
+
+uint32_t SpatialIndex::cellAt(std::size_t level, double x, double y) const {
+    const Level& l = levels_[level];
+    const double cx = std::clamp(std::floor((x - origin_x_) / l.cell), 0.0, l.grid - 1.0);
+    const double cy = std::clamp(std::floor((y - origin_y_) / l.cell), 0.0, l.grid - 1.0);
+    return static_cast<uint32_t>(cy) * l.grid + static_cast<uint32_t>(cx);
+}
+
+void SpatialIndex::collect(std::size_t level, const CellRange& cells, std::vector<uint32_t>& out) const {
+    if (cells.empty()) return;
+    const Level& l = levels_[level];
+    for (int y = cells.y0; y <= cells.y1; ++y) {
+        // A row of cells is one contiguous run of cell_items
+        const std::size_t row = static_cast<std::size_t>(y) * l.grid;
+        const uint32_t begin = l.cell_offsets[row + cells.x0];
+        const uint32_t end = l.cell_offsets[row + cells.x1 + 1];
+        out.insert(out.end(), l.cell_items.begin() + begin, l.cell_items.begin() + end);
+    }
+}
+
+void SpatialIndex::query(std::size_t level, const Rect& rect, std::vector<uint32_t>& out) const {
+    const std::size_t start = out.size();
+    collect(level, cellRange(level, rect), out);
+    const std::vector<Item>& items = levels_[level].items;
+    out.erase(std::remove_if(out.begin() + start, out.end(),
+                             [&](uint32_t i) { return !rect.contains(items[i].x, items[i].y); }),
+              out.end());
+}
+
+} // namespace tla_visualiser
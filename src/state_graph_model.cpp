@@ -1,39 +1,234 @@
 #include "state_graph_model.h"
+#include "graph_layout.h"
+#include "spatial_index.h"
+#include "role_cache.h"
 #include <QVariantMap>
 #include <QVariantList>
 #include <algorithm>
-#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace tla_visualiser {
 
+namespace {
+
+QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+} // namespace
+
 class StateGraphModel::Impl {
 public:
-    std::vector<TLCRunner::State> states;
-    std::vector<TLCRunner::Transition> transitions;
+    // Shared with the snapshot or results it came from; replaced by a grown
+    // copy (sharing all full blocks) when rows are appended
+    std::shared_ptr<const StateStore> states = std::make_shared<const StateStore>();
     std::vector<std::pair<double, double>> positions;
-    double layout_radius = 200.0;  // Configurable radius
+    LayoutMode layout_mode = LayoutMode::ForceDirected;
+    RoleCache role_cache;   // description and variables, converted once per row
+
+    // Exported to QML; edges are appended as transitions arrive, positions
+    // rebuilt with each layout and patched where appends move rows
+    QByteArray edge_buffer;
+    QByteArray position_buffer;
+    std::shared_ptr<const SpatialIndex> spatial;
+    QStringList action_names;
+    mutable QVariantList transition_list;   // getTransitions(), built on first use
+    mutable bool transition_list_valid = false;
+
+    // State id -> row, grown as rows are added. Ids are usually the rows
+    // themselves (TLCOutputParser numbers them that way); the map is only
+    // filled once they are not.
+    std::size_t indexed_rows = 0;
+    bool dense_ids = true;
+    std::unordered_map<int, int32_t> sparse_rows;
+
+    std::unordered_map<std::string, int32_t> action_ids;
+    std::size_t transition_count = 0;
+    // Transitions whose endpoints have not been loaded yet; retried on
+    // every append
+    std::vector<TLCRunner::Transition> pending;
+
+    long long rowOf(int state_id) const {
+        if (dense_ids) {
+            return state_id >= 0 && static_cast<std::size_t>(state_id) < indexed_rows ? state_id : -1;
+        }
+        auto it = sparse_rows.find(state_id);
+        return it == sparse_rows.end() ? -1 : it->second;
+    }
+
+    void indexRows() {
+        for (std::size_t row = indexed_rows; row < states->size(); ++row) {
+            const int id = states->id(row);
+            if (dense_ids) {
+                if (id == static_cast<int>(row)) continue;
+                dense_ids = false;
+                sparse_rows.reserve(states->size());
+                for (std::size_t i = 0; i < row; ++i) {
+                    sparse_rows.emplace(static_cast<int>(i), static_cast<int32_t>(i));
+                }
+            }
+            // If several states share an id, the first one wins
+            sparse_rows.try_emplace(id, static_cast<int32_t>(row));
+        }
+        indexed_rows = states->size();
+    }
+
+    std::vector<GraphLayout::Edge> layoutEdges() const {
+        const auto* packed = reinterpret_cast<const int32_t*>(edge_buffer.constData());
+        const std::size_t count = static_cast<std::size_t>(edge_buffer.size()) / (3 * sizeof(int32_t));
+        std::vector<GraphLayout::Edge> edges;
+        edges.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            edges.push_back({static_cast<uint32_t>(packed[3 * i]),
+                             static_cast<uint32_t>(packed[3 * i + 1])});
+        }
+        return edges;
+    }
 
     void calculateLayout() {
-        // Simple circular layout with configurable radius
-        int n = states.size();
-        if (n == 0) return;
-
-        positions.clear();
-        
-        // Adjust radius based on number of nodes for better spacing
-        double radius = layout_radius;
-        if (n > 10) {
-            radius = layout_radius * (1.0 + std::log(n / 10.0));
+        const std::vector<GraphLayout::Edge> edges = layoutEdges();
+        if (layout_mode == LayoutMode::Circular) {
+            GraphLayout::circular(states->size(), positions);
+        } else if (layout_mode == LayoutMode::Layered) {
+            GraphLayout::layered(states->size(), edges, positions);
+        } else {
+            // Positions already in `positions` are kept as a warm start
+            GraphLayout::forceDirected(states->size(), edges, positions);
+        }
+        buildPositionBuffer();
+        spatial = std::make_shared<const SpatialIndex>(positions, edges);
+    }
+
+    // Places rows added since the last layout and the endpoints of the
+    // edges packed from `first_edge` on. Force-directed layouts settle just
+    // those against the pinned rest; circular and layered placement depend
+    // on the whole graph, so those are recomputed (in linear time) and
+    // compared. Returns the rows that moved, ascending.
+    std::vector<uint32_t> extendLayout(std::size_t first_edge) {
+        const std::vector<GraphLayout::Edge> edges = layoutEdges();
+        std::vector<uint32_t> moved;
+        if (layout_mode == LayoutMode::ForceDirected) {
+            GraphLayout::refine(states->size(), edges, first_edge, positions, moved);
+        } else {
+            const std::vector<std::pair<double, double>> before = positions;
+            if (layout_mode == LayoutMode::Circular) {
+                GraphLayout::circular(states->size(), positions);
+            } else {
+                GraphLayout::layered(states->size(), edges, positions);
+            }
+            for (std::size_t row = 0; row < positions.size(); ++row) {
+                if (row >= before.size() || positions[row] != before[row]) {
+                    moved.push_back(static_cast<uint32_t>(row));
+                }
+            }
+        }
+
+        position_buffer.resize(static_cast<qsizetype>(positions.size() * 2 * sizeof(float)));
+        auto* packed = reinterpret_cast<float*>(position_buffer.data());
+        for (uint32_t row : moved) {
+            packed[2 * row] = static_cast<float>(positions[row].first);
+            packed[2 * row + 1] = static_cast<float>(positions[row].second);
+        }
+        spatial = spatial
+            ? std::make_shared<const SpatialIndex>(spatial->updated(positions, edges, first_edge, moved))
+            : std::make_shared<const SpatialIndex>(positions, edges);
+        return moved;
+    }
+
+    // Packs `added` (and any pending transitions that can now be placed)
+    // onto the end of edge_buffer
+    void appendEdges(const std::vector<TLCRunner::Transition>& added) {
+        std::vector<int32_t> packed;
+        packed.reserve(3 * (pending.size() + added.size()));
+        std::vector<TLCRunner::Transition> waiting;
+        auto pack = [&](const TLCRunner::Transition& transition) {
+            long long from = rowOf(transition.from_state);
+            long long to = rowOf(transition.to_state);
+            if (from < 0 || to < 0) return false;
+
+            auto [it, inserted] = action_ids.try_emplace(
+                transition.action, static_cast<int32_t>(action_names.size()));
+            if (inserted) action_names.append(QString::fromStdString(transition.action));
+
+            packed.push_back(static_cast<int32_t>(from));
+            packed.push_back(static_cast<int32_t>(to));
+            packed.push_back(it->second);
+            return true;
+        };
+        for (auto& transition : pending) {
+            if (!pack(transition)) waiting.push_back(std::move(transition));
+        }
+        for (const auto& transition : added) {
+            if (!pack(transition)) waiting.push_back(transition);
         }
-        
-        double angle_step = 2.0 * M_PI / n;
-
-        for (int i = 0; i < n; ++i) {
-            double angle = i * angle_step;
-            double x = radius * std::cos(angle);
-            double y = radius * std::sin(angle);
-            positions.push_back({x, y});
+        pending = std::move(waiting);
+        transition_count += added.size();
+
+        edge_buffer.append(reinterpret_cast<const char*>(packed.data()),
+                           static_cast<qsizetype>(packed.size() * sizeof(int32_t)));
+        transition_list = QVariantList();
+        transition_list_valid = false;
+    }
+
+    void buildPositionBuffer() {
+        position_buffer.resize(static_cast<qsizetype>(positions.size() * 2 * sizeof(float)));
+        auto* packed = reinterpret_cast<float*>(position_buffer.data());
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            packed[2 * i] = static_cast<float>(positions[i].first);
+            packed[2 * i + 1] = static_cast<float>(positions[i].second);
+        }
+    }
+
+    void clearGraph() {
+        edge_buffer.clear();
+        position_buffer.clear();
+        spatial.reset();
+        action_names.clear();
+        transition_list = QVariantList();
+        transition_list_valid = false;
+        indexed_rows = 0;
+        dense_ids = true;
+        sparse_rows.clear();
+        action_ids.clear();
+        transition_count = 0;
+        pending.clear();
+    }
+
+    // True if `next` starts with the states currently shown, so their
+    // positions can seed the new layout
+    bool extends(const StateStore& next) const {
+        if (next.size() < states->size()) return false;
+        for (std::size_t i = 0; i < states->size(); ++i) {
+            if (next.id(i) != states->id(i)) return false;
+        }
+        return true;
+    }
+
+    void load(std::shared_ptr<const StateStore> next,
+              const std::vector<TLCRunner::Transition>& transitions) {
+        if (!extends(*next)) {
+            positions.clear();
         }
+        clearGraph();
+        states = std::move(next);
+        role_cache.clear();
+        indexRows();
+        appendEdges(transitions);
+        calculateLayout();
+    }
+
+    QVariantList variablesOf(std::size_t index) const {
+        QVariantList vars;
+        states->forEachVariable(index, [&vars](std::string_view key, std::string_view value) {
+            QVariantMap var;
+            var["name"] = toQString(key);
+            var["value"] = toQString(value);
+            vars.append(var);
+        });
+        return vars;
     }
 };
 
@@ -44,32 +239,28 @@ StateGraphModel::~StateGraphModel() = default;
 
 int StateGraphModel::rowCount(const QModelIndex& parent) const {
     if (parent.isValid()) return 0;
-    return pImpl->states.size();
+    return pImpl->states->size();
 }
 
 QVariant StateGraphModel::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || index.row() >= static_cast<int>(pImpl->states.size())) {
+    if (!index.isValid() || index.row() >= static_cast<int>(pImpl->states->size())) {
         return QVariant();
     }
 
-    const auto& state = pImpl->states[index.row()];
-    const auto& pos = pImpl->positions[index.row()];
+    const std::size_t row = static_cast<std::size_t>(index.row());
+    const auto& pos = pImpl->positions[row];
 
     switch (role) {
     case StateIdRole:
-        return state.id;
+        return pImpl->states->id(row);
     case StateDescriptionRole:
-        return QString::fromStdString(state.description);
-    case StateVariablesRole: {
-        QVariantList vars;
-        for (const auto& [key, value] : state.variables) {
-            QVariantMap var;
-            var["name"] = QString::fromStdString(key);
-            var["value"] = QString::fromStdString(value);
-            vars.append(var);
-        }
-        return vars;
-    }
+        return pImpl->role_cache.value(index.row(), role, [this, row] {
+            return toQString(pImpl->states->description(row));
+        });
+    case StateVariablesRole:
+        return pImpl->role_cache.value(index.row(), role, [this, row] {
+            return pImpl->variablesOf(row);
+        });
     case StateXRole:
         return pos.first;
     case StateYRole:
@@ -90,62 +281,182 @@ QHash<int, QByteArray> StateGraphModel::roleNames() const {
 }
 
 void StateGraphModel::loadFromResults(const TLCRunner::RunResults& results) {
+    // The copy shares the store's blocks; only the tables are duplicated
     beginResetModel();
-    pImpl->states = results.states;
-    pImpl->transitions = results.transitions;
-    pImpl->calculateLayout();
+    pImpl->load(std::make_shared<const StateStore>(results.states), results.transitions);
+    endResetModel();
+    emit graphUpdated();
+}
+
+void StateGraphModel::loadFromSnapshot(std::shared_ptr<const TLCRunner::RunResults> snapshot) {
+    if (!snapshot) {
+        clear();
+        return;
+    }
+    beginResetModel();
+    const auto& transitions = snapshot->transitions;
+    // Aliasing: the model's store is the snapshot's, kept alive with it
+    pImpl->load(std::shared_ptr<const StateStore>(snapshot, &snapshot->states), transitions);
     endResetModel();
     emit graphUpdated();
 }
 
+void StateGraphModel::appendResults(const TLCRunner::RunResults& delta) {
+    if (delta.states.empty() && delta.transitions.empty()) return;
+
+    const int first = rowCount();
+    const int added = static_cast<int>(delta.states.size());
+    if (added > 0) {
+        beginInsertRows(QModelIndex(), first, first + added - 1);
+        auto grown = std::make_shared<StateStore>(*pImpl->states);
+        grown->append(delta.states);
+        pImpl->states = std::move(grown);
+        pImpl->indexRows();
+    }
+    const std::size_t first_edge =
+        static_cast<std::size_t>(pImpl->edge_buffer.size()) / (3 * sizeof(int32_t));
+    pImpl->appendEdges(delta.transitions);
+    const std::vector<uint32_t> moved = pImpl->extendLayout(first_edge);
+    if (added > 0) {
+        endInsertRows();
+    }
+
+    // Only the earlier rows that moved, in runs of consecutive rows
+    for (std::size_t i = 0; i < moved.size() && moved[i] < static_cast<uint32_t>(first);) {
+        std::size_t end = i + 1;
+        while (end < moved.size() && moved[end] == moved[end - 1] + 1 &&
+               moved[end] < static_cast<uint32_t>(first)) {
+            ++end;
+        }
+        emit dataChanged(index(static_cast<int>(moved[i])), index(static_cast<int>(moved[end - 1])),
+                         {StateXRole, StateYRole});
+        i = end;
+    }
+    emit graphUpdated();
+}
+
 void StateGraphModel::clear() {
     beginResetModel();
-    pImpl->states.clear();
-    pImpl->transitions.clear();
+    pImpl->states = std::make_shared<const StateStore>();
     pImpl->positions.clear();
+    pImpl->clearGraph();
+    pImpl->role_cache.clear();
     endResetModel();
+    emit graphUpdated();
 }
 
 QVariantList StateGraphModel::getTransitions() const {
-    QVariantList result;
-    for (const auto& trans : pImpl->transitions) {
-        QVariantMap t;
-        t["from"] = trans.from_state;
-        t["to"] = trans.to_state;
-        t["action"] = QString::fromStdString(trans.action);
-        result.append(t);
+    // Kept for existing callers; drawing code should use edgeBuffer().
+    // Rebuilt from the packed edges, followed by the transitions whose
+    // endpoints are not loaded yet.
+    if (!pImpl->transition_list_valid) {
+        const auto* packed = reinterpret_cast<const int32_t*>(pImpl->edge_buffer.constData());
+        const std::size_t count =
+            static_cast<std::size_t>(pImpl->edge_buffer.size()) / (3 * sizeof(int32_t));
+        QVariantList result;
+        result.reserve(static_cast<qsizetype>(count + pImpl->pending.size()));
+        for (std::size_t i = 0; i < count; ++i) {
+            QVariantMap t;
+            t["from"] = pImpl->states->id(static_cast<std::size_t>(packed[3 * i]));
+            t["to"] = pImpl->states->id(static_cast<std::size_t>(packed[3 * i + 1]));
+            t["action"] = pImpl->action_names[packed[3 * i + 2]];
+            result.append(t);
+        }
+        for (const auto& trans : pImpl->pending) {
+            QVariantMap t;
+            t["from"] = trans.from_state;
+            t["to"] = trans.to_state;
+            t["action"] = QString::fromStdString(trans.action);
+            result.append(t);
+        }
+        pImpl->transition_list = std::move(result);
+        pImpl->transition_list_valid = true;
     }
-    return result;
+    return pImpl->transition_list;
 }
 
 QVariantMap StateGraphModel::getStateDetails(int stateId) const {
-    auto it = std::find_if(pImpl->states.begin(), pImpl->states.end(),
-                          [stateId](const TLCRunner::State& s) { return s.id == stateId; });
-    
     QVariantMap result;
-    if (it != pImpl->states.end()) {
-        result["id"] = it->id;
-        result["description"] = QString::fromStdString(it->description);
-        
-        QVariantList vars;
-        for (const auto& [key, value] : it->variables) {
-            QVariantMap var;
-            var["name"] = QString::fromStdString(key);
-            var["value"] = QString::fromStdString(value);
-            vars.append(var);
-        }
-        result["variables"] = vars;
+    long long i = pImpl->rowOf(stateId);
+    if (i >= 0) {
+        result["id"] = stateId;
+        result["description"] = data(index(static_cast<int>(i)), StateDescriptionRole);
+        result["variables"] = data(index(static_cast<int>(i)), StateVariablesRole);
     }
     
     return result;
 }
 
 int StateGraphModel::nodeCount() const {
-    return pImpl->states.size();
+    return pImpl->states->size();
 }
 
 int StateGraphModel::edgeCount() const {
-    return pImpl->transitions.size();
+    return static_cast<int>(pImpl->transition_count);
+}
+
+QByteArray StateGraphModel::edgeBuffer() const {
+    return pImpl->edge_buffer;
+}
+
+QByteArray StateGraphModel::positionBuffer() const {
+    return pImpl->position_buffer;
+}
+
+QStringList StateGraphModel::actionNames() const {
+    return pImpl->action_names;
+}
+
+QList<int> StateGraphModel::nodesInRect(const QRectF& rect) const {
+    QList<int> rows;
+    if (!pImpl->spatial) return rows;
+    std::vector<uint32_t> found;
+    pImpl->spatial->query(0, {rect.left(), rect.top(), rect.right(), rect.bottom()}, found);
+    rows.reserve(static_cast<qsizetype>(found.size()));
+    for (uint32_t row : found) rows.append(static_cast<int>(row));
+    return rows;
+}
+
+QVariantList StateGraphModel::viewportItems(const QRectF& viewport, qreal scale, qreal minPixels) const {
+    QVariantList result;
+    if (!pImpl->spatial || !(scale > 0)) return result;
+    const SpatialIndex& spatial = *pImpl->spatial;
+    const std::size_t level = spatial.levelFor(scale, minPixels);
+    std::vector<uint32_t> found;
+    spatial.query(level, {viewport.left(), viewport.top(), viewport.right(), viewport.bottom()}, found);
+
+    result.reserve(static_cast<qsizetype>(found.size()));
+    for (uint32_t i : found) {
+        const SpatialIndex::Item& item = spatial.items(level)[i];
+        QVariantMap entry;
+        entry["x"] = item.x;
+        entry["y"] = item.y;
+        entry["count"] = static_cast<int>(item.count);
+        entry["row"] = static_cast<int>(item.node);
+        result.append(entry);
+    }
+    return result;
+}
+
+std::shared_ptr<const SpatialIndex> StateGraphModel::spatialIndex() const {
+    return pImpl->spatial;
+}
+
+StateGraphModel::LayoutMode StateGraphModel::layoutMode() const {
+    return pImpl->layout_mode;
+}
+
+void StateGraphModel::setLayoutMode(LayoutMode mode) {
+    if (mode == pImpl->layout_mode) return;
+    pImpl->layout_mode = mode;
+    emit layoutModeChanged();
+
+    if (pImpl->states->empty()) return;
+    // A fresh layout, not a warm start from the previous mode's positions
+    pImpl->positions.clear();
+    pImpl->calculateLayout();
+    emit dataChanged(index(0), index(rowCount() - 1), {StateXRole, StateYRole});
+    emit graphUpdated();
 }
 
 } // namespace tla_visualiser
@@ -0,0 +1,115 @@
+#include "state_index.h"
+#include <limits>
+#include <stdexcept>
+
+namespace tla_visualiser {
+
+namespace {
+
+std::size_t hashId(int id) {
+    // splitmix64 finaliser; ids are often sequential, which would cluster
+    // badly under linear probing without mixing
+    uint64_t x = static_cast<uint32_t>(id);
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return static_cast<std::size_t>(x);
+}
+
+} // namespace
+
+StateIndex::StateIndex(const StateStore& states,
+                       const std::vector<TLCRunner::Transition>& transitions)
+    : state_count_(states.size()) {
+    if (state_count_ > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()) ||
+        transitions.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("StateIndex: too many states or transitions");
+    }
+
+    for (std::size_t i = 0; i < state_count_ && dense_; ++i) {
+        dense_ = states.id(i) == static_cast<int>(i);
+    }
+
+    if (!dense_) {
+        std::size_t capacity = 16;
+        while (capacity < state_count_ * 2) capacity *= 2;
+        slot_ids_.assign(capacity, 0);
+        slot_index_.assign(capacity, -1);
+        std::size_t mask = capacity - 1;
+        for (std::size_t i = 0; i < state_count_; ++i) {
+            int id = states.id(i);
+            std::size_t slot = hashId(id) & mask;
+            while (slot_index_[slot] != -1 && slot_ids_[slot] != id) {
+                slot = (slot + 1) & mask;
+            }
+            if (slot_index_[slot] == -1) {
+                slot_ids_[slot] = id;
+                slot_index_[slot] = static_cast<int32_t>(i);
+            }
+        }
+    }
+
+    // Counting sort of transition positions by target state
+    std::vector<int32_t> targets(transitions.size());
+    incoming_offsets_.assign(state_count_ + 1, 0);
+    for (std::size_t t = 0; t < transitions.size(); ++t) {
+        long long target = indexOf(transitions[t].to_state);
+        targets[t] = static_cast<int32_t>(target);
+        if (target >= 0) {
+            ++incoming_offsets_[static_cast<std::size_t>(target) + 1];
+        }
+    }
+    for (std::size_t i = 0; i < state_count_; ++i) {
+        incoming_offsets_[i + 1] += incoming_offsets_[i];
+    }
+    incoming_edges_.resize(incoming_offsets_[state_count_]);
+    std::vector<uint32_t> next(incoming_offsets_.begin(), incoming_offsets_.end() - 1);
+    for (std::size_t t = 0; t < transitions.size(); ++t) {
+        if (targets[t] >= 0) {
+            incoming_edges_[next[targets[t]]++] = static_cast<uint32_t>(t);
+        }
+    }
+}
+
+std::shared_ptr<const StateIndex> StateIndex::of(const TLCRunner::RunResults& results) {
+    if (results.index) {
+        return results.index;
+    }
+    return std::make_shared<const StateIndex>(results.states, results.transitions);
+}
+
+long long StateIndex::indexOf(int state_id) const {
+    if (dense_) {
+        return state_id >= 0 && static_cast<std::size_t>(state_id) < state_count_ ? state_id : -1;
+    }
+    std::size_t mask = slot_ids_.size() - 1;
+    for (std::size_t slot = hashId(state_id) & mask; slot_index_[slot] != -1; slot = (slot + 1) & mask) {
+        if (slot_ids_[slot] == state_id) {
+            return slot_index_[slot];
+        }
+    }
+    return -1;
+}
+
+std::span<const uint32_t> StateIndex::incoming(std::size_t index) const {
+    if (index >= state_count_) {
+        return {};
+    }
+    return std::span<const uint32_t>(incoming_edges_.data() + incoming_offsets_[index],
+                                     incoming_offsets_[index + 1] - incoming_offsets_[index]);
+}
+
+long long StateIndex::incomingFrom(std::size_t index, int from_id,
+                                   const std::vector<TLCRunner::Transition>& transitions) const {
+    std::span<const uint32_t> edges = incoming(index);
+    for (uint32_t t : edges) {
+        if (t < transitions.size() && transitions[t].from_state == from_id) {
+            return t;
+        }
+    }
+    return edges.empty() ? -1 : static_cast<long long>(edges.front());
+}
+
+} // namespace tla_visualiser
@@ -0,0 +1,424 @@
+#include "state_store.h"
+#include "binary_format.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace tla_visualiser {
+
+namespace {
+
+// Start a new block early once any column arena passes this size, so
+// 32-bit offsets can never overflow within a block
+constexpr std::size_t kMaxBlockBytes = std::size_t(1) << 30;
+
+// Section layout written by StateStore::write(), offsets relative to the
+// section start:
+//
+//   SectionHeader
+//   names, descriptions         length-prefixed strings
+//   BlockEntry[block_count]
+//   ColumnEntry[column_count]   columns of all blocks, block by block
+//   bulk data                   ids, descriptions, offsets and values,
+//                               each array 8-byte aligned
+struct SectionHeader {
+    uint64_t state_count;
+    uint64_t block_count;
+    uint64_t column_count;
+    uint64_t name_count;
+    uint64_t description_count;
+    uint64_t blocks_offset;
+};
+
+struct BlockEntry {
+    uint64_t first;
+    uint64_t count;
+    uint64_t ids;
+    uint64_t descriptions;
+    uint64_t column_begin;
+    uint64_t column_count;
+};
+
+struct ColumnEntry {
+    uint64_t offsets;
+    uint64_t offset_count;  // 0 or count + 1
+    uint64_t data;
+    uint64_t data_size;
+};
+
+} // namespace
+
+StateStore::StateStore() = default;
+StateStore::~StateStore() = default;
+StateStore::StateStore(const StateStore&) = default;
+StateStore::StateStore(StateStore&&) noexcept = default;
+StateStore& StateStore::operator=(const StateStore&) = default;
+StateStore& StateStore::operator=(StateStore&&) noexcept = default;
+
+void StateStore::clear() {
+    blocks_.clear();
+    names_.clear();
+    name_index_.clear();
+    description_table_.clear();
+    description_index_.clear();
+    position_columns_.clear();
+    last_description_ = 0;
+    size_ = 0;
+    backing_.reset();
+}
+
+std::size_t StateStore::append(const StateStore& other, std::size_t first) {
+    const std::size_t start = size_;
+    const std::size_t end = other.size();
+    for (std::size_t i = first; i < end; ++i) {
+        beginState(other.id(i), other.description(i));
+        other.forEachVariable(i, [this](std::string_view name, std::string_view value) {
+            setValue(name, value);
+        });
+        endState();
+    }
+    return start;
+}
+
+uint32_t StateStore::intern(std::string_view text, InternMap& map, std::vector<std::string>& table) {
+    auto it = map.find(text);
+    if (it != map.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(table.size());
+    table.emplace_back(text);
+    map.emplace(std::string(text), id);
+    return id;
+}
+
+std::size_t StateStore::beginState(int id, std::string_view description) {
+    bool need_block = blocks_.empty() || blocks_.back()->size() >= kBlockSize ||
+                      !blocks_.back()->mapped_ids.empty();
+    if (!need_block) {
+        for (const auto& column : blocks_.back()->columns) {
+            if (column.data.size() >= kMaxBlockBytes) {
+                need_block = true;
+                break;
+            }
+        }
+    }
+    if (need_block) {
+        if (!blocks_.empty() && blocks_.back().use_count() == 1) {
+            // The previous block is complete: release arena growth slack
+            for (auto& column : blocks_.back()->columns) {
+                column.data.shrink_to_fit();
+            }
+        }
+        auto block = std::make_shared<Block>();
+        block->first = size_;
+        block->ids.reserve(kBlockSize);
+        block->descriptions.reserve(kBlockSize);
+        blocks_.push_back(std::move(block));
+    } else if (blocks_.back().use_count() > 1) {
+        // Copy-on-write: another store still shares this partial block
+        blocks_.back() = std::make_shared<Block>(*blocks_.back());
+    }
+
+    Block& block = *blocks_.back();
+    block.ids.push_back(id);
+    if (last_description_ >= description_table_.size() ||
+        description_table_[last_description_] != description) {
+        last_description_ = intern(description, description_index_, description_table_);
+    }
+    block.descriptions.push_back(last_description_);
+    next_position_ = 0;
+    return size_++;
+}
+
+void StateStore::setValue(std::string_view name, std::string_view value) {
+    // States usually list the same variables in the same order, so try the
+    // column used at this position by the previous state before hashing
+    std::size_t position = next_position_++;
+    uint32_t column_index;
+    if (position < position_columns_.size() && names_[position_columns_[position]] == name) {
+        column_index = position_columns_[position];
+    } else {
+        column_index = intern(name, name_index_, names_);
+        if (position >= position_columns_.size()) {
+            position_columns_.resize(position + 1);
+        }
+        position_columns_[position] = column_index;
+    }
+
+    Block& block = *blocks_.back();
+    std::size_t local = block.ids.size() - 1;
+
+    if (column_index >= block.columns.size()) {
+        block.columns.resize(column_index + 1);
+    }
+    Column& column = block.columns[column_index];
+    if (column.offsets.empty()) {
+        // Column first seen part-way through the block: earlier states are unset
+        column.offsets.reserve(kBlockSize + 1);
+        column.offsets.assign(local + 1, 0);
+    }
+    if (column.offsets.size() != local + 1) {
+        return;  // duplicate name within one state; keep the first value
+    }
+    if (column.data.size() + value.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("StateStore: variable value too large");
+    }
+
+    column.data.append(value.data(), value.size());
+    column.offsets.push_back(static_cast<uint32_t>(column.data.size()));
+}
+
+void StateStore::endState() {
+    Block& block = *blocks_.back();
+    std::size_t local = block.ids.size() - 1;
+    for (auto& column : block.columns) {
+        if (column.offsets.empty()) {
+            column.offsets.reserve(kBlockSize + 1);
+            column.offsets.assign(local + 1, 0);
+        }
+        if (column.offsets.size() == local + 1) {
+            column.offsets.push_back(static_cast<uint32_t>(column.data.size()));
+        }
+    }
+}
+
+const StateStore::Block& StateStore::blockFor(std::size_t index, std::size_t& local) const {
+    // Blocks are kBlockSize states unless cut short by kMaxBlockBytes, so
+    // the division is almost always the right guess
+    std::size_t guess = std::min(index / kBlockSize, blocks_.size() - 1);
+    if (blocks_[guess]->first > index ||
+        index - blocks_[guess]->first >= blocks_[guess]->size()) {
+        auto it = std::upper_bound(blocks_.begin(), blocks_.end(), index,
+                                   [](std::size_t i, const std::shared_ptr<Block>& b) {
+                                       return i < b->first;
+                                   });
+        guess = static_cast<std::size_t>(it - blocks_.begin()) - 1;
+    }
+    local = index - blocks_[guess]->first;
+    return *blocks_[guess];
+}
+
+int StateStore::id(std::size_t index) const {
+    std::size_t local;
+    const Block& block = blockFor(index, local);
+    return block.ids.empty() ? block.mapped_ids[local] : block.ids[local];
+}
+
+std::string_view StateStore::description(std::size_t index) const {
+    std::size_t local;
+    const Block& block = blockFor(index, local);
+    uint32_t text = block.descriptions.empty() ? block.mapped_descriptions[local]
+                                               : block.descriptions[local];
+    return text < description_table_.size() ? std::string_view(description_table_[text])
+                                            : std::string_view();
+}
+
+std::string_view StateStore::variableName(std::size_t column) const {
+    return column < names_.size() ? std::string_view(names_[column]) : std::string_view();
+}
+
+int StateStore::findVariable(std::string_view name) const {
+    auto it = name_index_.find(name);
+    return it == name_index_.end() ? -1 : static_cast<int>(it->second);
+}
+
+std::string_view StateStore::value(std::size_t index, std::size_t column) const {
+    std::size_t local;
+    const Block& block = blockFor(index, local);
+    if (column >= block.columns.size()) {
+        return std::string_view();
+    }
+    std::span<const uint32_t> offsets = block.columns[column].offsetSpan();
+    if (local + 1 >= offsets.size()) {
+        return std::string_view();
+    }
+    std::string_view data = block.columns[column].dataView();
+    uint32_t begin = offsets[local];
+    uint32_t end = offsets[local + 1];
+    if (begin > end || end > data.size()) {
+        return std::string_view();  // corrupt mapped file
+    }
+    return data.substr(begin, end - begin);
+}
+
+std::size_t StateStore::memoryUsage() const {
+    std::size_t bytes = blocks_.capacity() * sizeof(blocks_[0]) + blocks_.size() * sizeof(Block);
+    for (const auto& shared : blocks_) {
+        const Block& block = *shared;
+        bytes += block.ids.capacity() * sizeof(int);
+        bytes += block.descriptions.capacity() * sizeof(uint32_t);
+        bytes += block.columns.capacity() * sizeof(Column);
+        for (const auto& column : block.columns) {
+            bytes += column.offsets.capacity() * sizeof(uint32_t);
+            bytes += column.data.capacity();
+        }
+    }
+    for (const auto& name : names_) bytes += sizeof(std::string) + name.capacity();
+    for (const auto& text : description_table_) bytes += sizeof(std::string) + text.capacity();
+    return bytes;
+}
+
+void StateStore::write(binary_format::Writer& out) const {
+    using binary_format::padded;
+
+    std::size_t column_count = 0;
+    for (const auto& block : blocks_) column_count += block->columns.size();
+
+    uint64_t strings_size = 0;
+    for (const auto& name : names_) strings_size += 8 + padded(name.size());
+    for (const auto& text : description_table_) strings_size += 8 + padded(text.size());
+
+    SectionHeader header{};
+    header.state_count = size_;
+    header.block_count = blocks_.size();
+    header.column_count = column_count;
+    header.name_count = names_.size();
+    header.description_count = description_table_.size();
+    header.blocks_offset = sizeof(SectionHeader) + strings_size;
+    out.pod(header);
+    for (const auto& name : names_) out.string(name);
+    for (const auto& text : description_table_) out.string(text);
+
+    // Directory first, so opening a file reads only its first pages
+    std::vector<BlockEntry> block_entries;
+    std::vector<ColumnEntry> column_entries;
+    block_entries.reserve(blocks_.size());
+    column_entries.reserve(column_count);
+    uint64_t bulk = header.blocks_offset + blocks_.size() * sizeof(BlockEntry) +
+                    column_count * sizeof(ColumnEntry);
+    for (const auto& shared : blocks_) {
+        const Block& block = *shared;
+        BlockEntry entry{};
+        entry.first = block.first;
+        entry.count = block.size();
+        entry.ids = bulk;
+        bulk += padded(entry.count * sizeof(int));
+        entry.descriptions = bulk;
+        bulk += padded(entry.count * sizeof(uint32_t));
+        entry.column_begin = column_entries.size();
+        entry.column_count = block.columns.size();
+        block_entries.push_back(entry);
+
+        for (const auto& column : block.columns) {
+            ColumnEntry column_entry{};
+            column_entry.offsets = bulk;
+            column_entry.offset_count = column.offsetSpan().size();
+            bulk += padded(column_entry.offset_count * sizeof(uint32_t));
+            column_entry.data = bulk;
+            column_entry.data_size = column.dataView().size();
+            bulk += padded(column_entry.data_size);
+            column_entries.push_back(column_entry);
+        }
+    }
+    out.array(block_entries.data(), block_entries.size());
+    out.array(column_entries.data(), column_entries.size());
+
+    for (const auto& shared : blocks_) {
+        const Block& block = *shared;
+        std::span<const int> ids = block.ids.empty() ? block.mapped_ids : std::span<const int>(block.ids);
+        std::span<const uint32_t> descriptions = block.descriptions.empty()
+            ? block.mapped_descriptions : std::span<const uint32_t>(block.descriptions);
+        out.array(ids.data(), ids.size());
+        out.align();
+        out.array(descriptions.data(), descriptions.size());
+        out.align();
+        for (const auto& column : block.columns) {
+            std::span<const uint32_t> offsets = column.offsetSpan();
+            std::string_view data = column.dataView();
+            out.array(offsets.data(), offsets.size());
+            out.align();
+            out.bytes(data.data(), data.size());
+            out.align();
+        }
+    }
+}
+
+bool StateStore::map(std::string_view section, std::shared_ptr<const void> backing) {
+    clear();
+    binary_format::Reader in(section.data(), section.size());
+
+    SectionHeader header{};
+    if (!in.pod(header)) return false;
+
+    auto fail = [this]() {
+        clear();
+        return false;
+    };
+
+    for (uint64_t i = 0; i < header.name_count; ++i) {
+        std::string_view name;
+        if (!in.string(name)) return fail();
+        names_.emplace_back(name);
+        name_index_.emplace(std::string(name), static_cast<uint32_t>(i));
+    }
+    for (uint64_t i = 0; i < header.description_count; ++i) {
+        std::string_view text;
+        if (!in.string(text)) return fail();
+        description_table_.emplace_back(text);
+        description_index_.emplace(std::string(text), static_cast<uint32_t>(i));
+    }
+
+    const BlockEntry* block_entries = nullptr;
+    const ColumnEntry* column_entries = nullptr;
+    if (!in.array(header.blocks_offset, header.block_count, block_entries) ||
+        !in.array(header.blocks_offset + header.block_count * sizeof(BlockEntry),
+                  header.column_count, column_entries)) {
+        return fail();
+    }
+
+    blocks_.reserve(header.block_count);
+    uint64_t expected_first = 0;
+    for (uint64_t b = 0; b < header.block_count; ++b) {
+        BlockEntry entry;
+        std::memcpy(&entry, &block_entries[b], sizeof(entry));
+        if (entry.first != expected_first || entry.count == 0 ||
+            entry.column_begin > header.column_count ||
+            entry.column_count > header.column_count - entry.column_begin ||
+            entry.column_count > names_.size()) {
+            return fail();
+        }
+
+        auto shared = std::make_shared<Block>();
+        Block& block = *shared;
+        block.first = entry.first;
+        const int* ids = nullptr;
+        const uint32_t* descriptions = nullptr;
+        if (!in.array(entry.ids, entry.count, ids) ||
+            !in.array(entry.descriptions, entry.count, descriptions)) {
+            return fail();
+        }
+        block.mapped_ids = std::span<const int>(ids, entry.count);
+        block.mapped_descriptions = std::span<const uint32_t>(descriptions, entry.count);
+
+        block.columns.resize(entry.column_count);
+        for (uint64_t c = 0; c < entry.column_count; ++c) {
+            ColumnEntry column_entry;
+            std::memcpy(&column_entry, &column_entries[entry.column_begin + c], sizeof(column_entry));
+            if (column_entry.offset_count != 0 && column_entry.offset_count != entry.count + 1) {
+                return fail();
+            }
+            const uint32_t* offsets = nullptr;
+            const char* data = nullptr;
+            if (!in.array(column_entry.offsets, column_entry.offset_count, offsets) ||
+                !in.array(column_entry.data, column_entry.data_size, data)) {
+                return fail();
+            }
+            Column& column = block.columns[c];
+            column.mapped_offsets = std::span<const uint32_t>(offsets, column_entry.offset_count);
+            column.mapped_data = std::string_view(data, column_entry.data_size);
+        }
+
+        expected_first += entry.count;
+        blocks_.push_back(std::move(shared));
+    }
+    if (expected_first != header.state_count) {
+        return fail();
+    }
+
+    size_ = header.state_count;
+    backing_ = std::move(backing);
+    return true;
+}
+
+} // namespace tla_visualiser
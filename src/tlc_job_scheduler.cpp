@@ -0,0 +1,283 @@
+#include "tlc_job_scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace tla_visualiser {
+
+class TLCJobScheduler::Impl {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Queued {
+        JobId id;
+        JobSpec spec;
+    };
+
+    struct Running {
+        JobId id;
+        JobSpec spec;
+        TLCRunner* runner;
+        int workers;
+        Clock::time_point start;
+    };
+
+    int core_budget;
+    std::size_t max_concurrent;
+    int heap_mb;   // per job, for jobs that do not set one
+
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+    std::vector<Queued> queue;   // by priority, then submission order
+    std::vector<Running> running;
+    std::vector<TLCRunner*> idle_runners;
+    std::vector<JobResult> finished;
+    std::unordered_map<JobId, std::size_t> finished_index;
+    JobId next_id = 1;
+    int cores_in_use = 0;
+    std::size_t completed = 0, failed = 0, cancelled = 0;
+    uint64_t states_generated = 0, distinct_states = 0;
+    std::optional<Clock::time_point> first_start;
+    Clock::time_point last_finish;
+    std::function<void(const JobResult&)> finished_callback;
+    std::shared_ptr<RunCache> cache;
+
+    // Declared last so the runners, whose callbacks use the members above,
+    // are destroyed (and their threads joined) first
+    std::vector<std::unique_ptr<TLCRunner>> runners;
+
+    Impl(int budget, int concurrent) {
+        const int hardware = static_cast<int>(std::thread::hardware_concurrency());
+        core_budget = budget > 0 ? budget : std::max(1, hardware);
+        max_concurrent = concurrent > 0 ? static_cast<std::size_t>(concurrent)
+                                        : static_cast<std::size_t>(core_budget);
+        heap_mb = TLCOptions::autoHeapMb(0, static_cast<int>(max_concurrent));
+    }
+
+    TLCOptions optionsFor(const JobSpec& spec, int workers) const {
+        TLCOptions options = spec.options;
+        options.workers = workers;
+        if (options.heap_mb <= 0) options.heap_mb = heap_mb;
+        if (options.gc == TLCOptions::GarbageCollector::Default) {
+            options.gc = TLCOptions::GarbageCollector::Parallel;
+        }
+        return options;
+    }
+
+    TLCRunner* acquireRunner() {
+        if (!idle_runners.empty()) {
+            TLCRunner* runner = idle_runners.back();
+            idle_runners.pop_back();
+            return runner;
+        }
+        runners.push_back(std::make_unique<TLCRunner>());
+        TLCRunner* runner = runners.back().get();
+        runner->setStatusCallback([this, runner](TLCRunner::Status status) {
+            // Running is reported from startModelCheck(), under our lock
+            if (status != TLCRunner::Status::Running) {
+                onFinished(runner, status);
+            }
+        });
+        return runner;
+    }
+
+    // Starts queued jobs while cores and slots are free. Called with the
+    // lock held.
+    void dispatch() {
+        while (!queue.empty()) {
+            const int free_cores = core_budget - cores_in_use;
+            if (free_cores <= 0 || running.size() >= max_concurrent) break;
+
+            // Split the free cores evenly among the jobs that can start now,
+            // but no job takes more than its fair share of the budget among
+            // the jobs actually waiting or running: a job submitted alone
+            // gets every core
+            const std::size_t starting = std::min({queue.size(), max_concurrent - running.size(),
+                                                   static_cast<std::size_t>(free_cores)});
+            const std::size_t sharing = std::min(max_concurrent, running.size() + queue.size());
+            const int fair_share = std::max(1, core_budget / static_cast<int>(sharing));
+            int workers = std::clamp(free_cores / static_cast<int>(starting), 1, fair_share);
+
+            Queued job = std::move(queue.front());
+            queue.erase(queue.begin());
+            if (job.spec.max_workers > 0) {
+                workers = std::min(workers, job.spec.max_workers);
+            }
+
+            TLCRunner* runner = acquireRunner();
+            runner->setOptions(optionsFor(job.spec, workers));
+            runner->setRunCache(cache);
+            if (!first_start) first_start = Clock::now();
+            running.push_back({job.id, job.spec, runner, workers, Clock::now()});
+            cores_in_use += workers;
+            runner->startModelCheck(job.spec.spec_file, job.spec.config_file);
+        }
+    }
+
+    void record(JobResult result) {
+        switch (result.status) {
+        case TLCRunner::Status::Completed: ++completed; break;
+        case TLCRunner::Status::Cancelled: ++cancelled; break;
+        default: ++failed; break;
+        }
+        if (result.results) {
+            states_generated += static_cast<uint64_t>(std::max(0, result.results->states_generated));
+            distinct_states += static_cast<uint64_t>(std::max(0, result.results->distinct_states));
+        }
+        last_finish = Clock::now();
+        finished_index[result.id] = finished.size();
+        finished.push_back(std::move(result));
+        if (queue.empty() && running.empty()) {
+            idle.notify_all();
+        }
+    }
+
+    void onFinished(TLCRunner* runner, TLCRunner::Status status) {
+        JobResult result;
+        std::function<void(const JobResult&)> callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = std::find_if(running.begin(), running.end(),
+                                   [runner](const Running& job) { return job.runner == runner; });
+            if (it == running.end()) return;
+
+            result.id = it->id;
+            result.spec = it->spec;
+            result.status = status;
+            result.workers = it->workers;
+            result.wall_seconds = std::chrono::duration<double>(Clock::now() - it->start).count();
+            result.results = runner->getSnapshot();
+
+            cores_in_use -= it->workers;
+            running.erase(it);
+            // Free for the next job now: a runner may be restarted from
+            // its own final callback
+            idle_runners.push_back(runner);
+            record(result);
+            dispatch();
+            callback = finished_callback;
+        }
+        if (callback) callback(result);
+    }
+};
+
+TLCJobScheduler::TLCJobScheduler(int core_budget, int max_concurrent)
+    : pImpl(std::make_unique<Impl>(core_budget, max_concurrent)) {}
+
+TLCJobScheduler::~TLCJobScheduler() {
+    cancelAll();
+    waitForIdle();
+    pImpl->runners.clear();
+}
+
+int TLCJobScheduler::coreBudget() const {
+    return pImpl->core_budget;
+}
+
+TLCJobScheduler::JobId TLCJobScheduler::submit(const JobSpec& spec) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    const JobId id = pImpl->next_id++;
+    // After every job of the same or higher priority: FIFO within a priority
+    auto position = std::find_if(pImpl->queue.begin(), pImpl->queue.end(),
+                                 [&spec](const Impl::Queued& queued) {
+                                     return queued.spec.priority < spec.priority;
+                                 });
+    pImpl->queue.insert(position, {id, spec});
+    pImpl->dispatch();
+    return id;
+}
+
+bool TLCJobScheduler::cancel(JobId id) {
+    JobResult result;
+    std::function<void(const JobResult&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        for (const auto& job : pImpl->running) {
+            if (job.id == id) {
+                // Reported through onFinished() once TLC has stopped
+                job.runner->cancel();
+                return true;
+            }
+        }
+        auto it = std::find_if(pImpl->queue.begin(), pImpl->queue.end(),
+                               [id](const Impl::Queued& queued) { return queued.id == id; });
+        if (it == pImpl->queue.end()) return false;
+
+        result.id = id;
+        result.spec = std::move(it->spec);
+        result.status = TLCRunner::Status::Cancelled;
+        pImpl->queue.erase(it);
+        pImpl->record(result);
+        callback = pImpl->finished_callback;
+    }
+    if (callback) callback(result);
+    return true;
+}
+
+void TLCJobScheduler::cancelAll() {
+    std::vector<JobId> ids;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        // Queued jobs first, so none of them starts in a freed slot
+        for (const auto& job : pImpl->queue) ids.push_back(job.id);
+        for (const auto& job : pImpl->running) ids.push_back(job.id);
+    }
+    for (JobId id : ids) {
+        cancel(id);
+    }
+}
+
+void TLCJobScheduler::waitForIdle() {
+    std::unique_lock<std::mutex> lock(pImpl->mutex);
+    pImpl->idle.wait(lock, [this] { return pImpl->queue.empty() && pImpl->running.empty(); });
+}
+
+std::optional<TLCJobScheduler::JobResult> TLCJobScheduler::result(JobId id) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->finished_index.find(id);
+    if (it == pImpl->finished_index.end()) return std::nullopt;
+    return pImpl->finished[it->second];
+}
+
+std::vector<TLCJobScheduler::JobResult> TLCJobScheduler::results() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->finished;
+}
+
+TLCJobScheduler::Stats TLCJobScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    Stats stats;
+    stats.queued = pImpl->queue.size();
+    stats.running = pImpl->running.size();
+    stats.completed = pImpl->completed;
+    stats.failed = pImpl->failed;
+    stats.cancelled = pImpl->cancelled;
+    stats.cores_in_use = pImpl->cores_in_use;
+    stats.states_generated = pImpl->states_generated;
+    stats.distinct_states = pImpl->distinct_states;
+    if (pImpl->first_start) {
+        const auto end = pImpl->running.empty() ? pImpl->last_finish : Impl::Clock::now();
+        stats.elapsed_seconds = std::max(0.0, std::chrono::duration<double>(end - *pImpl->first_start).count());
+    }
+    if (stats.elapsed_seconds > 0) {
+        const double finished = static_cast<double>(stats.completed + stats.failed + stats.cancelled);
+        stats.states_per_second = static_cast<double>(stats.states_generated) / stats.elapsed_seconds;
+        stats.jobs_per_minute = finished * 60.0 / stats.elapsed_seconds;
+    }
+    return stats;
+}
+
+void TLCJobScheduler::setRunCache(std::shared_ptr<RunCache> cache) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->cache = std::move(cache);
+}
+
+void TLCJobScheduler::setJobFinishedCallback(std::function<void(const JobResult&)> callback) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->finished_callback = std::move(callback);
+}
+
+} // namespace tla_visualiser
@@ -0,0 +1,151 @@
+#include "tlc_options.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX   // keep std::min/std::max usable
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace tla_visualiser {
+
+namespace {
+
+// Smallest heap worth giving TLC, and the share of memory it gets when
+// sized automatically: the rest is left to the OS page cache, which TLC
+// leans on for its disk-backed state queue and fingerprint set
+constexpr int kMinHeapMb = 256;
+constexpr uint64_t kHeapDivisor = 2;
+
+std::string formatFraction(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return buffer;
+}
+
+} // namespace
+
+int TLCOptions::detectedCores() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+uint64_t TLCOptions::detectedMemoryBytes() {
+#if defined(_WIN32)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status)) {
+        return static_cast<uint64_t>(status.ullTotalPhys);
+    }
+    return 0;
+#elif defined(__APPLE__)
+    uint64_t memory = 0;
+    size_t length = sizeof(memory);
+    int mib[2] = {CTL_HW, HW_MEMSIZE};
+    if (sysctl(mib, 2, &memory, &length, nullptr, 0) == 0) {
+        return memory;
+    }
+    return 0;
+#else
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages <= 0 || page_size <= 0) return 0;
+    return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size);
+#endif
+}
+
+int TLCOptions::autoHeapMb(uint64_t memory_bytes, int jobs) {
+    if (memory_bytes == 0) memory_bytes = detectedMemoryBytes();
+    if (memory_bytes == 0) return 0;   // unknown: leave it to the JVM
+    const uint64_t share = memory_bytes / kHeapDivisor / static_cast<uint64_t>(std::max(1, jobs));
+    const uint64_t mb = share / (1024 * 1024);
+    return static_cast<int>(std::max<uint64_t>(kMinHeapMb, std::min<uint64_t>(mb, INT32_MAX)));
+}
+
+TLCOptions TLCOptions::autoSized(int cores, uint64_t memory_bytes) {
+    TLCOptions options;
+    options.workers = cores > 0 ? cores : detectedCores();
+    options.heap_mb = autoHeapMb(memory_bytes);
+    options.gc = GarbageCollector::Parallel;
+    return options;
+}
+
+std::vector<std::string> TLCOptions::jvmArguments() const {
+    std::vector<std::string> args;
+    if (heap_mb > 0) {
+        args.push_back("-Xmx" + std::to_string(heap_mb) + "m");
+    }
+    switch (gc) {
+    case GarbageCollector::Parallel: args.push_back("-XX:+UseParallelGC"); break;
+    case GarbageCollector::G1: args.push_back("-XX:+UseG1GC"); break;
+    case GarbageCollector::Default: break;
+    }
+    args.insert(args.end(), jvm_args.begin(), jvm_args.end());
+    return args;
+}
+
+std::vector<std::string> TLCOptions::tlcArguments(const std::string& spec_file,
+                                                  const std::string& config_file) const {
+    std::vector<std::string> args;
+    args.push_back("-tool");
+    if (workers > 0) {
+        args.push_back("-workers");
+        args.push_back(std::to_string(workers));
+    }
+    if (fpmem > 0.0 && fpmem <= 1.0) {
+        args.push_back("-fpmem");
+        args.push_back(formatFraction(fpmem));
+    }
+    if (fp_index >= 0) {
+        args.push_back("-fp");
+        args.push_back(std::to_string(fp_index));
+    }
+    if (checkpoint_minutes >= 0) {
+        args.push_back("-checkpoint");
+        args.push_back(std::to_string(checkpoint_minutes));
+    }
+    if (!recover.empty()) {
+        args.push_back("-recover");
+        args.push_back(recover);
+    }
+    if (!metadir.empty()) {
+        args.push_back("-metadir");
+        args.push_back(metadir);
+    }
+    args.insert(args.end(), tlc_args.begin(), tlc_args.end());
+
+    args.push_back(spec_file);
+    if (!config_file.empty()) {
+        args.push_back("-config");
+        args.push_back(config_file);
+    }
+    return args;
+}
+
+std::vector<std::string> TLCOptions::arguments(const std::string& spec_file,
+                                               const std::string& config_file) const {
+    std::vector<std::string> args = jvmArguments();
+    args.push_back("-jar");
+    args.push_back(tla2tools_jar);
+    const auto tlc = tlcArguments(spec_file, config_file);
+    args.insert(args.end(), tlc.begin(), tlc.end());
+    return args;
+}
+
+std::vector<std::string> TLCOptions::hostArguments() const {
+    // Single-file source launch (Java 11+): no build step for the host
+    std::vector<std::string> args = jvmArguments();
+    args.push_back("-cp");
+    args.push_back(tla2tools_jar);
+    args.push_back(host_source);
+    return args;
+}
+
+} // namespace tla_visualiser
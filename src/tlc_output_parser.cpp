@@ -0,0 +1,499 @@
+#include "tlc_output_parser.h"
+#include "text_scan.h"
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace tla_visualiser {
+
+using namespace text_scan;
+
+namespace {
+
+constexpr std::string_view kStartMsg = "@!@!@STARTMSG ";
+constexpr std::string_view kEndMsg = "@!@!@ENDMSG ";
+
+// TLC message classes (tlc2.output.MP)
+constexpr int kErrorClass = 1;
+constexpr int kStateClass = 4;
+
+// TLC message codes (tlc2.output.EC)
+constexpr int kInvariantViolatedInitial = 2107;
+constexpr int kInvariantViolatedBehavior = 2110;
+constexpr int kBehaviorUpToThisPoint = 2121;
+constexpr int kBackToState = 2122;
+constexpr int kTlcStats = 2199;
+constexpr int kTlcProgressStats = 2200;
+constexpr int kStatePrint1 = 2216;
+constexpr int kStatePrint2 = 2217;
+constexpr int kStatePrint3 = 2218;
+
+// Action name from a state header such as
+// "<Next line 12, col 5 to line 14, col 20 of module SimpleCounter>"
+// or "<Initial predicate>".
+std::string_view actionName(std::string_view header) {
+    header = trim(header);
+    if (!header.empty() && header.front() == '<') header.remove_prefix(1);
+    if (!header.empty() && header.back() == '>') header.remove_suffix(1);
+    std::size_t location = header.find(" line ");
+    if (location != std::string_view::npos) header = header.substr(0, location);
+    return trim(header);
+}
+
+struct StringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view text) const {
+        return std::hash<std::string_view>{}(text);
+    }
+};
+
+uint64_t mix64(uint64_t x) {
+    // splitmix64 finaliser
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Open-addressing hash table from 64-bit fingerprints to indices.
+ *
+ * Two flat arrays and linear probing: no per-entry allocation and one
+ * cache miss per lookup, which keeps deduplication from dominating the
+ * decode time when traces contain millions of states.
+ */
+class FingerprintTable {
+public:
+    FingerprintTable() : keys(1024, 0), values(1024, -1) {}
+
+    // Returns the value of the first entry with this fingerprint for which
+    // `matches(value)` holds, or -1.
+    template <typename Matches>
+    int find(uint64_t fingerprint, Matches matches) const {
+        fingerprint = fingerprint ? fingerprint : 1;
+        std::size_t mask = keys.size() - 1;
+        for (std::size_t slot = mix64(fingerprint) & mask; keys[slot] != 0; slot = (slot + 1) & mask) {
+            if (keys[slot] == fingerprint && matches(values[slot])) {
+                return values[slot];
+            }
+        }
+        return -1;
+    }
+
+    void insert(uint64_t fingerprint, int value) {
+        if ((count + 1) * 4 > keys.size() * 3) {
+            grow();
+        }
+        place(fingerprint ? fingerprint : 1, value);
+        ++count;
+    }
+
+private:
+    std::vector<uint64_t> keys;  // 0 marks an empty slot
+    std::vector<int> values;
+    std::size_t count = 0;
+
+    void place(uint64_t fingerprint, int value) {
+        std::size_t mask = keys.size() - 1;
+        std::size_t slot = mix64(fingerprint) & mask;
+        while (keys[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        keys[slot] = fingerprint;
+        values[slot] = value;
+    }
+
+    void grow() {
+        std::vector<uint64_t> old_keys(keys.size() * 2, 0);
+        std::vector<int> old_values(values.size() * 2, -1);
+        old_keys.swap(keys);
+        old_values.swap(values);
+        for (std::size_t i = 0; i < old_keys.size(); ++i) {
+            if (old_keys[i] != 0) {
+                place(old_keys[i], old_values[i]);
+            }
+        }
+    }
+};
+
+int clampToInt(long long value) {
+    return value > INT_MAX ? INT_MAX : static_cast<int>(value);
+}
+
+} // namespace
+
+class TLCOutputParser::Impl {
+public:
+    TLCRunner::RunResults& results;
+    std::function<void(int, const std::string&)> progress_callback;
+
+    // Framing state
+    std::string pending_line;
+    bool in_message = false;
+    int message_code = 0;
+    int message_class = 0;
+    std::string message_body;
+
+    // Error-trace decoding state
+    bool trace_open = false;
+    TLCRunner::CounterExample current_trace;
+    std::vector<int> trace_step_states;  // trace step number (1-based) -> state id
+    std::string pending_description;
+    std::vector<std::size_t> pending_invariants;
+
+    // Deduplication of states and transitions. States are identified by a
+    // 64-bit fingerprint of their variable block, as TLC itself does.
+    FingerprintTable state_ids;
+    FingerprintTable transition_ids;
+    std::unordered_map<std::string, int, StringHash, std::equal_to<>> action_ids;
+    std::vector<std::string_view> action_names;
+    std::vector<int> transition_actions;  // action id per entry of results.transitions
+    std::vector<std::pair<std::string_view, std::string_view>> scratch_variables;
+
+    explicit Impl(TLCRunner::RunResults& r) : results(r) {}
+
+    void handleLine(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        if (startsWith(line, kStartMsg)) {
+            // "@!@!@STARTMSG 2200:0 @!@!@"
+            std::string_view header = line.substr(kStartMsg.size());
+            std::size_t pos = 0;
+            message_code = clampToInt(std::max(0LL, parseNumber(header, pos)));
+            message_class = 0;
+            if (pos < header.size() && header[pos] == ':') {
+                ++pos;
+                message_class = clampToInt(std::max(0LL, parseNumber(header, pos)));
+            }
+            in_message = true;
+            message_body.clear();
+            return;
+        }
+
+        if (in_message) {
+            if (startsWith(line, kEndMsg)) {
+                in_message = false;
+                handleMessage(message_code, message_class, message_body);
+                // Keep the capacity for the next message but drop oversized buffers
+                if (message_body.capacity() > (1u << 20)) {
+                    std::string().swap(message_body);
+                } else {
+                    message_body.clear();
+                }
+            } else {
+                message_body.append(line.data(), line.size());
+                message_body.push_back('\n');
+            }
+            return;
+        }
+
+        // Unframed output (plain mode, JVM errors): treat each line as a message
+        handleMessage(0, 0, line);
+    }
+
+    void handleMessage(int code, int msg_class, std::string_view body) {
+        if (msg_class == kStateClass ||
+            code == kStatePrint1 || code == kStatePrint2 || code == kStatePrint3 ||
+            code == kBackToState) {
+            handleStateMessage(code, body);
+            return;
+        }
+
+        if (msg_class == kErrorClass) {
+            results.error_message.append(body.data(), body.size());
+            if (!body.empty() && body.back() != '\n') {
+                results.error_message.push_back('\n');
+            }
+
+            // "The behavior up to this point is:" introduces the trace of
+            // the error just reported rather than a new error
+            if (code != kBehaviorUpToThisPoint) {
+                closeTrace();
+                pending_description = std::string(trim(firstLine(body)));
+                if (code == kInvariantViolatedInitial || code == kInvariantViolatedBehavior) {
+                    recordInvariantViolation(body);
+                }
+            }
+        } else if (code != 0) {
+            // Any other framed message ends the trace being received
+            closeTrace();
+        }
+
+        bool counters_updated = false;
+        LineReader lines(body);
+        std::string_view line;
+        while (lines.next(line)) {
+            counters_updated |= scanCounters(line);
+
+            if (msg_class != kErrorClass && line.find("Error:") != std::string_view::npos) {
+                results.error_message.append(line.data(), line.size());
+                results.error_message.push_back('\n');
+            }
+        }
+
+        if (counters_updated && progress_callback &&
+            (code == kTlcProgressStats || code == kTlcStats || code == 0)) {
+            progress_callback(results.distinct_states, std::string(body));
+        }
+    }
+
+    bool scanCounters(std::string_view line) {
+        // Cheap pre-filter: statistics lines always mention "states"
+        if (line.find("states") == std::string_view::npos) {
+            return false;
+        }
+
+        bool updated = false;
+        long long generated = countBefore(line, "states generated");
+        if (generated >= 0) {
+            results.states_generated = clampToInt(generated);
+            updated = true;
+        }
+        long long distinct = countBefore(line, "distinct states");
+        if (distinct >= 0) {
+            results.distinct_states = clampToInt(distinct);
+            updated = true;
+        }
+        return updated;
+    }
+
+    void recordInvariantViolation(std::string_view body) {
+        // "Invariant TypeOK is violated." / "... is violated by the initial state:"
+        std::string_view line = firstLine(body);
+        constexpr std::string_view prefix = "Invariant ";
+        std::size_t start = line.find(prefix);
+        std::size_t end = line.find(" is violated");
+        if (start == std::string_view::npos || end == std::string_view::npos || end <= start) {
+            return;
+        }
+
+        TLCRunner::Invariant invariant;
+        invariant.name = std::string(line.substr(start + prefix.size(), end - start - prefix.size()));
+        invariant.passed = false;
+        invariant.error_message = std::string(trim(line));
+        invariant.error_state_id = -1;
+        pending_invariants.push_back(results.invariants.size());
+        results.invariants.push_back(std::move(invariant));
+    }
+
+    void handleStateMessage(int code, std::string_view body) {
+        // Header line: "<step>: <action header>" followed by the variables
+        std::string_view header = firstLine(body);
+        std::size_t pos = 0;
+        long long step = parseNumber(header, pos);
+        if (pos < header.size() && header[pos] == ':') ++pos;
+        std::string_view label = trim(header.substr(pos));
+
+        constexpr std::string_view back_to_state = "Back to state";
+        if (code == kBackToState || startsWith(label, back_to_state)) {
+            // Lasso-shaped liveness trace: "<step>: Back to state: <action>"
+            // loops back to an earlier step of the same trace
+            std::string_view action = label.substr(std::min(label.size(), back_to_state.size()));
+            if (!action.empty() && action.front() == ':') action.remove_prefix(1);
+            if (step >= 1 && static_cast<std::size_t>(step) <= trace_step_states.size()) {
+                appendTraceState(trace_step_states[step - 1], actionName(action), false);
+            }
+            return;
+        }
+
+        if (code == kStatePrint3 || startsWith(label, "Stuttering")) {
+            if (!current_trace.state_sequence.empty()) {
+                appendTraceState(current_trace.state_sequence.back(), "Stuttering", true);
+            }
+            return;
+        }
+
+        if (trace_open && step == 1 && !current_trace.state_sequence.empty()) {
+            // A new trace starts (e.g. when running with -continue)
+            closeTrace();
+        }
+
+        std::string_view variables =
+            header.size() < body.size() ? body.substr(header.size() + 1) : std::string_view();
+        std::string_view action = actionName(label);
+        int state_id = internState(variables, action);
+        appendTraceState(state_id, action, true);
+    }
+
+    int internState(std::string_view variables, std::string_view description) {
+        uint64_t fingerprint = std::hash<std::string_view>{}(variables);
+        decodeVariables(variables, scratch_variables);
+        // A fingerprint match is only a candidate: distinct states can collide
+        int existing = state_ids.find(fingerprint, [this](int id) { return sameVariables(id); });
+        if (existing >= 0) {
+            return existing;
+        }
+
+        int id = static_cast<int>(results.states.size());
+        results.states.add(id, description, scratch_variables);
+        state_ids.insert(fingerprint, id);
+        return id;
+    }
+
+    // Whether state `id` holds exactly the variables in scratch_variables
+    bool sameVariables(int id) const {
+        const StateStore& states = results.states;
+        const auto index = static_cast<std::size_t>(id);
+        std::size_t defined = 0;
+        for (const auto& [name, value] : scratch_variables) {
+            const int column = states.findVariable(name);
+            if ((column >= 0 ? states.value(index, static_cast<std::size_t>(column)) : std::string_view()) != value) {
+                return false;
+            }
+            if (!value.empty()) ++defined;
+        }
+        std::size_t stored = 0;
+        states.forEachVariable(index, [&stored](std::string_view, std::string_view) { ++stored; });
+        return stored == defined;
+    }
+
+    static void decodeVariables(std::string_view text,
+                                std::vector<std::pair<std::string_view, std::string_view>>& out) {
+        // Conjunction list "/\ x = 1\n/\ y = <<1, 2>>", or a single "x = 1"
+        // for one-variable specs. Pretty-printed values continue on
+        // indented lines; since lines are contiguous in `text`, a value
+        // is always a single span of it.
+        out.clear();
+        LineReader lines(text);
+        std::string_view line;
+        while (lines.next(line)) {
+            if (trim(line).empty()) continue;
+
+            bool conjunct = startsWith(line, "/\\ ");
+            if (conjunct || out.empty()) {
+                if (conjunct) line.remove_prefix(3);
+                std::size_t eq = line.find(" = ");
+                if (eq != std::string_view::npos) {
+                    out.emplace_back(trim(line.substr(0, eq)), line.substr(eq + 3));
+                } else {
+                    out.emplace_back(trim(line), std::string_view());
+                }
+                continue;
+            }
+
+            // Continuation of the previous value
+            std::string_view& value = out.back().second;
+            const char* begin = value.empty() ? line.data() : value.data();
+            value = std::string_view(begin, static_cast<std::size_t>(line.data() + line.size() - begin));
+        }
+    }
+
+    void appendTraceState(int state_id, std::string_view action, bool new_step) {
+        if (!trace_open) {
+            trace_open = true;
+            current_trace = TLCRunner::CounterExample{};
+            current_trace.description =
+                pending_description.empty() ? std::string("Error trace") : pending_description;
+            trace_step_states.clear();
+        }
+
+        if (!current_trace.state_sequence.empty()) {
+            addTransition(current_trace.state_sequence.back(), state_id, action);
+        }
+        current_trace.state_sequence.push_back(state_id);
+        if (new_step) {
+            trace_step_states.push_back(state_id);
+        }
+    }
+
+    void addTransition(int from, int to, std::string_view action) {
+        auto it = action_ids.find(action);
+        int action_id;
+        if (it == action_ids.end()) {
+            action_id = static_cast<int>(action_ids.size());
+            auto inserted = action_ids.emplace(std::string(action), action_id).first;
+            action_names.push_back(inserted->first);
+        } else {
+            action_id = it->second;
+        }
+
+        uint64_t key = mix64((static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) |
+                             static_cast<uint32_t>(to)) ^ static_cast<uint64_t>(action_id);
+        auto same = [&](int index) {
+            const auto& t = results.transitions[index];
+            return t.from_state == from && t.to_state == to && transition_actions[index] == action_id;
+        };
+        if (transition_ids.find(key, same) >= 0) {
+            return;
+        }
+
+        transition_ids.insert(key, static_cast<int>(results.transitions.size()));
+        transition_actions.push_back(action_id);
+        results.transitions.push_back(
+            TLCRunner::Transition{from, to, std::string(action_names[action_id])});
+    }
+
+    void closeTrace() {
+        if (!trace_open) return;
+        trace_open = false;
+
+        if (!current_trace.state_sequence.empty()) {
+            int last_state = current_trace.state_sequence.back();
+            for (std::size_t index : pending_invariants) {
+                results.invariants[index].error_state_id = last_state;
+            }
+            results.counterexamples.push_back(std::move(current_trace));
+        }
+        current_trace = TLCRunner::CounterExample{};
+        trace_step_states.clear();
+        pending_invariants.clear();
+        pending_description.clear();
+    }
+};
+
+TLCOutputParser::TLCOutputParser(TLCRunner::RunResults& results)
+    : pImpl(std::make_unique<Impl>(results)) {}
+
+TLCOutputParser::~TLCOutputParser() = default;
+
+void TLCOutputParser::feed(const char* data, std::size_t size) {
+    const char* end = data + size;
+    while (data < end) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        if (!newline) {
+            pImpl->pending_line.append(data, end - data);
+            return;
+        }
+
+        if (pImpl->pending_line.empty()) {
+            // Fast path: the whole line is inside this chunk, no copy needed
+            pImpl->handleLine(std::string_view(data, newline - data));
+        } else {
+            pImpl->pending_line.append(data, newline - data);
+            pImpl->handleLine(pImpl->pending_line);
+            pImpl->pending_line.clear();
+        }
+        data = newline + 1;
+    }
+}
+
+void TLCOutputParser::finish() {
+    if (!pImpl->pending_line.empty()) {
+        pImpl->handleLine(pImpl->pending_line);
+        pImpl->pending_line.clear();
+    }
+    if (pImpl->in_message) {
+        // Truncated output (process killed mid-message): use what we have
+        pImpl->in_message = false;
+        pImpl->handleMessage(pImpl->message_code, pImpl->message_class, pImpl->message_body);
+        pImpl->message_body.clear();
+    }
+    pImpl->closeTrace();
+}
+
+void TLCOutputParser::setProgressCallback(std::function<void(int, const std::string&)> callback) {
+    pImpl->progress_callback = callback;
+}
+
+std::size_t TLCOutputParser::bufferedBytes() const {
+    return pImpl->pending_line.size() + pImpl->message_body.size();
+}
+
+} // namespace tla_visualiser
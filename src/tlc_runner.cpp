@@ -1,162 +1,588 @@
 #include "tlc_runner.h"
+#include "callback_context.h"
+#include "tlc_output_parser.h"
+#include "state_index.h"
+#include "results_file.h"
+#include "run_cache.h"
+#include "seqlock.h"
+#include "text_scan.h"
+#include <QFile>
 #include <QProcess>
+#include <QScopeGuard>
 #include <QFileInfo>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <thread>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <fstream>
-#include <sstream>
 #include <iostream>
-#include <regex>
+#include <string_view>
+
+#ifndef Q_OS_WIN
+#include <csignal>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
 
 namespace tla_visualiser {
 
+namespace {
+
+// How often the runner thread checks for cancellation while TLC is quiet
+constexpr int kPollMs = 50;
+// Time TLC gets to exit after SIGTERM before its process tree is killed
+constexpr int kTerminateGraceMs = 2000;
+constexpr int kKillWaitMs = 1000;
+// Starting the warm host compiles TLCHost.java and loads TLC
+constexpr int kHostStartMs = 30000;
+// Runs in a row the host may die in before runs stop trying it
+constexpr int kMaxHostLosses = 2;
+
+// Lines the warm host (tools/TLCHost.java) frames runs with
+constexpr std::string_view kHostReady = "@!@!@TLCHOST-READY";
+constexpr std::string_view kHostEnd = "@!@!@TLCHOST-END ";
+
+// Parse a whole saved field as a number; false on anything else
+template <typename T>
+bool parseField(std::string_view text, T& value) {
+    text = text_scan::trim(text);
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc() && ptr == end && !text.empty();
+}
+
+void signalProcessTree(QProcess& process, qint64 pid, bool force) {
+#ifdef Q_OS_WIN
+    Q_UNUSED(pid);
+    // No process groups; TerminateProcess on the JVM itself
+    if (force) process.kill();
+#else
+    Q_UNUSED(process);
+    // TLC runs in its own process group (see executeCommand), so this
+    // reaches the JVM and anything it started
+    if (pid > 0) ::kill(-static_cast<pid_t>(pid), force ? SIGKILL : SIGTERM);
+#endif
+}
+
+// Terminate, then kill; returns within about kTerminateGraceMs + kKillWaitMs
+void stopProcessTree(QProcess& process, qint64 pid) {
+    signalProcessTree(process, pid, false);
+    process.waitForFinished(kTerminateGraceMs);
+    // Also sweeps up children left behind by a JVM that did exit
+    signalProcessTree(process, pid, true);
+    if (process.state() != QProcess::NotRunning) {
+        process.waitForFinished(kKillWaitMs);
+    }
+}
+
+} // namespace
+
 class TLCRunner::Impl {
 public:
-    Status status;
-    RunResults results;
-    std::function<void(Status)> status_callback;
-    std::function<void(int, const std::string&)> progress_callback;
+    // What a run calls back. Copied when the run starts, so the setters
+    // never race with the runner thread.
+    struct Callbacks {
+        std::function<void(Status)> status;
+        std::function<void(int, const std::string&)> progress;
+        CallbackContext context;
+
+        // Progress for `context`, set up per run (see forRun)
+        struct ProgressUpdate {
+            int distinct_states = 0;
+            std::string message;
+        };
+        CoalescedDelivery<ProgressUpdate> pending;
+
+        Callbacks forRun() const {
+            Callbacks run = *this;
+            if (context && progress) {
+                run.pending = CoalescedDelivery<ProgressUpdate>(context, [callback = progress](ProgressUpdate update) {
+                    callback(update.distinct_states, update.message);
+                });
+            }
+            return run;
+        }
+    };
+
+    std::atomic<Status> status;
+    RunResults results;   // written by the run in progress, then published
+    mutable std::mutex snapshot_mutex;
+    std::shared_ptr<const RunResults> snapshot;   // last published results
+    SeqLock<Progress> progress;                   // written by one thread at a time
+    uint64_t progress_updates = 0;
+    Callbacks callbacks;
+    std::atomic<bool> should_cancel;
+
+    struct Job {
+        std::string spec_file;
+        std::string config_file;
+        TLCOptions options;
+        std::shared_ptr<RunCache> cache;
+        Callbacks callbacks;
+    };
+    TLCOptions options;
+    std::shared_ptr<RunCache> cache;
+
+    // One runner thread, started with the first run and reused afterwards
     std::thread runner_thread;
-    bool should_cancel;
+    std::mutex job_mutex;
+    std::condition_variable job_ready;
+    std::optional<Job> job;   // handed to the runner thread
+    bool busy = false;        // a run is queued or in progress
+    bool stopping = false;
+
+    // Warm TLC host, used by the runner thread only
+    enum class HostRun { Done, Unavailable, Lost };
+    std::unique_ptr<QProcess> host;
+    qint64 host_pid = 0;
+    std::vector<std::string> host_command;   // what `host` runs, java first
+    bool host_failed = false;                // host_command does not work
+    int host_losses = 0;                     // runs in a row the host died in
 
     Impl() : status(Status::NotStarted), should_cancel(false) {
-        results.status = Status::NotStarted;
+        resetResults(Status::NotStarted);
+        publish(RunResults(results));
+    }
+
+    void resetResults(Status initial) {
+        results = RunResults{};
+        results.status = initial;
         results.states_generated = 0;
         results.distinct_states = 0;
         results.execution_time_seconds = 0.0;
     }
 
+    // Readers holding the previous snapshot keep it alive
+    void publish(RunResults&& next) {
+        auto shared = std::make_shared<const RunResults>(std::move(next));
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        snapshot = std::move(shared);
+    }
+
+    std::shared_ptr<const RunResults> currentSnapshot() const {
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        return snapshot;
+    }
+
+    void updateProgress(const RunResults& from, Status run_status, double elapsed_seconds) {
+        Progress next;
+        next.status = run_status;
+        next.states_generated = from.states_generated;
+        next.distinct_states = from.distinct_states;
+        next.elapsed_seconds = elapsed_seconds;
+        next.updates = ++progress_updates;
+        progress.store(next);
+    }
+
+    static void notifyStatus(const Callbacks& callbacks, Status run_status) {
+        if (!callbacks.status) return;
+        // Direct when already on the context's thread, queued otherwise
+        callbacks.context.post([callback = callbacks.status, run_status] { callback(run_status); },
+                               Qt::AutoConnection);
+    }
+
+    static void notifyProgress(const Callbacks& callbacks, int distinct_states,
+                               const std::string& message) {
+        if (!callbacks.progress) return;
+        if (!callbacks.pending) {
+            callbacks.progress(distinct_states, message);
+            return;
+        }
+        callbacks.pending.update([&](Callbacks::ProgressUpdate& update) {
+            update.distinct_states = distinct_states;
+            update.message = message;
+        });
+    }
+
     ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            stopping = true;
+        }
         should_cancel = true;
+        job_ready.notify_all();
         if (runner_thread.joinable()) {
             runner_thread.join();
         }
     }
 
-    std::string executeCommand(const std::string& program, const QStringList& arguments) {
-        QProcess process;
+    // Parse a results file into `loaded` without touching the runner's state
+    static bool readResults(const std::string& filename, RunResults& loaded);
+    static bool readTextResults(const std::string& filename, RunResults& loaded);
+
+    void runnerLoop() {
+        for (;;) {
+            Job next;
+            {
+                std::unique_lock<std::mutex> lock(job_mutex);
+                job_ready.wait(lock, [this] { return stopping || job.has_value(); });
+                if (stopping) break;
+                next = std::move(*job);
+                job.reset();
+            }
+            run(next);
+        }
+        stopHost(true);
+    }
+
+    void run(const Job& job);
+
+    static void startInProcessGroup(QProcess& process, const std::string& program,
+                                    const QStringList& arguments) {
+        process.setProcessChannelMode(QProcess::MergedChannels);
+#ifndef Q_OS_WIN
+        // Own process group, so cancelling can signal the whole tree
+        process.setChildProcessModifier([] { ::setpgid(0, 0); });
+#endif
         process.start(QString::fromStdString(program), arguments);
-        
+    }
+
+    void stopHost(bool graceful) {
+        if (!host) return;
+        if (graceful) {
+            // End of input: the host returns from main()
+            host->closeWriteChannel();
+            host->waitForFinished(kTerminateGraceMs);
+        }
+        if (host->state() != QProcess::NotRunning) {
+            stopProcessTree(*host, host_pid);
+        }
+        host.reset();
+        host_pid = 0;
+    }
+
+    // Starts the host for these options unless it is already running
+    bool ensureHost(const TLCOptions& options) {
+        std::vector<std::string> command = options.hostArguments();
+        command.insert(command.begin(), options.java);
+        if (host && host->state() == QProcess::Running && command == host_command) {
+            return true;
+        }
+        stopHost(true);
+        if (command != host_command) {
+            host_command = command;
+            host_failed = false;
+            host_losses = 0;
+        }
+        if (host_failed) return false;
+
+        QStringList arguments;
+        for (std::size_t i = 1; i < command.size(); ++i) {
+            arguments << QString::fromStdString(command[i]);
+        }
+        host = std::make_unique<QProcess>();
+        startInProcessGroup(*host, options.java, arguments);
+        if (!host->waitForStarted()) {
+            host.reset();
+            host_failed = true;
+            return false;
+        }
+        host_pid = host->processId();
+
+        std::string greeting;
+        char buffer[256];
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kHostStartMs);
+        while (greeting.find('\n') == std::string::npos) {
+            if (should_cancel) {
+                stopHost(false);
+                return false;
+            }
+            if (std::chrono::steady_clock::now() > deadline || host->state() == QProcess::NotRunning) {
+                stopHost(false);
+                host_failed = true;
+                return false;
+            }
+            if (host->bytesAvailable() > 0 || host->waitForReadyRead(kPollMs)) {
+                const qint64 n = host->read(buffer, sizeof(buffer));
+                if (n > 0) greeting.append(buffer, static_cast<std::size_t>(n));
+            }
+        }
+        if (greeting.compare(0, kHostReady.size(), kHostReady) != 0) {
+            stopHost(false);
+            host_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    // Runs TLC in the warm host. Lost means the host died part way through:
+    // the parser has seen some of the output, but not all.
+    HostRun runOnHost(const TLCOptions& options, const std::vector<std::string>& tlc_args,
+                      TLCOutputParser& parser) {
+        std::string request = "RUN";
+        for (const auto& arg : tlc_args) {
+            // One line per request, tab-separated
+            if (arg.find_first_of("\t\n") != std::string::npos) return HostRun::Unavailable;
+            request += '\t';
+            request += arg;
+        }
+        request += '\n';
+        if (!ensureHost(options)) return HostRun::Unavailable;
+
+        host->write(request.data(), static_cast<qint64>(request.size()));
+        host->waitForBytesWritten(kPollMs);
+
+        // The end marker is a line of its own. Only whole lines go to the
+        // parser until it is clear the current line is not the marker.
+        std::string pending;
+        bool at_line_start = true;
+        char buffer[64 * 1024];
+        while (true) {
+            if (should_cancel) {
+                stopHost(false);
+                return HostRun::Done;
+            }
+            if (host->bytesAvailable() == 0 && !host->waitForReadyRead(kPollMs)) {
+                if (host->state() == QProcess::NotRunning) {
+                    stopHost(false);
+                    host_failed = ++host_losses >= kMaxHostLosses;
+                    return HostRun::Lost;
+                }
+                continue;
+            }
+            const qint64 n = host->read(buffer, sizeof(buffer));
+            if (n <= 0) continue;
+            pending.append(buffer, static_cast<std::size_t>(n));
+
+            std::size_t end = std::string::npos;
+            if (at_line_start && pending.compare(0, kHostEnd.size(), kHostEnd) == 0) {
+                end = 0;
+            } else if (std::size_t found = pending.find("\n" + std::string(kHostEnd));
+                       found != std::string::npos) {
+                end = found + 1;
+            }
+            if (end != std::string::npos && pending.find('\n', end) != std::string::npos) {
+                parser.feed(pending.data(), end);
+                parser.finish();
+                host_losses = 0;
+                return HostRun::Done;
+            }
+            if (end != std::string::npos) continue;   // rest of the marker line to come
+
+            std::size_t keep = pending.rfind('\n');
+            keep = keep == std::string::npos ? 0 : keep + 1;
+            const std::string_view tail(pending.data() + keep, pending.size() - keep);
+            if ((keep > 0 || at_line_start) && tail.size() < kHostEnd.size()
+                && kHostEnd.substr(0, tail.size()) == tail) {
+                // Could still become the marker
+                parser.feed(pending.data(), keep);
+                pending.erase(0, keep);
+                at_line_start = true;
+            } else {
+                parser.feed(pending.data(), pending.size());
+                at_line_start = pending.back() == '\n';
+                pending.clear();
+            }
+        }
+    }
+
+    bool executeCommand(const std::string& program, const QStringList& arguments,
+                        TLCOutputParser& parser) {
+        QProcess process;
+        startInProcessGroup(process, program, arguments);
+
         if (!process.waitForStarted()) {
-            return "";
-        }
-        
-        if (!process.waitForFinished(-1)) {  // Wait indefinitely
-            return "";
-        }
-        
-        QByteArray output = process.readAllStandardOutput();
-        QByteArray errorOutput = process.readAllStandardError();
-        
-        return output.toStdString() + errorOutput.toStdString();
-    }
-
-    void parseResults(const std::string& output) {
-        // Parse TLC output with more robust regex matching
-        std::istringstream stream(output);
-        std::string line;
-        
-        // Regex patterns for extracting counts
-        std::regex states_pattern(R"((\d+)\s+states\s+generated)");
-        std::regex distinct_pattern(R"((\d+)\s+distinct\s+states)");
-        std::smatch match;
-        
-        while (std::getline(stream, line)) {
-            // Look for state count with proper regex
-            if (std::regex_search(line, match, states_pattern)) {
-                results.states_generated = std::stoi(match[1]);
+            return false;
+        }
+        const qint64 pid = process.processId();   // 0 once the process is gone
+
+        // Stream output into the parser as it arrives instead of buffering
+        // the whole run. The runner thread has no event loop, so block on
+        // waitForReadyRead() rather than connecting to readyRead, briefly,
+        // so that a cancel is noticed within kPollMs.
+        char buffer[64 * 1024];
+        while (true) {
+            if (should_cancel) {
+                stopProcessTree(process, pid);
+                break;
             }
-            
-            // Look for distinct states
-            if (std::regex_search(line, match, distinct_pattern)) {
-                results.distinct_states = std::stoi(match[1]);
+            if (process.bytesAvailable() == 0 && !process.waitForReadyRead(kPollMs)) {
+                if (process.state() == QProcess::NotRunning) {
+                    break;
+                }
+                continue;
             }
-            
-            // Look for errors
-            if (line.find("Error:") != std::string::npos) {
-                results.error_message += line + "\n";
+            qint64 n = process.read(buffer, sizeof(buffer));
+            if (n > 0) {
+                parser.feed(buffer, static_cast<std::size_t>(n));
             }
         }
+
+        // Drain anything left after the process exited
+        qint64 n;
+        while ((n = process.read(buffer, sizeof(buffer))) > 0) {
+            parser.feed(buffer, static_cast<std::size_t>(n));
+        }
+        parser.finish();
+
+        return !should_cancel && process.exitStatus() == QProcess::NormalExit;
     }
 };
 
-TLCRunner::TLCRunner() : pImpl(std::make_unique<Impl>()) {}
+void TLCRunner::Impl::run(const Job& job) {
+    auto start_time = std::chrono::steady_clock::now();
+    auto elapsed = [start_time] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    };
+    // Results are published before the status changes, so whoever sees
+    // the new status also finds the final results. The runner is free for
+    // the next run before the final callback, which may start one.
+    auto finish = [this, &job, &elapsed](Status final_status) {
+        results.status = final_status;
+        updateProgress(results, final_status, elapsed());
+        publish(std::move(results));
+        status = final_status;
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            busy = false;
+        }
+        notifyStatus(job.callbacks, final_status);
+    };
 
-TLCRunner::~TLCRunner() = default;
+    if (should_cancel) {
+        finish(Status::Cancelled);
+        return;
+    }
 
-bool TLCRunner::startModelCheck(const std::string& spec_file, const std::string& config_file) {
-    if (pImpl->status == Status::Running) {
-        return false;
+    // Sanitize spec_file path
+    QFileInfo specInfo(QString::fromStdString(job.spec_file));
+    if (!specInfo.exists()) {
+        results.error_message = "Spec file does not exist: " + job.spec_file;
+        finish(Status::Failed);
+        return;
+    }
+    std::string config_path;
+    if (!job.config_file.empty()) {
+        QFileInfo configInfo(QString::fromStdString(job.config_file));
+        if (configInfo.exists()) {
+            config_path = configInfo.absoluteFilePath().toStdString();
+        }
     }
 
-    pImpl->status = Status::Running;
-    pImpl->results = RunResults{};
-    pImpl->results.status = Status::Running;
-    pImpl->should_cancel = false;
+    const std::string spec_path = specInfo.absoluteFilePath().toStdString();
 
-    if (pImpl->status_callback) {
-        pImpl->status_callback(Status::Running);
+    std::string cache_key;
+    if (job.cache) {
+        cache_key = job.cache->key(spec_path, config_path, job.options);
+        if (auto cached = cache_key.empty() ? nullptr : job.cache->lookup(cache_key)) {
+            results = *cached;   // shares the mapped states
+            finish(Status::Completed);
+            return;
+        }
     }
 
-    // Start TLC in a separate thread
-    pImpl->runner_thread = std::thread([this, spec_file, config_file]() {
-        auto start_time = std::chrono::steady_clock::now();
+    // Parse output as it streams in
+    auto track = [this, &job, &elapsed](TLCOutputParser& parser) {
+        parser.setProgressCallback([this, &job, &elapsed](int distinct, const std::string& message) {
+            updateProgress(results, Status::Running, elapsed());
+            notifyProgress(job.callbacks, distinct, message);
+        });
+    };
+
+    bool ran = false;
+    bool ok = false;
+    if (job.options.warm_host) {
+        TLCOutputParser parser(results);
+        track(parser);
+        switch (runOnHost(job.options, job.options.tlcArguments(spec_path, config_path), parser)) {
+        case HostRun::Done:
+            ran = ok = true;
+            break;
+        case HostRun::Lost:
+            // Start over in a JVM of its own; the partial output is dropped
+            resetResults(Status::Running);
+            break;
+        case HostRun::Unavailable:
+            break;
+        }
+    }
 
+    if (!ran && !should_cancel) {
         // Build TLC arguments safely (no shell injection)
         QStringList args;
-        args << "-jar" << "tla2tools.jar" << "-tool";
-        
-        // Sanitize spec_file path
-        QFileInfo specInfo(QString::fromStdString(spec_file));
-        if (!specInfo.exists()) {
-            pImpl->results.error_message = "Spec file does not exist: " + spec_file;
-            pImpl->status = Status::Failed;
-            pImpl->results.status = Status::Failed;
-            if (pImpl->status_callback) {
-                pImpl->status_callback(pImpl->status);
-            }
-            return;
+        for (const auto& arg : job.options.arguments(spec_path, config_path)) {
+            args << QString::fromStdString(arg);
         }
-        args << specInfo.absoluteFilePath();
-        
-        if (!config_file.empty()) {
-            QFileInfo configInfo(QString::fromStdString(config_file));
-            if (configInfo.exists()) {
-                args << "-config" << configInfo.absoluteFilePath();
-            }
+        TLCOutputParser parser(results);
+        track(parser);
+        ok = executeCommand(job.options.java, args, parser);
+    }
+    if (!ok && !should_cancel && results.error_message.empty()) {
+        results.error_message = "Failed to run TLC";
+    }
+    
+    results.execution_time_seconds = elapsed();
+    results.index = std::make_shared<const StateIndex>(results.states, results.transitions);
+
+    if (should_cancel) {
+        finish(Status::Cancelled);
+    } else if (!results.error_message.empty()) {
+        finish(Status::Failed);
+    } else {
+        if (!cache_key.empty()) {
+            results.status = Status::Completed;
+            job.cache->store(cache_key, results);
         }
+        finish(Status::Completed);
+    }
+}
 
-        // Execute TLC with proper argument passing
-        std::string output = pImpl->executeCommand("java", args);
-        
-        auto end_time = std::chrono::steady_clock::now();
-        std::chrono::duration<double> elapsed = end_time - start_time;
-        
-        pImpl->results.execution_time_seconds = elapsed.count();
-        
-        // Parse output
-        pImpl->parseResults(output);
-
-        // Update status
-        if (pImpl->should_cancel) {
-            pImpl->status = Status::Cancelled;
-            pImpl->results.status = Status::Cancelled;
-        } else if (!pImpl->results.error_message.empty()) {
-            pImpl->status = Status::Failed;
-            pImpl->results.status = Status::Failed;
-        } else {
-            pImpl->status = Status::Completed;
-            pImpl->results.status = Status::Completed;
-        }
-
-        if (pImpl->status_callback) {
-            pImpl->status_callback(pImpl->status);
+TLCRunner::TLCRunner() : pImpl(std::make_unique<Impl>()) {}
+
+TLCRunner::~TLCRunner() = default;
+
+bool TLCRunner::startModelCheck(const std::string& spec_file, const std::string& config_file) {
+    {
+        std::lock_guard<std::mutex> lock(pImpl->job_mutex);
+        if (pImpl->busy) {
+            return false;
         }
-    });
+        pImpl->busy = true;
+        // Together with busy: a cancel() from here on stops this run
+        pImpl->should_cancel = false;
+    }
+
+    // The runner thread is idle: it does not touch results until it gets
+    // the job below
+    pImpl->resetResults(Status::Running);
+    pImpl->publish(RunResults(pImpl->results));
+    pImpl->updateProgress(pImpl->results, Status::Running, 0.0);
+    pImpl->status = Status::Running;
+
+    Impl::Job job{spec_file, config_file, pImpl->options, pImpl->cache, pImpl->callbacks.forRun()};
+    Impl::notifyStatus(job.callbacks, Status::Running);
 
+    {
+        std::lock_guard<std::mutex> lock(pImpl->job_mutex);
+        pImpl->job = std::move(job);
+        if (!pImpl->runner_thread.joinable()) {
+            pImpl->runner_thread = std::thread(&Impl::runnerLoop, pImpl.get());
+        }
+    }
+    pImpl->job_ready.notify_one();
     return true;
 }
 
+void TLCRunner::setOptions(const TLCOptions& options) {
+    pImpl->options = options;
+}
+
+TLCOptions TLCRunner::options() const {
+    return pImpl->options;
+}
+
+void TLCRunner::setWorkerCount(int workers) {
+    pImpl->options.workers = std::max(0, workers);
+}
+
+void TLCRunner::setRunCache(std::shared_ptr<RunCache> cache) {
+    pImpl->cache = std::move(cache);
+}
+
 void TLCRunner::cancel() {
     pImpl->should_cancel = true;
 }
@@ -165,51 +591,111 @@ TLCRunner::Status TLCRunner::getStatus() const {
     return pImpl->status;
 }
 
+TLCRunner::Progress TLCRunner::getProgress() const {
+    return pImpl->progress.load();
+}
+
 TLCRunner::RunResults TLCRunner::getResults() const {
-    return pImpl->results;
+    return *pImpl->currentSnapshot();
+}
+
+std::shared_ptr<const TLCRunner::RunResults> TLCRunner::getSnapshot() const {
+    return pImpl->currentSnapshot();
 }
 
 void TLCRunner::setStatusCallback(std::function<void(Status)> callback) {
-    pImpl->status_callback = callback;
+    pImpl->callbacks.status = std::move(callback);
 }
 
 void TLCRunner::setProgressCallback(std::function<void(int, const std::string&)> callback) {
-    pImpl->progress_callback = callback;
+    pImpl->callbacks.progress = std::move(callback);
+}
+
+void TLCRunner::setCallbackContext(QObject* context) {
+    pImpl->callbacks.context = CallbackContext(context);
 }
 
 bool TLCRunner::saveResults(const std::string& filename) const {
-    std::ofstream out(filename);
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
     if (!out) return false;
+    return results_file::write(out, *pImpl->currentSnapshot());
+}
 
-    // Save as simple text format (could be JSON in real implementation)
-    out << "Status: " << static_cast<int>(pImpl->results.status) << "\n";
-    out << "States: " << pImpl->results.states_generated << "\n";
-    out << "Distinct: " << pImpl->results.distinct_states << "\n";
-    out << "Time: " << pImpl->results.execution_time_seconds << "\n";
-    if (!pImpl->results.error_message.empty()) {
-        out << "Error: " << pImpl->results.error_message << "\n";
+bool TLCRunner::loadResults(const std::string& filename) {
+    // The published results and progress belong to a run in progress;
+    // holding busy also keeps a run from starting during the load
+    {
+        std::lock_guard<std::mutex> lock(pImpl->job_mutex);
+        if (pImpl->busy) {
+            return false;
+        }
+        pImpl->busy = true;
     }
+    const auto release = qScopeGuard([this] {
+        std::lock_guard<std::mutex> lock(pImpl->job_mutex);
+        pImpl->busy = false;
+    });
 
+    RunResults loaded{};
+    if (!Impl::readResults(filename, loaded)) return false;
+    pImpl->updateProgress(loaded, Status::Completed, loaded.execution_time_seconds);
+    pImpl->publish(std::move(loaded));
+    pImpl->status = Status::Completed;
     return true;
 }
 
-bool TLCRunner::loadResults(const std::string& filename) {
+bool TLCRunner::Impl::readResults(const std::string& filename, RunResults& loaded) {
+    // Binary results files are mapped and their states used in place; the
+    // QFile owns the mapping and lives as long as the states refer to it
+    auto file = std::make_shared<QFile>(QString::fromStdString(filename));
+    if (!file->open(QIODevice::ReadOnly)) return false;
+    qint64 size = file->size();
+    const uchar* mapped = size > 0 ? file->map(0, size) : nullptr;
+    if (mapped) {
+        std::string_view data(reinterpret_cast<const char*>(mapped), static_cast<std::size_t>(size));
+        if (results_file::isResultsFile(data)) {
+            if (!results_file::read(data, file, loaded)) return false;
+            loaded.index = std::make_shared<const StateIndex>(loaded.states, loaded.transitions);
+            return true;
+        }
+    }
+    file.reset();
+    return readTextResults(filename, loaded);
+}
+
+bool TLCRunner::Impl::readTextResults(const std::string& filename, RunResults& loaded) {
     std::ifstream in(filename);
     if (!in) return false;
 
-    // Load from simple text format
+    // Results saved by earlier versions: the run's status, counters and
+    // error message, one "Key: value" line each; they held no states
     std::string line;
+    loaded.status = Status::Completed;
     while (std::getline(in, line)) {
-        if (line.find("States:") == 0) {
-            pImpl->results.states_generated = std::stoi(line.substr(8));
+        if (line.find("Status:") == 0) {
+            int status = 0;
+            if (!parseField(std::string_view(line).substr(7), status)) return false;
+            if (status < static_cast<int>(Status::NotStarted) || status > static_cast<int>(Status::Cancelled)) {
+                return false;
+            }
+            loaded.status = static_cast<Status>(status);
+        } else if (line.find("States:") == 0) {
+            if (!parseField(std::string_view(line).substr(7), loaded.states_generated)) return false;
         } else if (line.find("Distinct:") == 0) {
-            pImpl->results.distinct_states = std::stoi(line.substr(10));
+            if (!parseField(std::string_view(line).substr(9), loaded.distinct_states)) return false;
         } else if (line.find("Time:") == 0) {
-            pImpl->results.execution_time_seconds = std::stod(line.substr(6));
+            if (!parseField(std::string_view(line).substr(5), loaded.execution_time_seconds)) return false;
+        } else if (line.find("Error:") == 0) {
+            // The error message was saved last, with its line breaks: every
+            // error line TLC reported, as the runner collected them
+            loaded.error_message = line.substr(line.size() > 6 && line[6] == ' ' ? 7 : 6);
+            while (std::getline(in, line)) {
+                loaded.error_message += '\n';
+                loaded.error_message += line;
+            }
         }
     }
-
-    pImpl->status = Status::Completed;
+    loaded.index = std::make_shared<const StateIndex>(loaded.states, loaded.transitions);
     return true;
 }
 
@@ -1,10 +1,13 @@
 #include "trace_viewer_model.h"
+#include "state_index.h"
+#include "role_cache.h"
 #include <QVariantMap>
 #include <QVariantList>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <sstream>
+#include <string_view>
 
 namespace tla_visualiser {
 
@@ -13,15 +16,73 @@ public:
     struct TraceStep {
         int step_number;
         int state_id;
-        std::string state_description;
+        std::size_t state_index;   // position in `states`
         std::string action;
-        std::vector<std::pair<std::string, std::string>> variables;
     };
 
     std::vector<TraceStep> steps;
+    // Shared with the results or snapshot the steps came from
+    std::shared_ptr<const StateStore> states = std::make_shared<const StateStore>();
     int current_step;
+    int previous_id = -1;
+    RoleCache role_cache;   // text roles, converted once per row
 
     Impl() : current_step(0) {}
+
+    // Appends a step per state of `state_sequence` found in `results`,
+    // whose states `store` holds and `index` looks up
+    void appendSteps(const std::vector<int>& state_sequence, const TLCRunner::RunResults& results,
+                     const StateIndex& index, std::shared_ptr<const StateStore> store) {
+        steps.reserve(steps.size() + state_sequence.size());
+
+        for (int state_id : state_sequence) {
+            long long i = index.indexOf(state_id);
+            if (i < 0) {
+                continue;
+            }
+            std::size_t state_index = static_cast<std::size_t>(i);
+
+            TraceStep step;
+            step.step_number = static_cast<int>(steps.size());
+            step.state_id = state_id;
+            step.state_index = state_index;
+
+            // Action of the transition into this state, preferring the edge
+            // from the previous step. Only non-initial steps have transitions
+            if (!steps.empty()) {
+                long long t = index.incomingFrom(state_index, previous_id, results.transitions);
+                if (t >= 0) {
+                    step.action = results.transitions[t].action;
+                }
+            } else {
+                step.action = "Initial";
+            }
+
+            steps.push_back(std::move(step));
+            previous_id = state_id;
+        }
+        states = std::move(store);
+    }
+
+    // Steps of `state_sequence` that appendSteps() would add
+    static std::size_t countFound(const std::vector<int>& state_sequence, const StateIndex& index) {
+        std::size_t count = 0;
+        for (int state_id : state_sequence) {
+            if (index.indexOf(state_id) >= 0) ++count;
+        }
+        return count;
+    }
+
+    QVariantList variablesOf(const TraceStep& step) const {
+        QVariantList vars;
+        states->forEachVariable(step.state_index, [&vars](std::string_view key, std::string_view value) {
+            QVariantMap var;
+            var["name"] = QString::fromUtf8(key.data(), static_cast<qsizetype>(key.size()));
+            var["value"] = QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size()));
+            vars.append(var);
+        });
+        return vars;
+    }
 };
 
 TraceViewerModel::TraceViewerModel(QObject* parent)
@@ -39,7 +100,8 @@ QVariant TraceViewerModel::data(const QModelIndex& index, int role) const {
         return QVariant();
     }
 
-    const auto& step = pImpl->steps[index.row()];
+    const int row = index.row();
+    const auto& step = pImpl->steps[row];
 
     switch (role) {
     case StepNumberRole:
@@ -47,19 +109,18 @@ QVariant TraceViewerModel::data(const QModelIndex& index, int role) const {
     case StateIdRole:
         return step.state_id;
     case StateDescriptionRole:
-        return QString::fromStdString(step.state_description);
+        return pImpl->role_cache.value(row, role, [this, &step] {
+            std::string_view description = pImpl->states->description(step.state_index);
+            return QString::fromUtf8(description.data(), static_cast<qsizetype>(description.size()));
+        });
     case ActionRole:
-        return QString::fromStdString(step.action);
-    case VariablesRole: {
-        QVariantList vars;
-        for (const auto& [key, value] : step.variables) {
-            QVariantMap var;
-            var["name"] = QString::fromStdString(key);
-            var["value"] = QString::fromStdString(value);
-            vars.append(var);
-        }
-        return vars;
-    }
+        return pImpl->role_cache.value(row, role, [&step] {
+            return QString::fromStdString(step.action);
+        });
+    case VariablesRole:
+        return pImpl->role_cache.value(row, role, [this, &step] {
+            return pImpl->variablesOf(step);
+        });
     }
 
     return QVariant();
@@ -79,44 +140,52 @@ void TraceViewerModel::loadTrace(const TLCRunner::CounterExample& trace,
                                   const TLCRunner::RunResults& results) {
     beginResetModel();
     pImpl->steps.clear();
+    pImpl->previous_id = -1;
+    pImpl->role_cache.clear();
+    pImpl->appendSteps(trace.state_sequence, results, *StateIndex::of(results),
+                       std::make_shared<const StateStore>(results.states));
+    endResetModel();
+    emit traceUpdated();
+}
 
-    int step_num = 0;
-    for (int state_id : trace.state_sequence) {
-        // Find state in results
-        auto it = std::find_if(results.states.begin(), results.states.end(),
-                              [state_id](const TLCRunner::State& s) { return s.id == state_id; });
-        
-        if (it != results.states.end()) {
-            Impl::TraceStep step;
-            step.step_number = step_num;
-            step.state_id = state_id;
-            step.state_description = it->description;
-            step.variables = it->variables;
-            
-            // Find action (transition to this state)
-            // Only non-initial steps have transitions
-            if (step_num > 0) {
-                auto trans_it = std::find_if(results.transitions.begin(), results.transitions.end(),
-                    [state_id](const TLCRunner::Transition& t) { return t.to_state == state_id; });
-                if (trans_it != results.transitions.end()) {
-                    step.action = trans_it->action;
-                }
-            } else {
-                step.action = "Initial";
-            }
-            
-            pImpl->steps.push_back(step);
-            step_num++;
-        }
+void TraceViewerModel::loadTrace(const TLCRunner::CounterExample& trace,
+                                  std::shared_ptr<const TLCRunner::RunResults> snapshot) {
+    if (!snapshot) {
+        clear();
+        return;
     }
-
+    beginResetModel();
+    pImpl->steps.clear();
+    pImpl->previous_id = -1;
+    pImpl->role_cache.clear();
+    // Aliasing: steps read the snapshot's store, which stays alive with it
+    pImpl->appendSteps(trace.state_sequence, *snapshot, *StateIndex::of(*snapshot),
+                       std::shared_ptr<const StateStore>(snapshot, &snapshot->states));
     endResetModel();
     emit traceUpdated();
 }
 
+void TraceViewerModel::appendSteps(const TLCRunner::CounterExample& more,
+                                   const TLCRunner::RunResults& results) {
+    // Built once for counting and appending when the results have none
+    const std::shared_ptr<const StateIndex> index = StateIndex::of(results);
+    const std::size_t added = Impl::countFound(more.state_sequence, *index);
+    if (added == 0) return;
+
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(added) - 1);
+    pImpl->appendSteps(more.state_sequence, results, *index,
+                       std::make_shared<const StateStore>(results.states));
+    endInsertRows();
+    emit traceUpdated();
+}
+
 void TraceViewerModel::clear() {
     beginResetModel();
     pImpl->steps.clear();
+    pImpl->states = std::make_shared<const StateStore>();
+    pImpl->previous_id = -1;
+    pImpl->role_cache.clear();
     pImpl->current_step = 0;
     endResetModel();
 }
@@ -127,17 +196,9 @@ QVariantMap TraceViewerModel::getStepDetails(int step) const {
         const auto& s = pImpl->steps[step];
         result["stepNumber"] = s.step_number;
         result["stateId"] = s.state_id;
-        result["description"] = QString::fromStdString(s.state_description);
-        result["action"] = QString::fromStdString(s.action);
-        
-        QVariantList vars;
-        for (const auto& [key, value] : s.variables) {
-            QVariantMap var;
-            var["name"] = QString::fromStdString(key);
-            var["value"] = QString::fromStdString(value);
-            vars.append(var);
-        }
-        result["variables"] = vars;
+        result["description"] = data(index(step), StateDescriptionRole);
+        result["action"] = data(index(step), ActionRole);
+        result["variables"] = data(index(step), VariablesRole);
     }
     return result;
 }
@@ -151,9 +212,9 @@ QString TraceViewerModel::exportToMarkdown() const {
         ss << "**State ID:** " << step.state_id << "\n\n";
         ss << "**Action:** " << step.action << "\n\n";
         ss << "**Variables:**\n\n";
-        for (const auto& [key, value] : step.variables) {
+        pImpl->states->forEachVariable(step.state_index, [&ss](std::string_view key, std::string_view value) {
             ss << "- `" << key << "` = " << value << "\n";
-        }
+        });
         ss << "\n";
     }
     
@@ -170,12 +231,12 @@ QString TraceViewerModel::exportToJson() const {
         stepObj["action"] = QString::fromStdString(step.action);
         
         QJsonArray varsArray;
-        for (const auto& [key, value] : step.variables) {
+        pImpl->states->forEachVariable(step.state_index, [&varsArray](std::string_view key, std::string_view value) {
             QJsonObject varObj;
-            varObj["name"] = QString::fromStdString(key);
-            varObj["value"] = QString::fromStdString(value);
+            varObj["name"] = QString::fromUtf8(key.data(), static_cast<qsizetype>(key.size()));
+            varObj["value"] = QString::fromUtf8(value.data(), static_cast<qsizetype>(value.size()));
             varsArray.append(varObj);
-        }
+        });
         stepObj["variables"] = varsArray;
         
         stepsArray.append(stepObj);
@@ -0,0 +1,158 @@
+#ifndef HTTP_STAND_IN_H
+#define HTTP_STAND_IN_H
+
+#include <QByteArray>
+#include <QList>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QMetaObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Minimal HTTP/1.1 server standing in for GitHub in tests
+ *
+ * Serves fixed bodies by request target ("/path?query") from its own
+ * thread, keeps connections alive and counts connections and requests.
+ * Every response can be delayed, so that tests can tell concurrent
+ * fetching from sequential fetching. Unknown targets get a 404.
+ *
+ * Bodies carry an ETag derived from their content and a fixed
+ * Last-Modified date; a matching If-None-Match (or, without one,
+ * If-Modified-Since) gets a 304.
+ */
+class HttpStandIn {
+public:
+    explicit HttpStandIn(std::map<std::string, std::string> routes, int delay_ms = 0)
+        : routes_(std::move(routes)), delay_ms_(delay_ms) {
+        thread_ = std::thread([this] { serve(); });
+        std::unique_lock<std::mutex> lock(mutex_);
+        started_.wait(lock, [this] { return port_ != 0 || failed_; });
+    }
+
+    ~HttpStandIn() {
+        if (loop_) {
+            QMetaObject::invokeMethod(loop_, [loop = loop_] { loop->quit(); }, Qt::QueuedConnection);
+        }
+        thread_.join();
+    }
+
+    std::string baseUrl() const { return "http://127.0.0.1:" + std::to_string(port_); }
+    int connections() const { return connections_; }
+    int requests() const { return requests_; }
+    int notModified() const { return not_modified_; }
+
+    // Add or change a route while serving
+    void setRoute(const std::string& target, const std::string& body) {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        routes_[target] = body;
+    }
+
+private:
+    void serve() {
+        QEventLoop loop;
+        QTcpServer server;
+        if (!server.listen(QHostAddress::LocalHost, 0)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+            started_.notify_all();
+            return;
+        }
+        QObject::connect(&server, &QTcpServer::newConnection, &server, [this, &server] {
+            while (QTcpSocket* socket = server.nextPendingConnection()) {
+                ++connections_;
+                auto buffer = std::make_shared<QByteArray>();
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket, buffer] {
+                    buffer->append(socket->readAll());
+                    qsizetype end;
+                    while ((end = buffer->indexOf("\r\n\r\n")) >= 0) {
+                        const QByteArray head = buffer->left(end);
+                        buffer->remove(0, end + 4);
+                        respond(socket, head);
+                    }
+                });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            loop_ = &loop;
+            port_ = server.serverPort();
+            started_.notify_all();
+        }
+        loop.exec();
+    }
+
+    void respond(QTcpSocket* socket, const QByteArray& head) {
+        ++requests_;
+        const QList<QByteArray> lines = head.split('\n');
+        const std::string target = lines.value(0).split(' ').value(1).toStdString();
+        QByteArray if_none_match, if_modified_since;
+        for (qsizetype i = 1; i < lines.size(); ++i) {
+            const qsizetype colon = lines[i].indexOf(':');
+            if (colon < 0) continue;
+            const QByteArray name = lines[i].left(colon).trimmed().toLower();
+            const QByteArray value = lines[i].mid(colon + 1).trimmed();
+            if (name == "if-none-match") {
+                if_none_match = value;
+            } else if (name == "if-modified-since") {
+                if_modified_since = value;
+            }
+        }
+
+        std::string body;
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            auto route = routes_.find(target);
+            found = route != routes_.end();
+            if (found) body = route->second;
+        }
+
+        QByteArray response;
+        if (!found) {
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\nConnection: keep-alive\r\n\r\nnot found";
+        } else {
+            const QByteArray etag = "\"" + QByteArray::number(static_cast<quint64>(std::hash<std::string>{}(body))) + "\"";
+            const QByteArray validators = "ETag: " + etag + "\r\nLast-Modified: " + kLastModified + "\r\n";
+            const bool unchanged = !if_none_match.isEmpty() ? if_none_match == etag
+                                                            : if_modified_since == kLastModified;
+            if (unchanged) {
+                ++not_modified_;
+                response = "HTTP/1.1 304 Not Modified\r\n" + validators + "Connection: keep-alive\r\n\r\n";
+            } else {
+                response = "HTTP/1.1 200 OK\r\n" + validators;
+                response += "Content-Length: " + QByteArray::number(static_cast<qsizetype>(body.size())) + "\r\n";
+                response += "Connection: keep-alive\r\n\r\n" + QByteArray::fromStdString(body);
+            }
+        }
+        // Responses on one connection go out in request order either way
+        QTimer::singleShot(delay_ms_, socket, [socket, response] { socket->write(response); });
+    }
+
+    static constexpr const char* kLastModified = "Wed, 21 Oct 2015 07:28:00 GMT";
+
+    std::map<std::string, std::string> routes_;
+    std::mutex routes_mutex_;
+    int delay_ms_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable started_;
+    QEventLoop* loop_ = nullptr;
+    quint16 port_ = 0;
+    bool failed_ = false;
+    std::atomic<int> connections_{0};
+    std::atomic<int> requests_{0};
+    std::atomic<int> not_modified_{0};
+};
+
+#endif // HTTP_STAND_IN_H
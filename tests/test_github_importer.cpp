@@ -1,5 +1,18 @@
 #include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QThread>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include "github_importer.h"
+#include "http_stand_in.h"
+#include "import_cache.h"
+
+using tla_visualiser::ImportCache;
 
 class TestGitHubImporter : public QObject
 {
@@ -10,6 +23,17 @@ private slots:
     void testParseRawUrl();
     void testParseRepoUrl();
     void testInvalidUrl();
+    void testParseNestedPath();
+    void testParseRepoUrlTrailingSlash();
+    void testFetchRepository();
+    void testStreamsTreeListing();
+    void testRepositoryUsesCache();
+    void testRevalidatesFiles();
+    void testOfflineMode();
+    void testAsyncDeliversToContext();
+    void testAsyncDeduplicates();
+    void testAsyncCancel();
+    void testAsyncContextDestroyed();
 };
 
 void TestGitHubImporter::testParseFileUrl()
@@ -66,5 +90,442 @@ void TestGitHubImporter::testInvalidUrl()
     QVERIFY(info.repo.empty());
 }
 
+void TestGitHubImporter::testParseNestedPath()
+{
+    tla_visualiser::GitHubImporter importer;
+    
+    std::string url = "https://github.com/owner/repo/blob/v1.2/specs/paxos/Paxos.tla";
+    auto info = importer.parseUrl(url);
+    
+    QCOMPARE(info.owner, std::string("owner"));
+    QCOMPARE(info.repo, std::string("repo"));
+    QCOMPARE(info.branch, std::string("v1.2"));
+    QCOMPARE(info.file_path, std::string("specs/paxos/Paxos.tla"));
+    QVERIFY(info.is_file_url);
+}
+
+void TestGitHubImporter::testParseRepoUrlTrailingSlash()
+{
+    tla_visualiser::GitHubImporter importer;
+    
+    auto info = importer.parseUrl("https://github.com/owner/repo/");
+    QCOMPARE(info.owner, std::string("owner"));
+    QCOMPARE(info.repo, std::string("repo"));
+    QVERIFY(!info.is_file_url);
+
+    // Other repository pages are not recognised as repo URLs
+    info = importer.parseUrl("https://github.com/owner/repo/tree/main");
+    QVERIFY(info.owner.empty());
+}
+
+void TestGitHubImporter::testFetchRepository()
+{
+    const std::string tree = R"({"sha": "t0", "truncated": false, "tree": [
+        {"path": "Spec.tla", "type": "blob", "sha": "a1"},
+        {"path": "Spec.cfg", "type": "blob", "sha": "a2"},
+        {"path": "README.md", "type": "blob", "sha": "a3"},
+        {"path": "specs", "type": "tree", "sha": "a4"},
+        {"path": "specs/Two Phase.tla", "type": "blob", "sha": "a5"},
+        {"path": "specs/Gone.tla", "type": "blob", "sha": "a6"}
+    ]})";
+    HttpStandIn server({
+        {"/repos/owner/repo/git/trees/main?recursive=1", tree},
+        {"/owner/repo/main/Spec.tla", "---- MODULE Spec ----"},
+        {"/owner/repo/main/Spec.cfg", "INIT Init"},
+        {"/owner/repo/main/README.md", "readme"},
+        {"/owner/repo/main/specs/Two%20Phase.tla", "---- MODULE TwoPhase ----"},
+    });
+
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(std::make_shared<ImportCache>(cache_dir.path().toStdString()));
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    std::vector<int> progress;
+    importer.setProgressCallback([&progress](int percent) { progress.push_back(percent); });
+
+    auto files = importer.fetchRepository(importer.parseUrl("https://github.com/owner/repo"));
+
+    // README is not fetched; Gone.tla is missing on the server
+    QCOMPARE(files.size(), std::size_t(3));
+    QCOMPARE(files[0].path, std::string("Spec.tla"));
+    QCOMPARE(files[0].content, std::string("---- MODULE Spec ----"));
+    QCOMPARE(files[0].sha, std::string("a1"));
+    QCOMPARE(files[1].path, std::string("Spec.cfg"));
+    QCOMPARE(files[2].path, std::string("specs/Two Phase.tla"));
+    QCOMPARE(files[2].content, std::string("---- MODULE TwoPhase ----"));
+    QCOMPARE(server.requests(), 5);
+
+    QVERIFY(!progress.empty());
+    QCOMPARE(progress.back(), 100);
+    QVERIFY(std::is_sorted(progress.begin(), progress.end()));
+}
+
+void TestGitHubImporter::testStreamsTreeListing()
+{
+    // A large listing with a few specs scattered through it
+    std::string tree = R"({"sha": "t0", "tree": [)";
+    const int entries = 20000;
+    for (int i = 0; i < entries; ++i) {
+        const std::string path = i % 1000 == 7 ? "specs/S" + std::to_string(i) + ".tla"
+                                               : "src/file" + std::to_string(i) + ".c";
+        tree += (i ? ",\n" : "\n");
+        tree += R"({"path": ")" + path + R"(", "mode": "100644", "type": "blob", "sha": "s)" +
+                std::to_string(i) + R"(", "size": 120, "url": "https://example.invalid/blobs/)" +
+                std::to_string(i) + "\"}";
+    }
+    tree += R"(], "truncated": false})";
+
+    std::map<std::string, std::string> routes = {{"/repos/owner/big/git/trees/main?recursive=1", tree}};
+    for (int i = 7; i < entries; i += 1000) {
+        routes["/owner/big/main/specs/S" + std::to_string(i) + ".tla"] = "---- MODULE S ----";
+    }
+    HttpStandIn server(routes);
+
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(nullptr);
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    std::vector<std::pair<std::size_t, std::size_t>> listing;
+    importer.setListingCallback([&listing](std::size_t seen, std::size_t matched) {
+        listing.emplace_back(seen, matched);
+    });
+
+    auto files = importer.fetchRepository(importer.parseUrl("https://github.com/owner/big"));
+    QCOMPARE(files.size(), std::size_t(entries / 1000));
+    QCOMPARE(files[0].path, std::string("specs/S7.tla"));
+    QCOMPARE(files[0].sha, std::string("s7"));
+
+    // Counts arrive as the listing streams, ending with the full tally
+    QVERIFY(listing.size() > 1);
+    QCOMPARE(listing.back().first, std::size_t(entries));
+    QCOMPARE(listing.back().second, std::size_t(entries / 1000));
+    QVERIFY(std::is_sorted(listing.begin(), listing.end()));
+
+    // A malformed listing imports nothing
+    HttpStandIn broken({{"/repos/owner/big/git/trees/main?recursive=1", R"({"tree": [{"path": "A.tla",)"}});
+    importer.setBaseUrls(broken.baseUrl(), broken.baseUrl());
+    QVERIFY(importer.fetchRepository(importer.parseUrl("https://github.com/owner/big")).empty());
+    QCOMPARE(broken.requests(), 1);
+}
+
+void TestGitHubImporter::testRepositoryUsesCache()
+{
+    const std::string spec = "---- MODULE Spec ----";
+    const std::string config = "INIT Init";
+    const std::string extra = "---- MODULE Extra ----";
+    auto entry = [](const std::string& path, const std::string& content) {
+        return R"({"path": ")" + path + R"(", "type": "blob", "sha": ")" + ImportCache::blobSha(content) + "\"}";
+    };
+    HttpStandIn server({
+        {"/repos/owner/repo/git/trees/main?recursive=1",
+         R"({"tree": [)" + entry("Spec.tla", spec) + "," + entry("Spec.cfg", config) + "]}"},
+        {"/repos/owner/repo/git/trees/dev?recursive=1",
+         R"({"tree": [)" + entry("Spec.tla", spec) + "," + entry("Extra.tla", extra) + "]}"},
+        {"/owner/repo/main/Spec.tla", spec},
+        {"/owner/repo/main/Spec.cfg", config},
+        {"/owner/repo/dev/Spec.tla", spec},
+        {"/owner/repo/dev/Extra.tla", extra},
+    });
+
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    auto cache = std::make_shared<ImportCache>(cache_dir.path().toStdString());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(cache);
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    auto main = importer.parseUrl("https://github.com/owner/repo");
+
+    QCOMPARE(importer.fetchRepository(main).size(), std::size_t(2));
+    QCOMPARE(server.requests(), 3);
+
+    // Unchanged files are not downloaded again
+    std::vector<int> progress;
+    importer.setProgressCallback([&progress](int percent) { progress.push_back(percent); });
+    auto again = importer.fetchRepository(main);
+    QCOMPARE(again.size(), std::size_t(2));
+    QCOMPARE(again[0].content, spec);
+    QCOMPARE(again[1].content, config);
+    QCOMPARE(server.requests(), 4);
+    QCOMPARE(progress.back(), 100);
+
+    // Another branch shares the blobs it has in common
+    auto dev = main;
+    dev.branch = "dev";
+    auto files = importer.fetchRepository(dev);
+    QCOMPARE(files.size(), std::size_t(2));
+    QCOMPARE(files[1].content, extra);
+    QCOMPARE(server.requests(), 6);
+    QCOMPARE(cache->stats().blobs, std::size_t(3));
+    QCOMPARE(cache->stats().locations, std::size_t(4));
+
+    // Single files are found by where they were imported from
+    auto file = importer.parseUrl("https://github.com/owner/repo/blob/dev/Extra.tla");
+    QCOMPARE(importer.fetchFile(file), extra);
+    QCOMPARE(server.requests(), 6);
+}
+
+void TestGitHubImporter::testRevalidatesFiles()
+{
+    HttpStandIn server({{"/owner/repo/main/Spec.tla", "---- MODULE Spec ----"}});
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(std::make_shared<ImportCache>(cache_dir.path().toStdString()));
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    auto file = importer.parseUrl("https://github.com/owner/repo/blob/main/Spec.tla");
+
+    QCOMPARE(importer.fetchFile(file), std::string("---- MODULE Spec ----"));
+    QCOMPARE(importer.fetchStats().misses, uint64_t(1));
+
+    // Unchanged: one 304, no body
+    QCOMPARE(importer.fetchFile(file), std::string("---- MODULE Spec ----"));
+    QCOMPARE(importer.fetchStats().revalidated, uint64_t(1));
+    QCOMPARE(server.notModified(), 1);
+
+    // Changed upstream: the new version replaces the cached one
+    server.setRoute("/owner/repo/main/Spec.tla", "---- MODULE Spec2 ----");
+    QCOMPARE(importer.fetchFile(file), std::string("---- MODULE Spec2 ----"));
+    QCOMPARE(importer.fetchFile(file), std::string("---- MODULE Spec2 ----"));
+    QCOMPARE(importer.fetchStats().misses, uint64_t(2));
+    QCOMPARE(importer.fetchStats().revalidated, uint64_t(2));
+    QCOMPARE(server.requests(), 4);
+
+    // Server unreachable: the cached copy is served
+    importer.setBaseUrls("http://127.0.0.1:1", "http://127.0.0.1:1");
+    QCOMPARE(importer.fetchFile(file), std::string("---- MODULE Spec2 ----"));
+    QCOMPARE(importer.fetchStats().stale, uint64_t(1));
+
+    // Gone upstream: not served
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    QVERIFY(importer.fetchFile(importer.parseUrl("https://github.com/owner/repo/blob/main/Gone.tla")).empty());
+    QCOMPARE(importer.fetchStats().failures, uint64_t(1));
+}
+
+void TestGitHubImporter::testOfflineMode()
+{
+    const std::string spec = "---- MODULE Spec ----";
+    const std::string tree = R"({"tree": [{"path": "Spec.tla", "type": "blob", "sha": ")" +
+                             ImportCache::blobSha(spec) + R"("}]})";
+    HttpStandIn server({
+        {"/repos/owner/repo/git/trees/main?recursive=1", tree},
+        {"/owner/repo/main/Spec.tla", spec},
+    });
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(std::make_shared<ImportCache>(cache_dir.path().toStdString()));
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    auto repo = importer.parseUrl("https://github.com/owner/repo");
+    QCOMPARE(importer.fetchRepository(repo).size(), std::size_t(1));
+    const int requests = server.requests();
+
+    importer.setOfflineMode(true);
+    QVERIFY(importer.offlineMode());
+    auto files = importer.fetchRepository(repo);
+    QCOMPARE(files.size(), std::size_t(1));
+    QCOMPARE(files[0].path, std::string("Spec.tla"));
+    QCOMPARE(files[0].content, spec);
+    QCOMPARE(importer.fetchFile(importer.parseUrl("https://github.com/owner/repo/blob/main/Spec.tla")), spec);
+    QVERIFY(importer.fetchFile(importer.parseUrl("https://github.com/owner/repo/blob/main/Other.tla")).empty());
+    QCOMPARE(server.requests(), requests);
+
+    const auto stats = importer.fetchStats();
+    QCOMPARE(stats.hits, uint64_t(2));
+    QCOMPARE(stats.misses, uint64_t(1));
+    QCOMPARE(stats.failures, uint64_t(1));
+}
+
+void TestGitHubImporter::testAsyncDeliversToContext()
+{
+    const std::string tree = R"({"tree": [
+        {"path": "Spec.tla", "type": "blob", "sha": "a1"},
+        {"path": "Spec.cfg", "type": "blob", "sha": "a2"}
+    ]})";
+    HttpStandIn server({
+        {"/repos/owner/repo/git/trees/main?recursive=1", tree},
+        {"/owner/repo/main/Spec.tla", "---- MODULE Spec ----"},
+        {"/owner/repo/main/Spec.cfg", "INIT Init"},
+    }, 200);
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(std::make_shared<ImportCache>(cache_dir.path().toStdString()));
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    importer.setCallbackContext(this);
+
+    std::vector<int> progress;
+    bool progress_on_gui = true;
+    importer.setProgressCallback([&](int percent) {
+        progress_on_gui = progress_on_gui && QThread::currentThread() == thread();
+        progress.push_back(percent);
+    });
+    bool done = false;
+    bool on_gui = false;
+    std::vector<tla_visualiser::GitHubImporter::FileInfo> files;
+
+    // Returns before the first response could have arrived
+    QElapsedTimer timer;
+    timer.start();
+    importer.fetchRepositoryAsync(importer.parseUrl("https://github.com/owner/repo"),
+        [&](tla_visualiser::GitHubImporter::RequestStatus status,
+            const std::vector<tla_visualiser::GitHubImporter::FileInfo>& fetched) {
+            QCOMPARE(status, tla_visualiser::GitHubImporter::RequestStatus::Completed);
+            on_gui = QThread::currentThread() == thread();
+            files = fetched;
+            done = true;
+        });
+    QVERIFY(timer.elapsed() < 200);
+    QVERIFY(!done);
+
+    QTRY_VERIFY_WITH_TIMEOUT(done, 5000);
+    QVERIFY(on_gui);
+    QCOMPARE(files.size(), std::size_t(2));
+    QCOMPARE(files[0].content, std::string("---- MODULE Spec ----"));
+    QVERIFY(progress_on_gui);
+    QVERIFY(!progress.empty());
+    QCOMPARE(progress.back(), 100);
+    QCOMPARE(importer.pendingRequests(), std::size_t(0));
+}
+
+void TestGitHubImporter::testAsyncDeduplicates()
+{
+    HttpStandIn server({
+        {"/owner/repo/main/Spec.tla", "---- MODULE Spec ----"},
+        {"/owner/repo/main/Other.tla", "---- MODULE Other ----"},
+    }, 100);
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(std::make_shared<ImportCache>(cache_dir.path().toStdString()));
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    importer.setCallbackContext(this);
+
+    using Status = tla_visualiser::GitHubImporter::RequestStatus;
+    std::vector<std::string> contents;
+    auto collect = [&contents](Status status, const std::string& content) {
+        QCOMPARE(status, Status::Completed);
+        contents.push_back(content);
+    };
+    auto spec = importer.parseUrl("https://github.com/owner/repo/blob/main/Spec.tla");
+    auto other = importer.parseUrl("https://github.com/owner/repo/blob/main/Other.tla");
+    std::vector<tla_visualiser::GitHubImporter::RequestId> ids;
+    for (int i = 0; i < 3; ++i) ids.push_back(importer.fetchFileAsync(spec, collect));
+    ids.push_back(importer.fetchFileAsync(other, collect));
+    QCOMPARE(importer.pendingRequests(), std::size_t(4));
+
+    // Every request has its own id, but identical ones share a download
+    std::sort(ids.begin(), ids.end());
+    QVERIFY(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+    QTRY_COMPARE_WITH_TIMEOUT(contents.size(), std::size_t(4), 5000);
+    QCOMPARE(server.requests(), 2);
+    QCOMPARE(std::count(contents.begin(), contents.end(), std::string("---- MODULE Spec ----")), 3);
+    QCOMPARE(importer.fetchStats().misses, uint64_t(2));
+
+    // Once finished, the same file is fetched again (and revalidated)
+    bool again = false;
+    importer.fetchFileAsync(spec, [&again](Status status, const std::string&) {
+        again = status == Status::Completed;
+    });
+    QTRY_VERIFY_WITH_TIMEOUT(again, 5000);
+    QCOMPARE(server.requests(), 3);
+    QCOMPARE(importer.fetchStats().revalidated, uint64_t(1));
+}
+
+void TestGitHubImporter::testAsyncCancel()
+{
+    std::string tree = R"({"tree": [)";
+    for (int i = 0; i < 20; ++i) {
+        if (i) tree += ",";
+        tree += R"({"path": "Spec)" + std::to_string(i) + R"(.tla", "type": "blob", "sha": "s)" +
+                std::to_string(i) + R"("})";
+    }
+    tree += "]}";
+    std::map<std::string, std::string> routes = {
+        {"/repos/owner/repo/git/trees/main?recursive=1", tree},
+        {"/owner/repo/main/Spec.tla", "---- MODULE Spec ----"},
+    };
+    for (int i = 0; i < 20; ++i) {
+        routes["/owner/repo/main/Spec" + std::to_string(i) + ".tla"] = "spec";
+    }
+    // Slow enough that a cancelled import would otherwise still be running
+    HttpStandIn server(routes, 1000);
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(std::make_shared<ImportCache>(cache_dir.path().toStdString()));
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    importer.setCallbackContext(this);
+
+    using Status = tla_visualiser::GitHubImporter::RequestStatus;
+    std::vector<Status> repo_status, spec_status, shared_status;
+    auto repo = importer.parseUrl("https://github.com/owner/repo");
+    auto spec = importer.parseUrl("https://github.com/owner/repo/blob/main/Spec.tla");
+    const auto running = importer.fetchRepositoryAsync(repo,
+        [&](Status status, const auto&) { repo_status.push_back(status); });
+    const auto queued = importer.fetchFileAsync(spec,
+        [&](Status status, const std::string&) { spec_status.push_back(status); });
+    const auto joined = importer.fetchFileAsync(spec,
+        [&](Status status, const std::string&) { shared_status.push_back(status); });
+
+    // A queued fetch shared with another request carries on for it
+    QVERIFY(importer.cancel(queued));
+    QVERIFY(!importer.cancel(queued));
+    QVERIFY(spec_status.empty());   // delivered through the event loop
+    QTRY_COMPARE(spec_status, std::vector<Status>{Status::Cancelled});
+
+    // A running import is aborted without waiting for the server
+    QTRY_COMPARE(server.requests(), 1);
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(importer.cancel(running));
+    QTRY_COMPARE(repo_status, std::vector<Status>{Status::Cancelled});
+    QTRY_COMPARE_WITH_TIMEOUT(shared_status, std::vector<Status>{Status::Completed}, 5000);
+    QVERIFY(timer.elapsed() < 2500);
+    QCOMPARE(importer.fetchStats().misses, uint64_t(1));
+
+    // Everything still pending, queued or running
+    importer.fetchRepositoryAsync(repo, [&](Status status, const auto&) { repo_status.push_back(status); });
+    importer.fetchFileAsync(importer.parseUrl("https://github.com/owner/repo/blob/main/Spec1.tla"),
+                            [&](Status status, const std::string&) { spec_status.push_back(status); });
+    importer.cancelAll();
+    importer.waitForIdle();
+    QTRY_COMPARE(repo_status.size(), std::size_t(2));
+    QTRY_COMPARE(spec_status.size(), std::size_t(2));
+    QCOMPARE(repo_status.back(), Status::Cancelled);
+    QCOMPARE(spec_status.back(), Status::Cancelled);
+    QCOMPARE(importer.pendingRequests(), std::size_t(0));
+    QCOMPARE(importer.fetchStats().failures, uint64_t(0));
+}
+
+void TestGitHubImporter::testAsyncContextDestroyed()
+{
+    HttpStandIn server({
+        {"/repos/owner/repo/git/trees/main?recursive=1",
+         R"({"tree": [{"path": "Spec.tla", "type": "blob", "sha": "s1"}]})"},
+        {"/owner/repo/main/Spec.tla", "---- MODULE Spec ----"},
+    });
+    QTemporaryDir cache_dir;
+    QVERIFY(cache_dir.isValid());
+    tla_visualiser::GitHubImporter importer;
+    importer.setImportCache(std::make_shared<ImportCache>(cache_dir.path().toStdString()));
+    importer.setBaseUrls(server.baseUrl(), server.baseUrl());
+    auto* receiver = new QObject;
+    importer.setCallbackContext(receiver);
+
+    bool called = false;
+    importer.setProgressCallback([&called](int) { called = true; });
+    importer.fetchRepositoryAsync(importer.parseUrl("https://github.com/owner/repo"),
+                                  [&called](auto, const auto&) { called = true; });
+    importer.fetchFileAsync(importer.parseUrl("https://github.com/owner/repo/blob/main/Spec.tla"),
+                            [&called](auto, const std::string&) { called = true; });
+
+    // Requests queued or running when the context goes finish without it
+    delete receiver;
+    importer.waitForIdle();
+    QTest::qWait(50);
+    QVERIFY(!called);
+    QCOMPARE(importer.pendingRequests(), std::size_t(0));
+}
+
 QTEST_MAIN(TestGitHubImporter)
 #include "test_github_importer.moc"
@@ -0,0 +1,148 @@
+#include <QtTest/QtTest>
+#include <QGuiApplication>
+#include <QQuickWindow>
+#include <QWheelEvent>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph_item.h"
+#include "state_graph_model.h"
+
+using tla_visualiser::GraphItem;
+using tla_visualiser::StateGraphModel;
+using tla_visualiser::TLCRunner;
+
+class TestGraphItem : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void testFitsAndDrawsGraph();
+    void testPanMovesDrawing();
+    void testWheelZoomsAroundCursor();
+    void testDetailLevelFollowsZoom();
+
+private:
+    QPointF toItem(const QPointF& layout) const
+    {
+        return layout * item->zoom() + item->pan();
+    }
+
+    bool isNodeColor(const QPointF& point)
+    {
+        QImage image = window->grabWindow();
+        return image.pixelColor(point.toPoint()) == item->nodeColor();
+    }
+
+    QQuickWindow* window = nullptr;
+    GraphItem* item = nullptr;
+    StateGraphModel* model = nullptr;
+};
+
+using Variables = std::vector<std::pair<std::string, std::string>>;
+
+void TestGraphItem::init()
+{
+    // Two states on a circle of radius 200: (200, 0) and (-200, 0)
+    TLCRunner::RunResults results{};
+    results.states.add(1, "A", Variables{{"x", "0"}});
+    results.states.add(2, "B", Variables{{"x", "1"}});
+    results.transitions.push_back({1, 2, "Next"});
+
+    model = new StateGraphModel;
+    model->setLayoutMode(StateGraphModel::LayoutMode::Circular);
+    model->loadFromResults(results);
+
+    window = new QQuickWindow;
+    window->resize(200, 200);
+    window->setColor(Qt::white);
+    item = new GraphItem(window->contentItem());
+    item->setSize(QSizeF(200, 200));
+    item->setModel(model);
+    window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(window));
+}
+
+void TestGraphItem::cleanup()
+{
+    delete window;
+    delete model;
+}
+
+void TestGraphItem::testFitsAndDrawsGraph()
+{
+    // Fitted: both nodes inside the item, the graph centred
+    QPointF right = toItem(QPointF(200, 0));
+    QPointF left = toItem(QPointF(-200, 0));
+    QVERIFY(right.x() < item->width() && left.x() > 0);
+    QCOMPARE((right + left) / 2, QPointF(100, 100));
+
+    QVERIFY(isNodeColor(right));
+    QVERIFY(isNodeColor(left));
+    QVERIFY(!isNodeColor(QPointF(100, 40)));
+}
+
+void TestGraphItem::testPanMovesDrawing()
+{
+    QPointF before = toItem(QPointF(-200, 0));
+    item->setPan(item->pan() + QPointF(0, 50));
+    QPointF after = toItem(QPointF(-200, 0));
+    QCOMPARE(after, before + QPointF(0, 50));
+
+    QVERIFY(isNodeColor(after));
+    QVERIFY(!isNodeColor(before));
+}
+
+void TestGraphItem::testWheelZoomsAroundCursor()
+{
+    const QPointF cursor(150, 120);
+    const QPointF anchor = (cursor - item->pan()) / item->zoom();
+    const qreal zoom = item->zoom();
+
+    QWheelEvent event(cursor, window->mapToGlobal(cursor), QPoint(), QPoint(0, 120),
+                      Qt::NoButton, Qt::NoModifier, Qt::NoScrollPhase, false);
+    QGuiApplication::sendEvent(window, &event);
+
+    QVERIFY(item->zoom() > zoom);
+    QVERIFY(qAbs(toItem(anchor).x() - cursor.x()) < 1e-6);
+    QVERIFY(qAbs(toItem(anchor).y() - cursor.y()) < 1e-6);
+
+    // Once the user navigated, a resize no longer refits the graph
+    const qreal zoomed = item->zoom();
+    item->setSize(QSizeF(150, 150));
+    QCOMPARE(item->zoom(), zoomed);
+}
+
+void TestGraphItem::testDetailLevelFollowsZoom()
+{
+    QCOMPARE(item->detailLevel(), 0);
+
+    // Zoomed out until the two nodes are under a pixel apart: one super-node
+    QSignalSpy spy(item, &GraphItem::detailLevelChanged);
+    item->setZoom(item->zoom() / 1000);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(item->detailLevel() > 0);
+
+    const QVariantList items = model->viewportItems(QRectF(-1000, -1000, 2000, 2000), item->zoom());
+    QCOMPARE(items.size(), 1);
+    QCOMPARE(items[0].toMap()["count"].toInt(), 2);
+    QCOMPARE(model->nodesInRect(QRectF(100, -10, 200, 20)), QList<int>{0});
+
+    item->setZoom(item->zoom() * 1000);
+    QCOMPARE(item->detailLevel(), 0);
+    QVERIFY(isNodeColor(toItem(QPointF(200, 0))));
+}
+
+int main(int argc, char* argv[])
+{
+    // Software renderer on the offscreen platform: no GPU or display needed
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    QGuiApplication app(argc, argv);
+    TestGraphItem test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_graph_item.moc"
@@ -0,0 +1,211 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "graph_layout.h"
+
+using tla_visualiser::GraphLayout;
+
+class TestGraphLayout : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testEmptyAndSingle();
+    void testEdgesPullNeighboursTogether();
+    void testCoincidentNodesSeparate();
+    void testWarmStartKeepsExistingNodes();
+    void testRefinePinsUntouchedNodes();
+    void testThreadCountDoesNotChangeResult();
+    void testLayeredDepths();
+    void testLayeredSweepsReduceCrossings();
+    void testCircular();
+};
+
+static double distance(const GraphLayout::Point& a, const GraphLayout::Point& b)
+{
+    return std::hypot(a.first - b.first, a.second - b.second);
+}
+
+// Chain of `count` nodes: 0 - 1 - 2 - ...
+static std::vector<GraphLayout::Edge> chain(uint32_t count)
+{
+    std::vector<GraphLayout::Edge> edges;
+    for (uint32_t i = 1; i < count; ++i) edges.push_back({i - 1, i});
+    return edges;
+}
+
+void TestGraphLayout::testEmptyAndSingle()
+{
+    std::vector<GraphLayout::Point> positions;
+    GraphLayout::forceDirected(0, {}, positions);
+    QVERIFY(positions.empty());
+
+    GraphLayout::forceDirected(1, {}, positions);
+    QCOMPARE(positions.size(), size_t(1));
+    QVERIFY(std::isfinite(positions[0].first) && std::isfinite(positions[0].second));
+}
+
+void TestGraphLayout::testEdgesPullNeighboursTogether()
+{
+    const uint32_t count = 200;
+    std::vector<GraphLayout::Point> positions;
+    GraphLayout::forceDirected(count, chain(count), positions);
+
+    double neighbours = 0, others = 0;
+    for (uint32_t i = 1; i < count; ++i) neighbours += distance(positions[i - 1], positions[i]);
+    for (uint32_t i = 0; i + count / 2 < count; ++i) others += distance(positions[i], positions[i + count / 2]);
+    neighbours /= count - 1;
+    others /= count / 2;
+    QVERIFY2(neighbours * 3 < others, "chain neighbours should sit much closer than distant nodes");
+}
+
+void TestGraphLayout::testCoincidentNodesSeparate()
+{
+    std::vector<GraphLayout::Point> positions(50, {10.0, 10.0});
+    GraphLayout::forceDirected(50, {}, positions);
+    for (std::size_t i = 1; i < positions.size(); ++i) {
+        QVERIFY(distance(positions[0], positions[i]) > 1.0);
+    }
+}
+
+void TestGraphLayout::testWarmStartKeepsExistingNodes()
+{
+    const uint32_t count = 300;
+    std::vector<GraphLayout::Point> positions;
+    GraphLayout::forceDirected(count, chain(count), positions);
+    std::vector<GraphLayout::Point> before = positions;
+
+    GraphLayout::forceDirected(count + 1, chain(count + 1), positions);
+    QCOMPARE(positions.size(), size_t(count + 1));
+
+    // The new node starts next to its neighbour; existing nodes barely move
+    // relative to the size of the layout
+    GraphLayout::ForceOptions options;
+    QVERIFY(distance(positions[count], positions[count - 1]) < options.edge_length * 4);
+    double min_x = before[0].first, max_x = min_x, min_y = before[0].second, max_y = min_y;
+    for (const auto& [x, y] : before) {
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
+    double size = std::hypot(max_x - min_x, max_y - min_y);
+    double moved = 0;
+    for (uint32_t i = 0; i < count; ++i) moved += distance(before[i], positions[i]);
+    QVERIFY(moved / count < size * 0.05);
+}
+
+void TestGraphLayout::testRefinePinsUntouchedNodes()
+{
+    const uint32_t count = 300;
+    std::vector<GraphLayout::Point> positions;
+    GraphLayout::forceDirected(count, chain(count), positions);
+    const std::vector<GraphLayout::Point> before = positions;
+
+    // Two nodes hang off the end of the chain; its edges 0..count-2 are old
+    std::vector<uint32_t> moved;
+    GraphLayout::refine(count + 2, chain(count + 2), count - 1, positions, moved);
+    QCOMPARE(positions.size(), size_t(count + 2));
+    QCOMPARE(moved, std::vector<uint32_t>({count - 1, count, count + 1}));
+    for (uint32_t i = 0; i + 1 < count; ++i) {
+        QVERIFY(positions[i] == before[i]);
+    }
+    GraphLayout::ForceOptions options;
+    QVERIFY(distance(positions[count], positions[count - 1]) < options.edge_length * 4);
+    QVERIFY(distance(positions[count + 1], positions[count]) < options.edge_length * 4);
+
+    // Most of the graph new: a full layout
+    positions.resize(10);
+    GraphLayout::refine(count, chain(count), 9, positions, moved);
+    QCOMPARE(moved.size(), size_t(count));
+}
+
+void TestGraphLayout::testThreadCountDoesNotChangeResult()
+{
+    const uint32_t count = 6000;  // large enough to be split across threads
+    GraphLayout::ForceOptions options;
+    options.iterations = 5;
+
+    std::vector<GraphLayout::Point> serial, parallel;
+    options.threads = 1;
+    GraphLayout::forceDirected(count, chain(count), serial, options);
+    options.threads = 4;
+    GraphLayout::forceDirected(count, chain(count), parallel, options);
+    QVERIFY(serial == parallel);
+}
+
+void TestGraphLayout::testLayeredDepths()
+{
+    // 0 -> {1, 2} -> 3, and 3 -> 0 closes a cycle, so no node lacks
+    // incoming edges and the search starts from node 0
+    std::vector<GraphLayout::Edge> edges = {{0, 1}, {0, 2}, {1, 3}, {2, 3}, {3, 0}, {4, 4}};
+    std::vector<GraphLayout::Point> positions;
+    std::vector<int> depths;
+    GraphLayout::LayeredOptions options;
+    GraphLayout::layered(5, edges, positions, options, &depths);
+
+    QCOMPARE(depths, std::vector<int>({0, 1, 1, 2, 0}));
+    QCOMPARE(positions[3].second, 2 * options.layer_spacing);
+    QCOMPARE(positions[1].second, positions[2].second);
+    QCOMPARE(std::abs(positions[1].first - positions[2].first), options.node_spacing);
+}
+
+// Edge crossings between adjacent layers
+static int crossings(const std::vector<GraphLayout::Edge>& edges,
+                     const std::vector<GraphLayout::Point>& positions)
+{
+    std::vector<std::pair<GraphLayout::Point, GraphLayout::Point>> spans;
+    for (const auto& [from, to] : edges) {
+        auto a = positions[from], b = positions[to];
+        if (a.second > b.second) std::swap(a, b);
+        if (b.second > a.second) spans.push_back({a, b});
+    }
+    int count = 0;
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        for (std::size_t j = i + 1; j < spans.size(); ++j) {
+            const auto& [a1, b1] = spans[i];
+            const auto& [a2, b2] = spans[j];
+            if (a1.second != a2.second || b1.second != b2.second) continue;
+            if ((a1.first - a2.first) * (b1.first - b2.first) < 0) ++count;
+        }
+    }
+    return count;
+}
+
+void TestGraphLayout::testLayeredSweepsReduceCrossings()
+{
+    uint64_t seed = 7;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>(seed >> 33);
+    };
+    const uint32_t count = 300;
+    std::vector<GraphLayout::Edge> edges;
+    for (uint32_t i = 1; i < count; ++i) {
+        edges.push_back({next() % i, i});
+        edges.push_back({next() % i, i});
+    }
+
+    GraphLayout::LayeredOptions options;
+    std::vector<GraphLayout::Point> unsorted, swept;
+    options.sweeps = 0;
+    GraphLayout::layered(count, edges, unsorted, options);
+    options.sweeps = 4;
+    GraphLayout::layered(count, edges, swept, options);
+
+    QVERIFY(crossings(edges, swept) < crossings(edges, unsorted));
+}
+
+void TestGraphLayout::testCircular()
+{
+    std::vector<GraphLayout::Point> positions;
+    GraphLayout::circular(4, positions, 100.0);
+    QCOMPARE(positions.size(), size_t(4));
+    for (const auto& point : positions) {
+        QVERIFY(std::abs(std::hypot(point.first, point.second) - 100.0) < 1e-9);
+    }
+}
+
+QTEST_MAIN(TestGraphLayout)
+#include "test_graph_layout.moc"
@@ -0,0 +1,231 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "http_fetcher.h"
+#include "http_stand_in.h"
+
+using tla_visualiser::HttpFetcher;
+
+class TestHttpFetcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFetchAllConcurrently();
+    void testReusesConnections();
+    void testStreamsBody();
+    void testConditionalRequests();
+    void testErrors();
+    void testCancel();
+    void testEscapePath();
+};
+
+static std::map<std::string, std::string> numberedFiles(int count)
+{
+    std::map<std::string, std::string> routes;
+    for (int i = 0; i < count; ++i) {
+        routes["/file" + std::to_string(i) + ".tla"] = "MODULE " + std::to_string(i);
+    }
+    return routes;
+}
+
+static std::vector<HttpFetcher::Request> numberedRequests(const HttpStandIn& server, int count)
+{
+    std::vector<HttpFetcher::Request> requests;
+    for (int i = 0; i < count; ++i) {
+        requests.push_back({server.baseUrl() + "/file" + std::to_string(i) + ".tla", {}});
+    }
+    return requests;
+}
+
+void TestHttpFetcher::testFetchAllConcurrently()
+{
+    const int files = 12;
+    const int delay_ms = 300;
+    HttpStandIn server(numberedFiles(files), delay_ms);
+
+    HttpFetcher::Options options;
+    options.max_host_connections = 4;
+    HttpFetcher fetcher(options);
+
+    std::vector<std::size_t> progress;
+    QElapsedTimer timer;
+    timer.start();
+    auto responses = fetcher.fetchAll(numberedRequests(server, files),
+                                      [&progress](std::size_t done, std::size_t total) {
+                                          QCOMPARE(total, std::size_t(12));
+                                          progress.push_back(done);
+                                      });
+    const qint64 elapsed = timer.elapsed();
+
+    QCOMPARE(responses.size(), std::size_t(files));
+    for (int i = 0; i < files; ++i) {
+        QVERIFY(responses[i].ok());
+        QCOMPARE(responses[i].status, 200L);
+        QCOMPARE(responses[i].body, "MODULE " + std::to_string(i));
+    }
+    QCOMPARE(progress.size(), std::size_t(files));
+    QCOMPARE(progress.back(), std::size_t(files));
+
+    // Four at a time: three rounds of delays rather than twelve
+    QVERIFY2(elapsed < files * delay_ms / 2, qPrintable(QString::number(elapsed)));
+    QVERIFY(server.connections() <= 4);
+}
+
+void TestHttpFetcher::testReusesConnections()
+{
+    HttpStandIn server(numberedFiles(8));
+    HttpFetcher::Options options;
+    options.max_host_connections = 2;
+    HttpFetcher fetcher(options);
+
+    for (int round = 0; round < 3; ++round) {
+        for (const auto& response : fetcher.fetchAll(numberedRequests(server, 8))) {
+            QVERIFY(response.ok());
+        }
+    }
+    QCOMPARE(server.requests(), 24);
+    QVERIFY(server.connections() <= 2);
+
+    const HttpFetcher::Stats stats = fetcher.stats();
+    QCOMPARE(stats.requests, uint64_t(24));
+    QCOMPARE(stats.failures, uint64_t(0));
+    QCOMPARE(stats.connections, uint64_t(server.connections()));
+    QVERIFY(stats.bytes > 0);
+}
+
+void TestHttpFetcher::testStreamsBody()
+{
+    std::string large(4 << 20, 'x');
+    for (std::size_t i = 0; i < large.size(); i += 4096) large[i] = static_cast<char>('a' + i % 26);
+    HttpStandIn server({{"/large.json", large}});
+    HttpFetcher fetcher;
+
+    std::string received;
+    std::size_t chunks = 0;
+    HttpFetcher::Request request{server.baseUrl() + "/large.json", {}};
+    request.sink = [&](const char* data, std::size_t size) {
+        received.append(data, size);
+        ++chunks;
+        return true;
+    };
+    HttpFetcher::Response response = fetcher.get(request);
+    QVERIFY(response.ok());
+    QVERIFY(response.body.empty());
+    QVERIFY(received == large);
+    QVERIFY(chunks > 1);
+    QCOMPARE(fetcher.stats().bytes, uint64_t(large.size()));
+
+    // A sink that gives up ends the request early
+    std::size_t taken = 0;
+    request.sink = [&taken](const char*, std::size_t size) {
+        taken += size;
+        return false;
+    };
+    response = fetcher.get(request);
+    QVERIFY(!response.ok());
+    QCOMPARE(response.status, 200L);
+    QVERIFY(taken < large.size());
+
+    // The status still explains a failed request whose sink gave up
+    request.url = server.baseUrl() + "/missing.json";
+    QCOMPARE(fetcher.get(request).error, std::string("HTTP 404"));
+}
+
+void TestHttpFetcher::testConditionalRequests()
+{
+    HttpStandIn server({{"/Spec.tla", "---- MODULE Spec ----"}});
+    HttpFetcher fetcher;
+    const std::string url = server.baseUrl() + "/Spec.tla";
+
+    HttpFetcher::Response first = fetcher.get({url, {}});
+    QVERIFY(first.ok());
+    QVERIFY(!first.etag.empty());
+    QCOMPARE(first.last_modified, std::string("Wed, 21 Oct 2015 07:28:00 GMT"));
+
+    HttpFetcher::Response unchanged = fetcher.get({url, {"If-None-Match: " + first.etag}});
+    QVERIFY(unchanged.notModified());
+    QVERIFY(!unchanged.ok());
+    QVERIFY(unchanged.error.empty());
+    QVERIFY(unchanged.body.empty());
+    QCOMPARE(unchanged.etag, first.etag);
+    QCOMPARE(fetcher.stats().failures, uint64_t(0));
+
+    server.setRoute("/Spec.tla", "---- MODULE Spec2 ----");
+    HttpFetcher::Response changed = fetcher.get({url, {"If-None-Match: " + first.etag}});
+    QVERIFY(changed.ok());
+    QCOMPARE(changed.body, std::string("---- MODULE Spec2 ----"));
+    QVERIFY(changed.etag != first.etag);
+    QCOMPARE(server.notModified(), 1);
+}
+
+void TestHttpFetcher::testErrors()
+{
+    HttpStandIn server(numberedFiles(1));
+    HttpFetcher fetcher;
+
+    HttpFetcher::Response missing = fetcher.get({server.baseUrl() + "/nothing.tla", {}});
+    QVERIFY(!missing.ok());
+    QCOMPARE(missing.status, 404L);
+    QCOMPARE(missing.error, std::string("HTTP 404"));
+
+    // Nothing listens on port 1
+    HttpFetcher::Response refused = fetcher.get({"http://127.0.0.1:1/file0.tla", {}});
+    QVERIFY(!refused.ok());
+    QCOMPARE(refused.status, 0L);
+    QVERIFY(!refused.error.empty());
+
+    QVERIFY(fetcher.fetchAll({}).empty());
+    QCOMPARE(fetcher.stats().failures, uint64_t(2));
+}
+
+void TestHttpFetcher::testCancel()
+{
+    const int files = 8;
+    const int delay_ms = 2000;
+    HttpStandIn server(numberedFiles(files), delay_ms);
+    HttpFetcher::Options options;
+    options.max_in_flight = 4;
+    HttpFetcher fetcher(options);
+
+    // Set from another thread while the first four wait on the server
+    std::atomic<bool> cancel(false);
+    std::thread canceller([&cancel] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        cancel = true;
+    });
+    QElapsedTimer timer;
+    timer.start();
+    auto responses = fetcher.fetchAll(numberedRequests(server, files), {}, &cancel);
+    const qint64 elapsed = timer.elapsed();
+    canceller.join();
+
+    QCOMPARE(responses.size(), std::size_t(files));
+    for (const auto& response : responses) {
+        QVERIFY(!response.ok());
+        QCOMPARE(response.error, std::string("cancelled"));
+        QVERIFY(!response.url.empty());
+    }
+    QVERIFY2(elapsed < delay_ms / 2, qPrintable(QString::number(elapsed)));
+    QVERIFY(server.requests() <= 4);
+
+    // Already set: nothing is sent
+    const int sent = server.requests();
+    QCOMPARE(fetcher.get({server.baseUrl() + "/file0.tla", {}}, &cancel).error, std::string("cancelled"));
+    QCOMPARE(server.requests(), sent);
+}
+
+void TestHttpFetcher::testEscapePath()
+{
+    QCOMPARE(HttpFetcher::escapePath("specs/Two Phase.tla"), std::string("specs/Two%20Phase.tla"));
+    QCOMPARE(HttpFetcher::escapePath("a/b_c-d.e~f"), std::string("a/b_c-d.e~f"));
+    QCOMPARE(HttpFetcher::escapePath("q?x#y"), std::string("q%3Fx%23y"));
+}
+
+QTEST_MAIN(TestHttpFetcher)
+#include "test_http_fetcher.moc"
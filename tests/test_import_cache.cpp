@@ -0,0 +1,215 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <filesystem>
+#include <string>
+#include "import_cache.h"
+
+using tla_visualiser::ImportCache;
+
+class TestImportCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testBlobSha();
+    void testStoreAndRead();
+    void testIndex();
+    void testEvictsLeastRecentlyUsed();
+    void testSurvivesReopen();
+    void testTornIndex();
+    void testValidatorsAndListing();
+};
+
+static ImportCache::Location at(const std::string& ref, const std::string& path)
+{
+    return {"owner", "repo", ref, path};
+}
+
+void TestImportCache::testBlobSha()
+{
+    // As `git hash-object` reports them
+    QCOMPARE(ImportCache::blobSha(""), std::string("e69de29bb2d1d6434b8b29ae775ad8c2e48c5391"));
+    QCOMPARE(ImportCache::blobSha("hello\n"), std::string("ce013625030ba8dba906f756967f9e9ca394464a"));
+}
+
+void TestImportCache::testStoreAndRead()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ImportCache cache(dir.path().toStdString());
+
+    const std::string spec = "---- MODULE Spec ----\n====\n";
+    const std::string sha = cache.store(spec);
+    QCOMPARE(sha, ImportCache::blobSha(spec));
+    QVERIFY(cache.contains(sha));
+
+    std::string content;
+    QVERIFY(cache.read(sha, content));
+    QCOMPARE(content, spec);
+
+    // The same content is kept once
+    QCOMPARE(cache.store(spec), sha);
+    QCOMPARE(cache.stats().blobs, std::size_t(1));
+    QCOMPARE(cache.stats().stores, uint64_t(1));
+    QCOMPARE(cache.stats().bytes, uint64_t(spec.size()));
+
+    // SHAs name files: anything else is a miss
+    QVERIFY(!cache.read("../index", content));
+    QVERIFY(!cache.read(ImportCache::blobSha("other"), content));
+    QCOMPARE(cache.stats().hits, uint64_t(1));
+    QCOMPARE(cache.stats().misses, uint64_t(2));
+}
+
+void TestImportCache::testIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ImportCache cache(dir.path().toStdString());
+
+    const std::string v1 = cache.store("VARIABLE x");
+    const std::string v2 = cache.store("VARIABLES x, y");
+    cache.record(at("main", "Spec.tla"), v1);
+    cache.record(at("dev", "Spec.tla"), v1);
+    cache.record({"fork", "repo", "main", "Spec.tla"}, v1);
+    QCOMPARE(cache.resolve(at("main", "Spec.tla")), v1);
+    QCOMPARE(cache.resolve(at("dev", "Spec.tla")), v1);
+    QCOMPARE(cache.stats().blobs, std::size_t(2));
+    QCOMPARE(cache.stats().locations, std::size_t(3));
+
+    // The branch moves on
+    cache.record(at("main", "Spec.tla"), v2);
+    QCOMPARE(cache.resolve(at("main", "Spec.tla")), v2);
+    QCOMPARE(cache.resolve(at("dev", "Spec.tla")), v1);
+
+    // Fields cannot run into each other
+    QVERIFY(cache.resolve({"owner", "repo", "main/Spec.tla", ""}).empty());
+    QVERIFY(cache.resolve(at("main", "Other.tla")).empty());
+
+    // Only SHAs of stored content are meaningful; a missing blob resolves to nothing
+    cache.record(at("main", "Bad.tla"), "not a sha");
+    QVERIFY(cache.resolve(at("main", "Bad.tla")).empty());
+    cache.record(at("main", "Gone.tla"), ImportCache::blobSha("never stored"));
+    QVERIFY(cache.resolve(at("main", "Gone.tla")).empty());
+}
+
+void TestImportCache::testEvictsLeastRecentlyUsed()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const std::string a(1000, 'a'), b(1000, 'b'), c(1000, 'c');
+
+    // Room for two blobs
+    ImportCache cache(dir.path().toStdString(), 2500);
+    const std::string sha_a = cache.store(a);
+    const std::string sha_b = cache.store(b);
+    cache.record(at("main", "B.tla"), sha_b);
+    std::string content;
+    QVERIFY(cache.read(sha_a, content));   // b is now the oldest
+    const std::string sha_c = cache.store(c);
+
+    QVERIFY(cache.contains(sha_a));
+    QVERIFY(!cache.contains(sha_b));
+    QVERIFY(cache.contains(sha_c));
+    QVERIFY(cache.resolve(at("main", "B.tla")).empty());
+    QCOMPARE(cache.stats().evictions, uint64_t(1));
+    QCOMPARE(cache.stats().bytes, uint64_t(2000));
+
+    // Larger than the whole budget: not stored
+    QVERIFY(cache.store(std::string(3000, 'd')).empty());
+}
+
+void TestImportCache::testSurvivesReopen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::string sha;
+    {
+        ImportCache cache(dir.path().toStdString());
+        sha = cache.store("---- MODULE A ----");
+        cache.record(at("main", "A.tla"), ImportCache::blobSha("old"));
+        for (int i = 0; i < 100; ++i) {
+            cache.record(at("main", "A.tla"), i % 2 ? sha : ImportCache::blobSha("old"));
+        }
+        cache.record(at("main", "A.tla"), sha);
+    }
+    const auto index_path = std::filesystem::path(dir.path().toStdString()) / "index";
+    const auto logged = std::filesystem::file_size(index_path);
+
+    ImportCache reopened(dir.path().toStdString());
+    QCOMPARE(reopened.resolve(at("main", "A.tla")), sha);
+    QCOMPARE(reopened.stats().blobs, std::size_t(1));
+    QCOMPARE(reopened.stats().locations, std::size_t(1));
+
+    // Superseded records were dropped when it was reopened
+    QVERIFY(std::filesystem::file_size(index_path) < logged / 10);
+
+    reopened.clear();
+    QCOMPARE(reopened.stats().blobs, std::size_t(0));
+    QVERIFY(reopened.resolve(at("main", "A.tla")).empty());
+}
+
+void TestImportCache::testTornIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::string sha_a, sha_b;
+    {
+        ImportCache cache(dir.path().toStdString());
+        sha_a = cache.store("A");
+        sha_b = cache.store("B");
+        cache.record(at("main", "A.tla"), sha_a);
+        cache.record(at("main", "B.tla"), sha_b);
+    }
+
+    // A crash in the middle of the last record
+    const auto index_path = std::filesystem::path(dir.path().toStdString()) / "index";
+    std::filesystem::resize_file(index_path, std::filesystem::file_size(index_path) - 5);
+
+    ImportCache reopened(dir.path().toStdString());
+    QCOMPARE(reopened.resolve(at("main", "A.tla")), sha_a);
+    QVERIFY(reopened.resolve(at("main", "B.tla")).empty());
+    reopened.record(at("main", "B.tla"), sha_b);
+
+    ImportCache again(dir.path().toStdString());
+    QCOMPARE(again.resolve(at("main", "B.tla")), sha_b);
+    QCOMPARE(again.stats().locations, std::size_t(2));
+}
+
+void TestImportCache::testValidatorsAndListing()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::string v1, v2;
+    {
+        ImportCache cache(dir.path().toStdString());
+        v1 = cache.store("one");
+        v2 = cache.store("two");
+        cache.record(at("main", "B.tla"), v1, {"\"e1\"", "Wed, 21 Oct 2015 07:28:00 GMT"});
+        cache.record(at("main", "A.cfg"), v2);
+        cache.record(at("dev", "C.tla"), v2);
+
+        // Recording the same blob without validators keeps them
+        cache.record(at("main", "B.tla"), v1);
+        QCOMPARE(cache.validators(at("main", "B.tla")).etag, std::string("\"e1\""));
+        QVERIFY(cache.validators(at("main", "A.cfg")).empty());
+    }
+
+    ImportCache reopened(dir.path().toStdString());
+    const ImportCache::Validators validators = reopened.validators(at("main", "B.tla"));
+    QCOMPARE(validators.etag, std::string("\"e1\""));
+    QCOMPARE(validators.last_modified, std::string("Wed, 21 Oct 2015 07:28:00 GMT"));
+
+    const auto files = reopened.files("owner", "repo", "main");
+    QCOMPARE(files.size(), std::size_t(2));
+    QCOMPARE(files[0].first, std::string("A.cfg"));
+    QCOMPARE(files[0].second, v2);
+    QCOMPARE(files[1].first, std::string("B.tla"));
+    QVERIFY(reopened.files("owner", "repo", "mai").empty());
+
+    // Another blob at the location drops the old validators
+    reopened.record(at("main", "B.tla"), v2);
+    QVERIFY(reopened.validators(at("main", "B.tla")).empty());
+}
+
+QTEST_MAIN(TestImportCache)
+#include "test_import_cache.moc"
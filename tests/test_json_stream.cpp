@@ -0,0 +1,137 @@
+#include <QtTest/QtTest>
+#include <string>
+#include <vector>
+#include "json_stream.h"
+
+using tla_visualiser::JsonStreamParser;
+
+class TestJsonStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testEvents();
+    void testEveryChunking();
+    void testEscapes();
+    void testScalarDocuments();
+    void testMalformed();
+    void testTokenLimit();
+};
+
+// Records events as one line each
+class Recorder : public JsonStreamParser::Handler {
+public:
+    std::vector<std::string> events;
+
+    void startObject() override { events.push_back("{"); }
+    void endObject() override { events.push_back("}"); }
+    void startArray() override { events.push_back("["); }
+    void endArray() override { events.push_back("]"); }
+    void key(std::string_view name) override { events.push_back("key " + std::string(name)); }
+    void string(std::string_view value) override { events.push_back("string " + std::string(value)); }
+    void number(std::string_view text) override { events.push_back("number " + std::string(text)); }
+    void boolean(bool value) override { events.push_back(value ? "true" : "false"); }
+    void null() override { events.push_back("null"); }
+};
+
+static std::vector<std::string> parse(const std::string& document, std::size_t chunk = 0)
+{
+    Recorder recorder;
+    JsonStreamParser parser(recorder);
+    if (chunk == 0) chunk = document.size() ? document.size() : 1;
+    for (std::size_t at = 0; at < document.size(); at += chunk) {
+        if (!parser.feed(document.data() + at, std::min(chunk, document.size() - at))) break;
+    }
+    if (!parser.finish()) recorder.events.push_back("error");
+    return recorder.events;
+}
+
+static bool accepts(const std::string& document)
+{
+    auto events = parse(document);
+    return events.empty() || events.back() != "error";
+}
+
+void TestJsonStream::testEvents()
+{
+    const std::vector<std::string> expected = {
+        "{", "key sha", "string t0",
+        "key tree", "[",
+        "{", "key path", "string a.tla", "key size", "number 12", "}",
+        "{", "key path", "string b", "key size", "number -0.5e+3", "}",
+        "]",
+        "key truncated", "false", "key extra", "[", "null", "true", "[", "]", "{", "}", "]",
+        "}"};
+    QCOMPARE(parse(R"({"sha":"t0","tree":[{"path":"a.tla","size":12},)"
+                   R"( {"path" : "b", "size" : -0.5e+3 }],)"
+                   "\n\t\"truncated\": false, \"extra\": [null, true, [], {}]}\r\n"),
+             expected);
+}
+
+void TestJsonStream::testEveryChunking()
+{
+    // Tokens, escapes and surrogate pairs split at every possible point
+    const std::string document =
+        R"({"name": "café 😀 \"q\"", "n": [0, 1.25, -3e2, 42], "ok": true, "none": null})";
+    const auto whole = parse(document);
+    QCOMPARE(whole.back(), std::string("}"));
+    for (std::size_t chunk = 1; chunk < document.size(); ++chunk) {
+        QCOMPARE(parse(document, chunk), whole);
+    }
+}
+
+void TestJsonStream::testEscapes()
+{
+    QCOMPARE(parse(R"(["a\nb\t\\\/\"", "Aé€", "😀"])"),
+             (std::vector<std::string>{"[", "string a\nb\t\\/\"", "string A\xC3\xA9\xE2\x82\xAC",
+                                       "string \xF0\x9F\x98\x80", "]"}));
+
+    // Lone surrogates become U+FFFD
+    QCOMPARE(parse(R"(["\ud83dx", "\ude00", "\ud83d\n"])"),
+             (std::vector<std::string>{"[", "string \xEF\xBF\xBDx", "string \xEF\xBF\xBD",
+                                       "string \xEF\xBF\xBD\n", "]"}));
+
+    QVERIFY(!accepts(R"(["\x"])"));
+    QVERIFY(!accepts(R"(["\u12G4"])"));
+    QVERIFY(!accepts("[\"a\nb\"]"));
+}
+
+void TestJsonStream::testScalarDocuments()
+{
+    QCOMPARE(parse("42"), std::vector<std::string>{"number 42"});
+    QCOMPARE(parse(" null "), std::vector<std::string>{"null"});
+    QCOMPARE(parse("\"x\""), std::vector<std::string>{"string x"});
+    QCOMPARE(parse("-0.0", 1), std::vector<std::string>{"number -0.0"});
+}
+
+void TestJsonStream::testMalformed()
+{
+    for (const char* document : {"", "   ", "{", "[1,]", "[1 2]", "{\"a\"}", "{\"a\":}", "{\"a\":1,}",
+                                 "{1:2}", "[}", "{]", "01", "1.", "-", "1e", "+1", "tru", "nul",
+                                 "truex", "[1] 2", "{} {}", "'a'", "[\"open"}) {
+        QVERIFY2(!accepts(document), document);
+    }
+
+    Recorder recorder;
+    JsonStreamParser parser(recorder);
+    const std::string document = "{\"a\": [1, 2 3]}";
+    QVERIFY(!parser.feed(document.data(), document.size()));
+    QVERIFY(parser.failed());
+    QCOMPARE(parser.error(), std::string("expected ',' or a closing bracket at byte 12"));
+    QVERIFY(!parser.feed("]", 1));
+    QVERIFY(!parser.finish());
+}
+
+void TestJsonStream::testTokenLimit()
+{
+    Recorder recorder;
+    JsonStreamParser parser(recorder, 8);
+    QVERIFY(parser.feed("[\"12345", 7));
+    QCOMPARE(parser.bufferedBytes(), std::size_t(5));
+    QVERIFY(parser.feed("678\"", 4));
+    QVERIFY(!parser.feed(",\"123456789\"]", 13));
+    QCOMPARE(recorder.events, (std::vector<std::string>{"[", "string 12345678"}));
+}
+
+QTEST_MAIN(TestJsonStream)
+#include "test_json_stream.moc"
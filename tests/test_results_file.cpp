@@ -0,0 +1,160 @@
+#include <QtTest/QtTest>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "results_file.h"
+
+using tla_visualiser::StateStore;
+using tla_visualiser::TLCRunner;
+namespace results_file = tla_visualiser::results_file;
+
+class TestResultsFile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip();
+    void testStatesAreZeroCopy();
+    void testAppendAfterMap();
+    void testRejectsMalformed();
+};
+
+using Variables = std::vector<std::pair<std::string, std::string>>;
+
+// Mapped files are page aligned; copy into 8-byte aligned storage the same way
+static std::shared_ptr<std::vector<uint64_t>> aligned(const std::string& bytes)
+{
+    auto buffer = std::make_shared<std::vector<uint64_t>>((bytes.size() + 7) / 8);
+    if (!bytes.empty()) std::memcpy(buffer->data(), bytes.data(), bytes.size());
+    return buffer;
+}
+
+static std::string serialize(const TLCRunner::RunResults& results)
+{
+    std::stringstream out;
+    if (!results_file::write(out, results)) return std::string();
+    return out.str();
+}
+
+static TLCRunner::RunResults sampleResults()
+{
+    TLCRunner::RunResults results{};
+    results.status = TLCRunner::Status::Failed;
+    results.states_generated = 12;
+    results.distinct_states = 3;
+    results.execution_time_seconds = 1.5;
+    results.error_message = "Invariant CounterBound is violated.";
+    results.states.add(0, "Initial predicate", Variables{{"count", "0"}, {"log", "<<>>"}});
+    results.states.add(1, "Increment", Variables{{"count", "1"}, {"log", "<<\"inc\",\n  \"inc\">>"}});
+    results.states.add(2, "Reset", Variables{{"count", "0"}});
+    results.transitions = {{0, 1, "Increment"}, {1, 2, "Reset"}, {0, 2, "Reset"}, {7, 0, "Unknown"}};
+    results.invariants = {{"CounterBound", false, "violated", 1}, {"TypeOK", true, "", -1}};
+    results.counterexamples = {{{0, 1, 2}, "Invariant CounterBound is violated."}};
+    return results;
+}
+
+void TestResultsFile::testRoundTrip()
+{
+    std::string bytes = serialize(sampleResults());
+    QVERIFY(results_file::isResultsFile(bytes));
+
+    auto buffer = aligned(bytes);
+    TLCRunner::RunResults loaded{};
+    QVERIFY(results_file::read(std::string_view(reinterpret_cast<const char*>(buffer->data()), bytes.size()),
+                               buffer, loaded));
+
+    QCOMPARE(loaded.status, TLCRunner::Status::Failed);
+    QCOMPARE(loaded.states_generated, 12);
+    QCOMPARE(loaded.distinct_states, 3);
+    QCOMPARE(loaded.execution_time_seconds, 1.5);
+    QCOMPARE(loaded.error_message, std::string("Invariant CounterBound is violated."));
+
+    QCOMPARE(loaded.states.size(), size_t(3));
+    QCOMPARE(loaded.states.description(1), std::string_view("Increment"));
+    QCOMPARE(loaded.states.value(1, 1), std::string_view("<<\"inc\",\n  \"inc\">>"));
+    QCOMPARE(loaded.states.value(2, 1), std::string_view());
+    QCOMPARE(loaded.states.findVariable("log"), 1);
+
+    // Transitions come back grouped by source state
+    QCOMPARE(loaded.transitions.size(), size_t(4));
+    QCOMPARE(loaded.transitions[0].to_state, 1);
+    QCOMPARE(loaded.transitions[1].from_state, 0);
+    QCOMPARE(loaded.transitions[1].action, std::string("Reset"));
+    QCOMPARE(loaded.transitions[2].from_state, 1);
+    QCOMPARE(loaded.transitions[3].from_state, 7);
+    QCOMPARE(loaded.transitions[3].action, std::string("Unknown"));
+
+    QCOMPARE(loaded.invariants.size(), size_t(2));
+    QCOMPARE(loaded.invariants[0].name, std::string("CounterBound"));
+    QVERIFY(!loaded.invariants[0].passed);
+    QCOMPARE(loaded.invariants[0].error_state_id, 1);
+    QVERIFY(loaded.invariants[1].passed);
+
+    QCOMPARE(loaded.counterexamples.size(), size_t(1));
+    QCOMPARE(loaded.counterexamples[0].state_sequence, std::vector<int>({0, 1, 2}));
+}
+
+void TestResultsFile::testStatesAreZeroCopy()
+{
+    TLCRunner::RunResults results{};
+    const int count = static_cast<int>(StateStore::kBlockSize) * 2 + 5;
+    for (int i = 0; i < count; ++i) {
+        results.states.add(i, "Next", Variables{{"x", std::to_string(i)}});
+    }
+    std::string bytes = serialize(results);
+    auto buffer = aligned(bytes);
+    const char* begin = reinterpret_cast<const char*>(buffer->data());
+
+    TLCRunner::RunResults loaded{};
+    QVERIFY(results_file::read(std::string_view(begin, bytes.size()), buffer, loaded));
+    QCOMPARE(loaded.states.size(), size_t(count));
+
+    std::string_view last = loaded.states.value(count - 1, 0);
+    QCOMPARE(last, std::string_view(std::to_string(count - 1)));
+    QVERIFY(last.data() >= begin && last.data() < begin + bytes.size());
+
+    // The store keeps the backing alive after the caller lets go of it
+    std::weak_ptr<std::vector<uint64_t>> weak = buffer;
+    buffer.reset();
+    QVERIFY(!weak.expired());
+    loaded = TLCRunner::RunResults{};
+    QVERIFY(weak.expired());
+}
+
+void TestResultsFile::testAppendAfterMap()
+{
+    std::string bytes = serialize(sampleResults());
+    auto buffer = aligned(bytes);
+    TLCRunner::RunResults loaded{};
+    QVERIFY(results_file::read(std::string_view(reinterpret_cast<const char*>(buffer->data()), bytes.size()),
+                               buffer, loaded));
+
+    loaded.states.add(3, "Increment", Variables{{"count", "2"}});
+    QCOMPARE(loaded.states.size(), size_t(4));
+    QCOMPARE(loaded.states.value(3, 0), std::string_view("2"));
+    QCOMPARE(loaded.states.description(3), std::string_view("Increment"));
+    QCOMPARE(loaded.states.value(0, 0), std::string_view("0"));
+}
+
+void TestResultsFile::testRejectsMalformed()
+{
+    std::string bytes = serialize(sampleResults());
+    TLCRunner::RunResults loaded{};
+    loaded.error_message = "untouched";
+
+    // Every truncation into section data must be rejected without reading
+    // out of bounds (the last few bytes are alignment padding)
+    for (std::size_t size = 0; size + 8 < bytes.size(); size += 7) {
+        auto buffer = aligned(bytes.substr(0, size));
+        QVERIFY(!results_file::read(std::string_view(reinterpret_cast<const char*>(buffer->data()), size),
+                                    buffer, loaded));
+    }
+    QCOMPARE(loaded.error_message, std::string("untouched"));
+
+    QVERIFY(!results_file::isResultsFile("Status: 2\nStates: 10\n"));
+}
+
+QTEST_MAIN(TestResultsFile)
+#include "test_results_file.moc"
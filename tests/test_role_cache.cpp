@@ -0,0 +1,80 @@
+#include <QtTest/QtTest>
+#include <QVariantList>
+#include "role_cache.h"
+
+using tla_visualiser::RoleCache;
+
+class TestRoleCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testBuildsOncePerRowAndRole();
+    void testHitSharesData();
+    void testEvictsLeastRecentlyUsed();
+    void testClear();
+};
+
+void TestRoleCache::testBuildsOncePerRowAndRole()
+{
+    RoleCache cache;
+    int builds = 0;
+    auto build = [&builds] { ++builds; return QVariant(QStringLiteral("value")); };
+
+    for (int pass = 0; pass < 3; ++pass) {
+        QCOMPARE(cache.value(7, 1, build).toString(), QStringLiteral("value"));
+        cache.value(7, 2, build);
+        cache.value(8, 1, build);
+    }
+    QCOMPARE(builds, 3);
+    QCOMPARE(cache.size(), qsizetype(3));
+}
+
+void TestRoleCache::testHitSharesData()
+{
+    RoleCache cache;
+    auto build = [] {
+        QVariantList vars;
+        vars.append(QStringLiteral("x"));
+        vars.append(QStringLiteral("y"));
+        return QVariant(vars);
+    };
+
+    const QVariantList first = cache.value(0, 1, build).toList();
+    const QVariantList second = cache.value(0, 1, build).toList();
+    QCOMPARE(second, first);
+    QCOMPARE(second.constData(), first.constData());
+}
+
+void TestRoleCache::testEvictsLeastRecentlyUsed()
+{
+    RoleCache cache(2);
+    int builds = 0;
+    auto build = [&builds] { ++builds; return QVariant(builds); };
+
+    cache.value(0, 1, build);
+    cache.value(1, 1, build);
+    cache.value(0, 1, build);   // row 0 is now the most recent
+    cache.value(2, 1, build);   // evicts row 1
+    QCOMPARE(builds, 3);
+
+    QCOMPARE(cache.value(0, 1, build).toInt(), 1);
+    QCOMPARE(builds, 3);
+    cache.value(1, 1, build);
+    QCOMPARE(builds, 4);
+}
+
+void TestRoleCache::testClear()
+{
+    RoleCache cache;
+    int builds = 0;
+    auto build = [&builds] { ++builds; return QVariant(builds); };
+
+    cache.value(0, 1, build);
+    cache.clear();
+    QCOMPARE(cache.size(), qsizetype(0));
+    QCOMPARE(cache.value(0, 1, build).toInt(), 2);
+}
+
+QTEST_MAIN(TestRoleCache)
+#include "test_role_cache.moc"
@@ -0,0 +1,195 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "run_cache.h"
+
+using tla_visualiser::RunCache;
+using tla_visualiser::TLCOptions;
+using tla_visualiser::TLCRunner;
+
+class TestRunCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testKeyTracksInputs();
+    void testKeyTracksImplicitConfig();
+    void testStoreAndLookup();
+    void testEvictsLeastRecentlyUsed();
+    void testEntriesSurviveReopen();
+};
+
+using Variables = std::vector<std::pair<std::string, std::string>>;
+
+static void writeFile(const QTemporaryDir& dir, const char* name, const std::string& contents)
+{
+    std::ofstream out(dir.filePath(name).toStdString(), std::ios::binary | std::ios::trunc);
+    out << contents;
+}
+
+static TLCRunner::RunResults sampleResults(int states)
+{
+    TLCRunner::RunResults results{};
+    results.status = TLCRunner::Status::Completed;
+    results.states_generated = states * 2;
+    results.distinct_states = states;
+    for (int i = 0; i < states; ++i) {
+        results.states.add(i, "Next", Variables{{"counter", std::to_string(i)}});
+        if (i > 0) results.transitions.push_back({i - 1, i, "Next"});
+    }
+    return results;
+}
+
+void TestRunCache::testKeyTracksInputs()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir, "Spec.tla", "---- MODULE Spec ----\nEXTENDS Naturals, Helper\nInit == x = 0\n====\n");
+    writeFile(dir, "Helper.tla", "---- MODULE Helper ----\nEXTENDS Inner\n====\n");
+    writeFile(dir, "Inner.tla", "---- MODULE Inner ----\nLimit == 3\n====\n");
+    writeFile(dir, "Spec.cfg", "INIT Init\n");
+    const std::string spec = dir.filePath("Spec.tla").toStdString();
+    const std::string config = dir.filePath("Spec.cfg").toStdString();
+
+    RunCache cache(dir.filePath("cache").toStdString());
+    TLCOptions options;
+    const std::string base = cache.key(spec, config, options);
+    QCOMPARE(base.size(), std::size_t(64));
+    QCOMPARE(cache.key(spec, config, options), base);
+
+    // Resources do not change what TLC finds
+    TLCOptions tuned = options;
+    tuned.workers = 16;
+    tuned.heap_mb = 8192;
+    tuned.checkpoint_minutes = 0;
+    QCOMPARE(cache.key(spec, config, tuned), base);
+
+    TLCOptions deadlock = options;
+    deadlock.tlc_args = {"-deadlock"};
+    QVERIFY(cache.key(spec, config, deadlock) != base);
+    // Without a config TLC reads Spec.cfg from beside the spec: the same run
+    QCOMPARE(cache.key(spec, "", options), base);
+
+    // A module two EXTENDS away
+    writeFile(dir, "Inner.tla", "---- MODULE Inner ----\nLimit == 4\n====\n");
+    const std::string changed = cache.key(spec, config, options);
+    QVERIFY(changed != base);
+
+    writeFile(dir, "Spec.cfg", "INIT Init\nINVARIANT TypeOK\n");
+    QVERIFY(cache.key(spec, config, options) != changed);
+
+    // Not cacheable
+    TLCOptions recover = options;
+    recover.recover = "states/checkpoint";
+    QVERIFY(cache.key(spec, config, recover).empty());
+    QVERIFY(cache.key(dir.filePath("Missing.tla").toStdString(), config, options).empty());
+}
+
+void TestRunCache::testKeyTracksImplicitConfig()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir, "SimpleCounter.tla", "---- MODULE SimpleCounter ----\nInit == x = 0\n====\n");
+    writeFile(dir, "SimpleCounter.cfg", "INIT Init\n");
+    const std::string spec = dir.filePath("SimpleCounter.tla").toStdString();
+
+    RunCache cache(dir.filePath("cache").toStdString());
+    const std::string key = cache.key(spec, "", TLCOptions());
+    QVERIFY(cache.store(key, sampleResults(3)));
+    QVERIFY(cache.lookup(key));
+
+    // Editing the config TLC picks up on its own is a different run
+    writeFile(dir, "SimpleCounter.cfg", "INIT Init\nINVARIANT TypeOK\n");
+    const std::string edited = cache.key(spec, "", TLCOptions());
+    QVERIFY(edited != key);
+    QVERIFY(!cache.lookup(edited));
+
+    // A config that cannot be found is dropped, leaving the implicit one
+    QCOMPARE(cache.key(spec, dir.filePath("Missing.cfg").toStdString(), TLCOptions()), edited);
+}
+
+void TestRunCache::testStoreAndLookup()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    RunCache cache(dir.path().toStdString());
+    const std::string key(64, 'a');
+
+    QVERIFY(!cache.lookup(key));
+    QVERIFY(cache.store(key, sampleResults(10)));
+
+    auto hit = cache.lookup(key);
+    QVERIFY(hit);
+    QCOMPARE(hit->distinct_states, 10);
+    QCOMPARE(hit->states.size(), std::size_t(10));
+    QCOMPARE(hit->states.value(9, 0), std::string_view("9"));
+    QCOMPARE(hit->transitions.size(), std::size_t(9));
+    QVERIFY(hit->index);
+
+    // Keys are file names: anything else is a miss
+    QVERIFY(!cache.store("../escape", sampleResults(1)));
+    QVERIFY(!cache.lookup("../escape"));
+
+    const RunCache::Stats stats = cache.stats();
+    QCOMPARE(stats.hits, uint64_t(1));
+    QCOMPARE(stats.misses, uint64_t(2));
+    QCOMPARE(stats.stores, uint64_t(1));
+    QCOMPARE(stats.entries, std::size_t(1));
+    QVERIFY(stats.bytes > 0);
+}
+
+void TestRunCache::testEvictsLeastRecentlyUsed()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    uint64_t entry_bytes = 0;
+    {
+        RunCache probe(dir.filePath("probe").toStdString());
+        QVERIFY(probe.store(std::string(64, '0'), sampleResults(100)));
+        entry_bytes = probe.stats().bytes;
+    }
+
+    // Room for two entries
+    RunCache cache(dir.filePath("cache").toStdString(), entry_bytes * 2 + entry_bytes / 2);
+    const std::string a(64, 'a'), b(64, 'b'), c(64, 'c');
+    QVERIFY(cache.store(a, sampleResults(100)));
+    QVERIFY(cache.store(b, sampleResults(100)));
+    QVERIFY(cache.lookup(a));   // b is now the oldest
+    QVERIFY(cache.store(c, sampleResults(100)));
+
+    QVERIFY(cache.lookup(a));
+    QVERIFY(!cache.lookup(b));
+    QVERIFY(cache.lookup(c));
+    QCOMPARE(cache.stats().evictions, uint64_t(1));
+    QCOMPARE(cache.stats().entries, std::size_t(2));
+    QVERIFY(cache.stats().bytes <= entry_bytes * 2 + entry_bytes / 2);
+
+    // Larger than the whole budget: not stored
+    QVERIFY(!cache.store(std::string(64, 'd'), sampleResults(1000)));
+}
+
+void TestRunCache::testEntriesSurviveReopen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const std::string key(64, 'e');
+    {
+        RunCache cache(dir.path().toStdString());
+        QVERIFY(cache.store(key, sampleResults(5)));
+    }
+    RunCache reopened(dir.path().toStdString());
+    QCOMPARE(reopened.stats().entries, std::size_t(1));
+    auto hit = reopened.lookup(key);
+    QVERIFY(hit);
+    QCOMPARE(hit->states.size(), std::size_t(5));
+
+    reopened.clear();
+    QCOMPARE(reopened.stats().entries, std::size_t(0));
+    QVERIFY(!reopened.lookup(key));
+}
+
+QTEST_MAIN(TestRunCache)
+#include "test_run_cache.moc"
@@ -0,0 +1,74 @@
+#include <QtTest/QtTest>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "seqlock.h"
+
+using tla_visualiser::SeqLock;
+
+class TestSeqLock : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStoreAndLoad();
+    void testReadersSeeWholeValues();
+};
+
+namespace {
+
+// 24 bytes: spans several words, so a torn read would show
+struct Counters {
+    uint64_t a;
+    int32_t b;
+    double c;
+};
+
+} // namespace
+
+void TestSeqLock::testStoreAndLoad()
+{
+    SeqLock<Counters> lock;
+    QCOMPARE(lock.load().a, uint64_t(0));
+
+    lock.store({7, -3, 2.5});
+    const Counters value = lock.load();
+    QCOMPARE(value.a, uint64_t(7));
+    QCOMPARE(value.b, -3);
+    QCOMPARE(value.c, 2.5);
+}
+
+void TestSeqLock::testReadersSeeWholeValues()
+{
+    SeqLock<Counters> lock;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            uint64_t previous = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                const Counters value = lock.load();
+                if (value.b != static_cast<int32_t>(value.a % 1000) ||
+                    value.c != static_cast<double>(value.a) * 0.5 || value.a < previous) {
+                    torn.fetch_add(1);
+                }
+                previous = value.a;
+            }
+        });
+    }
+
+    for (uint64_t i = 1; i <= 200000; ++i) {
+        lock.store({i, static_cast<int32_t>(i % 1000), static_cast<double>(i) * 0.5});
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+
+    QCOMPARE(torn.load(), 0);
+    QCOMPARE(lock.load().a, uint64_t(200000));
+}
+
+QTEST_MAIN(TestSeqLock)
+#include "test_seqlock.moc"
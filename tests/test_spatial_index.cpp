@@ -0,0 +1,239 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "spatial_index.h"
+
+using tla_visualiser::SpatialIndex;
+
+class TestSpatialIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testEmpty();
+    void testQueryMatchesBruteForce();
+    void testLevelsMergeAllNodes();
+    void testLinksMergedAndWeighted();
+    void testLevelForScale();
+    void testUpdatedMatchesRebuild();
+    void testUpdatedOutsideBoundsRebuilds();
+};
+
+// Deterministic pseudo-random positions in [0, 1000)^2
+static std::vector<SpatialIndex::Point> scatter(std::size_t count)
+{
+    std::vector<SpatialIndex::Point> points;
+    uint64_t seed = 7;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<double>(seed >> 33) / static_cast<double>(1ull << 31) * 1000.0;
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        double x = next();
+        points.push_back({x, next()});
+    }
+    return points;
+}
+
+void TestSpatialIndex::testEmpty()
+{
+    SpatialIndex index({}, {});
+    QCOMPARE(index.nodeCount(), size_t(0));
+    QCOMPARE(index.levelCount(), size_t(1));
+
+    std::vector<uint32_t> found;
+    index.query(0, {-1e9, -1e9, 1e9, 1e9}, found);
+    QVERIFY(found.empty());
+}
+
+void TestSpatialIndex::testQueryMatchesBruteForce()
+{
+    const auto points = scatter(5000);
+    SpatialIndex index(points, {});
+    QVERIFY(index.levelCount() > 2);
+
+    const SpatialIndex::Rect rects[] = {
+        {100, 200, 300, 260},
+        {-50, -50, 20, 2000},
+        {999, 999, 5000, 5000},
+        {400, 400, 400, 400},      // degenerate
+        {2000, 0, 3000, 1000},     // outside
+    };
+    for (std::size_t level = 0; level < index.levelCount(); ++level) {
+        const auto& items = index.items(level);
+        for (const auto& rect : rects) {
+            std::vector<uint32_t> found;
+            index.query(level, rect, found);
+            std::sort(found.begin(), found.end());
+
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < items.size(); ++i) {
+                if (rect.contains(items[i].x, items[i].y)) expected.push_back(i);
+            }
+            QCOMPARE(found, expected);
+        }
+    }
+}
+
+void TestSpatialIndex::testLevelsMergeAllNodes()
+{
+    const auto points = scatter(3000);
+    SpatialIndex index(points, {});
+
+    std::size_t previous = points.size() + 1;
+    for (std::size_t level = 0; level < index.levelCount(); ++level) {
+        uint64_t total = 0;
+        for (const auto& item : index.items(level)) total += item.count;
+        QCOMPARE(total, uint64_t(points.size()));
+        QVERIFY(index.items(level).size() < previous);
+        previous = index.items(level).size();
+    }
+    QCOMPARE(index.items(index.levelCount() - 1).size(), size_t(1));
+    QCOMPARE(index.items(index.levelCount() - 1)[0].node, 0u);
+
+    // A cell-sized rect at a coarse level covers few items
+    std::vector<uint32_t> all;
+    const std::size_t level = 1;
+    index.collect(level, {0, 0, index.gridSize(level) - 1, index.gridSize(level) - 1}, all);
+    QCOMPARE(all.size(), index.items(level).size());
+}
+
+void TestSpatialIndex::testLinksMergedAndWeighted()
+{
+    // 0 <-> 1 in both directions, a self loop, and 1 -> 2
+    std::vector<SpatialIndex::Point> points = {{0, 0}, {10, 0}, {20, 0}};
+    std::vector<SpatialIndex::Edge> edges = {{0, 1}, {1, 0}, {1, 1}, {1, 2}, {7, 0}};
+    SpatialIndex index(points, edges);
+
+    auto links = index.links(0, 1);
+    QCOMPARE(links.size(), size_t(2));
+    std::vector<std::pair<uint32_t, uint32_t>> seen;
+    for (const auto& link : links) seen.push_back({link.to, link.weight});
+    std::sort(seen.begin(), seen.end());
+    QCOMPARE(seen[0], std::make_pair(0u, 2u));
+    QCOMPARE(seen[1], std::make_pair(2u, 1u));
+    QCOMPARE(index.links(0, 0).size(), size_t(1));
+
+    // All three nodes end up in one item, whose only edges were internal
+    const std::size_t top = index.levelCount() - 1;
+    QCOMPARE(index.items(top)[0].count, 3u);
+    QVERIFY(index.links(top, 0).empty());
+}
+
+void TestSpatialIndex::testLevelForScale()
+{
+    const auto points = scatter(20000);
+    SpatialIndex index(points, {});
+
+    QCOMPARE(index.levelFor(100.0, 6.0), size_t(0));
+    QCOMPARE(index.levelFor(1e-6, 6.0), index.levelCount() - 1);
+
+    std::size_t previous = 0;
+    for (double scale = 10.0; scale > 1e-4; scale /= 2) {
+        const std::size_t level = index.levelFor(scale, 6.0);
+        QVERIFY(level >= previous);
+        previous = level;
+        // Items of the chosen level are drawn at least ~6 px apart
+        if (level > 0 && level + 1 < index.levelCount()) {
+            QVERIFY(index.cellSize(level) * scale >= 6.0);
+        }
+    }
+}
+
+// Per level: live items by cell (by node at level 0) and the weights of the
+// links between them, independent of item numbering
+using CellItems = std::map<uint32_t, std::tuple<uint32_t, uint32_t, float, float>>;
+using CellLinks = std::map<std::pair<uint32_t, uint32_t>, uint32_t>;
+static std::pair<CellItems, CellLinks> byCell(const SpatialIndex& index, std::size_t level)
+{
+    CellItems items;
+    CellLinks links;
+    std::map<uint32_t, uint32_t> key_of;
+    const int grid = index.gridSize(level);
+    for (int y = 0; y < grid; ++y) {
+        for (int x = 0; x < grid; ++x) {
+            std::vector<uint32_t> found;
+            index.collect(level, {x, y, x, y}, found);
+            for (uint32_t i : found) {
+                const auto& item = index.items(level)[i];
+                const uint32_t key = level == 0 ? i : static_cast<uint32_t>(y * grid + x);
+                key_of[i] = key;
+                items[key] = {item.count, item.node, item.x, item.y};
+            }
+        }
+    }
+    for (const auto& [i, key] : key_of) {
+        for (const auto& link : index.links(level, i)) {
+            links[{key, key_of.at(link.to)}] = link.weight;
+        }
+    }
+    return {items, links};
+}
+
+void TestSpatialIndex::testUpdatedMatchesRebuild()
+{
+    // Corner nodes pin the bounds, so a rebuild uses the same grid
+    auto points = scatter(3000);
+    points[0] = {0, 0};
+    points[1] = {1000, 1000};
+    std::vector<SpatialIndex::Edge> edges;
+    for (uint32_t i = 1; i < points.size(); ++i) edges.push_back({i * 7919 % i, i});
+    SpatialIndex index(points, edges);
+
+    // Move some nodes (some across cells), add nodes and edges
+    const auto more = scatter(3060);
+    std::vector<uint32_t> moved;
+    for (uint32_t i = 2; i < 300; i += 3) {
+        points[i] = more[3000 + i % 60];
+        moved.push_back(i);
+    }
+    points[500].first += 0.01;
+    moved.push_back(500);
+    const std::size_t first_new_edge = edges.size();
+    for (uint32_t i = 3000; i < 3040; ++i) {
+        points.push_back(more[i]);
+        edges.push_back({i - 1500, i});
+    }
+    edges.push_back({10, 20});
+    edges.push_back({20, 10});
+
+    const SpatialIndex updated = index.updated(points, edges, first_new_edge, moved);
+    const SpatialIndex rebuilt(points, edges);
+    QCOMPARE(updated.nodeCount(), rebuilt.nodeCount());
+    QCOMPARE(updated.levelCount(), rebuilt.levelCount());
+    for (std::size_t level = 0; level < updated.levelCount(); ++level) {
+        const auto [items, links] = byCell(updated, level);
+        const auto [expected_items, expected_links] = byCell(rebuilt, level);
+        QCOMPARE(links, expected_links);
+        QCOMPARE(items.size(), expected_items.size());
+        for (const auto& [key, item] : items) {
+            const auto& expected = expected_items.at(key);
+            QCOMPARE(std::get<0>(item), std::get<0>(expected));
+            QCOMPARE(std::get<1>(item), std::get<1>(expected));
+            QVERIFY(std::abs(std::get<2>(item) - std::get<2>(expected)) < 1e-2f);
+            QVERIFY(std::abs(std::get<3>(item) - std::get<3>(expected)) < 1e-2f);
+        }
+    }
+
+    // Queries see the moved and new nodes where they are now
+    std::vector<uint32_t> found;
+    const auto [x, y] = points[3010];
+    updated.query(0, {x - 0.5, y - 0.5, x + 0.5, y + 0.5}, found);
+    QVERIFY(std::find(found.begin(), found.end(), 3010u) != found.end());
+}
+
+void TestSpatialIndex::testUpdatedOutsideBoundsRebuilds()
+{
+    auto points = scatter(1000);
+    SpatialIndex index(points, {});
+    points.push_back({5000, 5000});
+    const SpatialIndex updated = index.updated(points, {}, 0, {});
+    QCOMPARE(updated.bounds().right, 5000.0);
+    QCOMPARE(updated.nodeCount(), size_t(1001));
+}
+
+QTEST_MAIN(TestSpatialIndex)
+#include "test_spatial_index.moc"
@@ -0,0 +1,151 @@
+#include <QtTest/QtTest>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "state_graph_model.h"
+#include "spatial_index.h"
+
+using tla_visualiser::StateGraphModel;
+using tla_visualiser::TLCRunner;
+
+class TestStateGraphModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testLoadFromResults();
+    void testAppendInsertsRows();
+    void testAppendMovesOnlyNeighbours();
+    void testTransitionsWaitForEndpoints();
+    void testSparseIds();
+    void testSnapshotShared();
+};
+
+using Variables = std::vector<std::pair<std::string, std::string>>;
+
+static TLCRunner::RunResults chain(int first, int count)
+{
+    TLCRunner::RunResults results{};
+    for (int id = first; id < first + count; ++id) {
+        results.states.add(id, "Next", Variables{{"x", std::to_string(id)}});
+        if (id > 0) results.transitions.push_back({id - 1, id, "Next"});
+    }
+    return results;
+}
+
+void TestStateGraphModel::testLoadFromResults()
+{
+    StateGraphModel model;
+    model.loadFromResults(chain(0, 3));
+
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.edgeCount(), 2);
+    QCOMPARE(model.edgeBuffer().size(), qsizetype(2 * 3 * sizeof(int32_t)));
+    QCOMPARE(model.getStateDetails(2)["description"].toString(), QString("Next"));
+
+    model.loadFromResults(chain(0, 2));
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.edgeCount(), 1);
+}
+
+void TestStateGraphModel::testAppendInsertsRows()
+{
+    StateGraphModel model;
+    model.setLayoutMode(StateGraphModel::LayoutMode::Circular);
+    model.loadFromResults(chain(0, 3));
+    const QVariant variables = model.data(model.index(1), StateGraphModel::StateVariablesRole);
+
+    QSignalSpy resets(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserts(&model, &QAbstractItemModel::rowsInserted);
+    model.appendResults(chain(3, 2));
+
+    QCOMPARE(resets.count(), 0);
+    QCOMPARE(inserts.count(), 1);
+    QCOMPARE(inserts[0][1].toInt(), 3);
+    QCOMPARE(inserts[0][2].toInt(), 4);
+    QCOMPARE(model.rowCount(), 5);
+    QCOMPARE(model.edgeCount(), 4);
+    QCOMPARE(model.positionBuffer().size(), qsizetype(5 * 2 * sizeof(float)));
+    QCOMPARE(model.data(model.index(1), StateGraphModel::StateVariablesRole), variables);
+    QCOMPARE(model.getTransitions().last().toMap()["from"].toInt(), 3);
+}
+
+void TestStateGraphModel::testAppendMovesOnlyNeighbours()
+{
+    StateGraphModel model;
+    model.loadFromResults(chain(0, 200));
+    const QByteArray positions = model.positionBuffer();
+
+    QSignalSpy changes(&model, &QAbstractItemModel::dataChanged);
+    model.appendResults(chain(200, 1));
+
+    // Only state 199, which the new state hangs off, is re-placed
+    QCOMPARE(changes.count(), 1);
+    QCOMPARE(changes[0][0].toModelIndex().row(), 199);
+    QCOMPARE(changes[0][1].toModelIndex().row(), 199);
+    const QByteArray grown = model.positionBuffer();
+    QCOMPARE(grown.size(), qsizetype(201 * 2 * sizeof(float)));
+    QCOMPARE(grown.left(199 * 2 * sizeof(float)), positions.left(199 * 2 * sizeof(float)));
+    QCOMPARE(model.spatialIndex()->nodeCount(), size_t(201));
+}
+
+void TestStateGraphModel::testTransitionsWaitForEndpoints()
+{
+    StateGraphModel model;
+    TLCRunner::RunResults first = chain(0, 2);
+    first.transitions.push_back({1, 2, "Ahead"});
+    model.loadFromResults(first);
+
+    // The edge into state 2 counts but is not drawn until state 2 arrives
+    QCOMPARE(model.edgeCount(), 2);
+    QCOMPARE(model.edgeBuffer().size(), qsizetype(3 * sizeof(int32_t)));
+
+    TLCRunner::RunResults delta{};
+    delta.states.add(2, "Next", Variables{{"x", "2"}});
+    model.appendResults(delta);
+
+    QCOMPARE(model.edgeCount(), 2);
+    const QByteArray buffer = model.edgeBuffer();
+    QCOMPARE(buffer.size(), qsizetype(2 * 3 * sizeof(int32_t)));
+    const auto* packed = reinterpret_cast<const int32_t*>(buffer.constData());
+    QCOMPARE(packed[3], 1);
+    QCOMPARE(packed[4], 2);
+    QCOMPARE(model.actionNames()[packed[5]], QString("Ahead"));
+}
+
+void TestStateGraphModel::testSparseIds()
+{
+    StateGraphModel model;
+    model.loadFromResults(chain(0, 2));
+    model.appendResults(chain(100, 2));
+
+    QCOMPARE(model.getStateDetails(1)["description"].toString(), QString("Next"));
+    QCOMPARE(model.getStateDetails(101)["id"].toInt(), 101);
+    QVERIFY(model.getStateDetails(2).isEmpty());
+    // 0 -> 1 and 100 -> 101; 99 -> 100 has no source
+    QCOMPARE(model.edgeBuffer().size(), qsizetype(2 * 3 * sizeof(int32_t)));
+}
+
+void TestStateGraphModel::testSnapshotShared()
+{
+    auto snapshot = std::make_shared<const TLCRunner::RunResults>(chain(0, 3));
+    StateGraphModel model;
+    model.loadFromSnapshot(snapshot);
+
+    // The model reads the snapshot's states in place and keeps it alive
+    QVERIFY(snapshot.use_count() > 1);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.getStateDetails(2)["variables"].toList().size(), 1);
+
+    // Appending leaves the shared snapshot untouched
+    model.appendResults(chain(3, 1));
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(snapshot->states.size(), size_t(3));
+
+    model.clear();
+    QCOMPARE(snapshot.use_count(), 1);
+}
+
+QTEST_MAIN(TestStateGraphModel)
+#include "test_state_graph_model.moc"
@@ -0,0 +1,95 @@
+#include <QtTest/QtTest>
+#include <string>
+#include <utility>
+#include <vector>
+#include "state_index.h"
+
+using tla_visualiser::StateIndex;
+using tla_visualiser::StateStore;
+using tla_visualiser::TLCRunner;
+
+class TestStateIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDenseIds();
+    void testSparseIds();
+    void testIncomingTransitions();
+    void testSharedFromResults();
+};
+
+using Variables = std::vector<std::pair<std::string, std::string>>;
+
+void TestStateIndex::testDenseIds()
+{
+    StateStore states;
+    for (int i = 0; i < 5; ++i) {
+        states.add(i, "S", Variables{{"x", std::to_string(i)}});
+    }
+
+    StateIndex index(states, {});
+    QCOMPARE(index.stateCount(), size_t(5));
+    QCOMPARE(index.indexOf(3), 3LL);
+    QCOMPARE(index.indexOf(5), -1LL);
+    QCOMPARE(index.indexOf(-1), -1LL);
+}
+
+void TestStateIndex::testSparseIds()
+{
+    StateStore states;
+    const int count = 10000;
+    for (int i = 0; i < count; ++i) {
+        states.add(i * 7 + 1000, "S", Variables{});
+    }
+    states.add(1000, "Duplicate", Variables{});
+
+    StateIndex index(states, {});
+    QCOMPARE(index.indexOf(1000), 0LL);  // first of the duplicates
+    QCOMPARE(index.indexOf(1000 + 7 * 4321), 4321LL);
+    QCOMPARE(index.indexOf(1001), -1LL);
+    QCOMPARE(index.indexOf(0), -1LL);
+}
+
+void TestStateIndex::testIncomingTransitions()
+{
+    StateStore states;
+    states.add(10, "A", Variables{});
+    states.add(20, "B", Variables{});
+    states.add(30, "C", Variables{});
+
+    std::vector<TLCRunner::Transition> transitions = {
+        {10, 20, "Step"},
+        {20, 30, "Step"},
+        {10, 30, "Jump"},
+        {30, 10, "Reset"},
+        {10, 99, "Dangling"},
+    };
+
+    StateIndex index(states, transitions);
+    auto into_c = index.incoming(2);
+    QCOMPARE(std::vector<uint32_t>(into_c.begin(), into_c.end()), std::vector<uint32_t>({1, 2}));
+    QCOMPARE(index.incoming(0).size(), size_t(1));
+    QVERIFY(index.incoming(3).empty());
+
+    QCOMPARE(index.incomingFrom(2, 10, transitions), 2LL);
+    QCOMPARE(index.incomingFrom(2, 20, transitions), 1LL);
+    QCOMPARE(index.incomingFrom(2, 42, transitions), 1LL);  // falls back to the first edge
+    QCOMPARE(index.incomingFrom(1, 30, transitions), 0LL);
+}
+
+void TestStateIndex::testSharedFromResults()
+{
+    TLCRunner::RunResults results{};
+    results.states.add(0, "Init", Variables{{"x", "0"}});
+
+    auto built = StateIndex::of(results);
+    QVERIFY(built);
+    QCOMPARE(built->indexOf(0), 0LL);
+
+    results.index = built;
+    QCOMPARE(StateIndex::of(results).get(), built.get());
+}
+
+QTEST_MAIN(TestStateIndex)
+#include "test_state_index.moc"
@@ -0,0 +1,119 @@
+#include <QtTest/QtTest>
+#include <string>
+#include <utility>
+#include <vector>
+#include "state_store.h"
+
+using tla_visualiser::StateStore;
+
+class TestStateStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testAddAndRead();
+    void testSparseVariables();
+    void testManyBlocks();
+    void testCopy();
+    void testCopySharesBlocks();
+};
+
+using Variables = std::vector<std::pair<std::string, std::string>>;
+
+void TestStateStore::testAddAndRead()
+{
+    StateStore store;
+    QVERIFY(store.empty());
+
+    store.add(7, "Initial predicate", Variables{{"x", "0"}, {"y", "<<>>"}});
+    store.add(8, "Next", Variables{{"x", "1"}, {"y", "<<1>>"}});
+
+    QCOMPARE(store.size(), size_t(2));
+    QCOMPARE(store.id(0), 7);
+    QCOMPARE(store.id(1), 8);
+    QCOMPARE(store.description(1), std::string_view("Next"));
+    QCOMPARE(store.variableCount(), size_t(2));
+    QCOMPARE(store.variableName(1), std::string_view("y"));
+    QCOMPARE(store.findVariable("y"), 1);
+    QCOMPARE(store.findVariable("z"), -1);
+    QCOMPARE(store.value(0, 1), std::string_view("<<>>"));
+    QCOMPARE(store.value(1, 0), std::string_view("1"));
+}
+
+void TestStateStore::testSparseVariables()
+{
+    StateStore store;
+    store.add(0, "A", Variables{{"x", "0"}});
+    store.add(1, "B", Variables{{"y", "1"}});
+    store.add(2, "C", Variables{{"x", "2"}, {"y", "3"}});
+
+    QCOMPARE(store.value(0, 1), std::string_view());
+    QCOMPARE(store.value(1, 0), std::string_view());
+    QCOMPARE(store.value(2, 0), std::string_view("2"));
+    QCOMPARE(store.value(2, 1), std::string_view("3"));
+
+    std::vector<std::string> visited;
+    store.forEachVariable(1, [&visited](std::string_view name, std::string_view value) {
+        visited.push_back(std::string(name) + "=" + std::string(value));
+    });
+    QCOMPARE(visited, std::vector<std::string>({"y=1"}));
+}
+
+void TestStateStore::testManyBlocks()
+{
+    StateStore store;
+    const int count = static_cast<int>(StateStore::kBlockSize) * 3 + 17;
+    for (int i = 0; i < count; ++i) {
+        store.add(i * 2, i == 0 ? "Initial predicate" : "Next",
+                  Variables{{"counter", std::to_string(i)}, {"flag", i % 2 ? "TRUE" : "FALSE"}});
+    }
+
+    QCOMPARE(store.size(), size_t(count));
+    for (int i = 0; i < count; i += 997) {
+        QCOMPARE(store.id(i), i * 2);
+        QCOMPARE(store.value(i, 0), std::string_view(std::to_string(i)));
+    }
+    QCOMPARE(store.value(count - 1, 1), std::string_view((count - 1) % 2 ? "TRUE" : "FALSE"));
+
+    // Names and descriptions are stored once, not per state
+    QCOMPARE(store.variableCount(), size_t(2));
+    QVERIFY(store.memoryUsage() < size_t(count) * 32);
+}
+
+void TestStateStore::testCopy()
+{
+    StateStore store;
+    store.add(1, "Init", Variables{{"x", "42"}});
+
+    StateStore copy = store;
+    store.clear();
+
+    QVERIFY(store.empty());
+    QCOMPARE(copy.size(), size_t(1));
+    QCOMPARE(copy.value(0, 0), std::string_view("42"));
+}
+
+void TestStateStore::testCopySharesBlocks()
+{
+    StateStore store;
+    const int count = static_cast<int>(StateStore::kBlockSize) + 10;
+    for (int i = 0; i < count; ++i) {
+        store.add(i, "Next", Variables{{"x", std::to_string(i)}});
+    }
+
+    // Appending to either copy leaves the other one as it was
+    StateStore copy = store;
+    store.add(count, "Next", Variables{{"x", "original"}});
+    copy.add(count, "Next", Variables{{"x", "copy"}});
+    copy.add(count + 1, "Next", Variables{{"x", "more"}});
+
+    QCOMPARE(store.size(), size_t(count + 1));
+    QCOMPARE(copy.size(), size_t(count + 2));
+    QCOMPARE(store.value(count, 0), std::string_view("original"));
+    QCOMPARE(copy.value(count, 0), std::string_view("copy"));
+    QCOMPARE(store.value(count - 1, 0), std::string_view(std::to_string(count - 1)));
+    QCOMPARE(copy.value(0, 0), std::string_view("0"));
+}
+
+QTEST_MAIN(TestStateStore)
+#include "test_state_store.moc"
@@ -0,0 +1,171 @@
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include <string>
+#include "tlc_job_scheduler.h"
+
+using tla_visualiser::TLCJobScheduler;
+using tla_visualiser::TLCRunner;
+
+class TestTLCJobScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testSplitsCoresAmongJobs();
+    void testPriorityOrder();
+    void testCancelQueuedAndRunning();
+    void testStats();
+
+private:
+    std::string spec(const QString& name);
+    QStringList log() const;
+
+    QTemporaryDir dir;
+    QByteArray path;
+};
+
+void TestTLCJobScheduler::initTestCase()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Uses a shell script in place of java");
+#endif
+    QVERIFY(dir.isValid());
+    // A "java" that logs the spec it was given and its -workers, reports
+    // some statistics and sleeps for the number of seconds in the spec
+    QFile script(dir.filePath("java"));
+    QVERIFY(script.open(QIODevice::WriteOnly));
+    script.write(QString("#!/bin/sh\n"
+                         "workers=1\n"
+                         "while [ $# -gt 0 ]; do\n"
+                         "  case \"$1\" in\n"
+                         "    -workers) workers=$2; shift ;;\n"
+                         "    *.tla) spec=$1 ;;\n"
+                         "  esac\n"
+                         "  shift\n"
+                         "done\n"
+                         "echo \"$(basename $spec .tla) $workers\" >> %1\n"
+                         "echo \"100 states generated, 40 distinct states found, 0 states left on queue.\"\n"
+                         "sleep $(cat $spec)\n")
+                     .arg(dir.filePath("log"))
+                     .toUtf8());
+    script.close();
+    QVERIFY(script.setPermissions(script.permissions() | QFileDevice::ExeOwner));
+
+    path = qgetenv("PATH");
+    qputenv("PATH", dir.path().toUtf8() + ":" + path);
+}
+
+void TestTLCJobScheduler::cleanupTestCase()
+{
+    qputenv("PATH", path);
+}
+
+std::string TestTLCJobScheduler::spec(const QString& name)
+{
+    // The spec's content is how long the fake TLC runs
+    QFile file(dir.filePath(name + ".tla"));
+    if (!file.exists()) {
+        file.open(QIODevice::WriteOnly);
+        file.write(name.startsWith("slow") ? "0.5\n" : "0.05\n");
+        file.close();
+    }
+    return file.fileName().toStdString();
+}
+
+QStringList TestTLCJobScheduler::log() const
+{
+    QFile file(dir.filePath("log"));
+    file.open(QIODevice::ReadOnly);
+    QStringList lines = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+    QFile::remove(dir.filePath("log"));
+    return lines;
+}
+
+void TestTLCJobScheduler::testSplitsCoresAmongJobs()
+{
+    TLCJobScheduler scheduler(4, 2);
+
+    // Alone, a job gets the whole budget
+    auto a = scheduler.submit({spec("slowA"), "", 0, 0});
+    QCOMPARE(scheduler.stats().running, size_t(1));
+    QCOMPARE(scheduler.stats().cores_in_use, 4);
+    scheduler.waitForIdle();
+    QCOMPARE(scheduler.result(a)->workers, 4);
+    QCOMPARE(scheduler.result(a)->status, TLCRunner::Status::Completed);
+    QCOMPARE(scheduler.result(a)->results->distinct_states, 40);
+    QVERIFY(log().contains("slowA 4"));
+
+    // Jobs queued behind one holding every core share them once it finishes
+    auto b = scheduler.submit({spec("slowB"), "", 0, 0});
+    auto c = scheduler.submit({spec("slowC"), "", 0, 0});
+    auto d = scheduler.submit({spec("fastD"), "", 0, 1});
+    QCOMPARE(scheduler.stats().running, size_t(1));
+    scheduler.waitForIdle();
+
+    QCOMPARE(scheduler.result(b)->workers, 4);
+    QCOMPARE(scheduler.result(c)->workers, 2);
+    QCOMPARE(scheduler.result(d)->workers, 1);   // capped by max_workers
+    log();
+}
+
+void TestTLCJobScheduler::testPriorityOrder()
+{
+    TLCJobScheduler scheduler(2, 1);
+    scheduler.submit({spec("slowFirst"), "", 0, 0});
+    scheduler.submit({spec("fastLow"), "", 0, 0});
+    scheduler.submit({spec("fastHigh"), "", 5, 0});
+    scheduler.submit({spec("fastLow2"), "", 0, 0});
+    scheduler.waitForIdle();
+
+    QStringList order;
+    for (const QString& line : log()) order.append(line.section(' ', 0, 0));
+    QCOMPARE(order, QStringList({"slowFirst", "fastHigh", "fastLow", "fastLow2"}));
+}
+
+void TestTLCJobScheduler::testCancelQueuedAndRunning()
+{
+    TLCJobScheduler scheduler(1, 1);
+    QList<TLCJobScheduler::JobId> reported;
+    scheduler.setJobFinishedCallback([&reported](const TLCJobScheduler::JobResult& result) {
+        reported.append(result.id);
+    });
+    auto running = scheduler.submit({spec("slowRunning"), "", 0, 0});
+    auto queued = scheduler.submit({spec("fastQueued"), "", 0, 0});
+
+    QVERIFY(scheduler.cancel(queued));
+    QCOMPARE(scheduler.result(queued)->status, TLCRunner::Status::Cancelled);
+    QVERIFY(scheduler.cancel(running));
+    scheduler.waitForIdle();
+    QCOMPARE(scheduler.result(running)->status, TLCRunner::Status::Cancelled);
+    QVERIFY(!scheduler.cancel(running));
+    QCOMPARE(reported.size(), 2);
+    QCOMPARE(scheduler.stats().cancelled, size_t(2));
+    log();
+}
+
+void TestTLCJobScheduler::testStats()
+{
+    TLCJobScheduler scheduler(3);
+    for (int i = 0; i < 5; ++i) {
+        scheduler.submit({spec(QString("fast%1").arg(i)), "", 0, 0});
+    }
+    scheduler.submit({"/nonexistent/spec.tla", "", 0, 0});
+    scheduler.waitForIdle();
+
+    const auto stats = scheduler.stats();
+    QCOMPARE(stats.completed, size_t(5));
+    QCOMPARE(stats.failed, size_t(1));
+    QCOMPARE(stats.running, size_t(0));
+    QCOMPARE(stats.cores_in_use, 0);
+    QCOMPARE(stats.states_generated, uint64_t(500));
+    QVERIFY(stats.states_per_second > 0);
+    QVERIFY(stats.jobs_per_minute > 0);
+    QCOMPARE(scheduler.results().size(), size_t(6));
+    log();
+}
+
+QTEST_MAIN(TestTLCJobScheduler)
+#include "test_tlc_job_scheduler.moc"
@@ -0,0 +1,96 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "tlc_options.h"
+
+using tla_visualiser::TLCOptions;
+
+class TestTLCOptions : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDefaultArguments();
+    void testAllOptions();
+    void testAutoSized();
+    void testAutoHeapSplitsMemory();
+    void testHostArguments();
+};
+
+void TestTLCOptions::testDefaultArguments()
+{
+    TLCOptions options;
+    std::vector<std::string> expected = {"-jar", "tla2tools.jar", "-tool", "/specs/Spec.tla"};
+    QVERIFY(options.arguments("/specs/Spec.tla") == expected);
+
+    expected.push_back("-config");
+    expected.push_back("/specs/Spec.cfg");
+    QVERIFY(options.arguments("/specs/Spec.tla", "/specs/Spec.cfg") == expected);
+}
+
+void TestTLCOptions::testAllOptions()
+{
+    TLCOptions options;
+    options.tla2tools_jar = "/opt/tla/tla2tools.jar";
+    options.heap_mb = 4096;
+    options.gc = TLCOptions::GarbageCollector::Parallel;
+    options.jvm_args = {"-XX:+UseNUMA"};
+    options.workers = 8;
+    options.fpmem = 0.75;
+    options.fp_index = 42;
+    options.checkpoint_minutes = 0;
+    options.recover = "states/21-01-01";
+    options.metadir = "states";
+    options.tlc_args = {"-deadlock"};
+
+    const std::vector<std::string> expected = {
+        "-Xmx4096m", "-XX:+UseParallelGC", "-XX:+UseNUMA",
+        "-jar", "/opt/tla/tla2tools.jar", "-tool",
+        "-workers", "8", "-fpmem", "0.75", "-fp", "42", "-checkpoint", "0",
+        "-recover", "states/21-01-01", "-metadir", "states", "-deadlock",
+        "Spec.tla", "-config", "Spec.cfg"};
+    QVERIFY(options.arguments("Spec.tla", "Spec.cfg") == expected);
+}
+
+void TestTLCOptions::testAutoSized()
+{
+    const uint64_t gib = 1024ull * 1024 * 1024;
+    TLCOptions options = TLCOptions::autoSized(12, 16 * gib);
+    QCOMPARE(options.workers, 12);
+    QCOMPARE(options.heap_mb, 8192);
+    QVERIFY(options.gc == TLCOptions::GarbageCollector::Parallel);
+
+    const auto args = options.arguments("Spec.tla");
+    QVERIFY(std::find(args.begin(), args.end(), "-Xmx8192m") < std::find(args.begin(), args.end(), "-jar"));
+
+    // Detected values are at least sane
+    QVERIFY(TLCOptions::detectedCores() >= 1);
+    QVERIFY(TLCOptions::autoSized().workers == TLCOptions::detectedCores());
+}
+
+void TestTLCOptions::testAutoHeapSplitsMemory()
+{
+    const uint64_t gib = 1024ull * 1024 * 1024;
+    QCOMPARE(TLCOptions::autoHeapMb(32 * gib, 4), 4096);
+    // Never below the floor, however many jobs share the machine
+    QCOMPARE(TLCOptions::autoHeapMb(1 * gib, 64), 256);
+}
+
+void TestTLCOptions::testHostArguments()
+{
+    TLCOptions options;
+    options.heap_mb = 1024;
+    options.warm_host = true;
+    const std::vector<std::string> expected = {"-Xmx1024m", "-cp", "tla2tools.jar", "tools/TLCHost.java"};
+    QVERIFY(options.hostArguments() == expected);
+
+    // What the host passes on to TLC: everything after -jar
+    std::vector<std::string> full = options.arguments("Spec.tla");
+    const std::vector<std::string> tlc = options.tlcArguments("Spec.tla");
+    QVERIFY(std::equal(tlc.begin(), tlc.end(), full.end() - static_cast<std::ptrdiff_t>(tlc.size())));
+    QCOMPARE(tlc.front(), std::string("-tool"));
+}
+
+QTEST_MAIN(TestTLCOptions)
+#include "test_tlc_options.moc"
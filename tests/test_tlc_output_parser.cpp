@@ -0,0 +1,218 @@
+#include <QtTest/QtTest>
+#include <string>
+#include "tlc_output_parser.h"
+
+using tla_visualiser::TLCOutputParser;
+using tla_visualiser::TLCRunner;
+
+class TestTLCOutputParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testToolModeCounters();
+    void testChunkBoundaries();
+    void testErrorMessages();
+    void testProgressCallback();
+    void testBoundedBuffering();
+    void testInvariantViolationTrace();
+    void testLivenessLasso();
+};
+
+static const char* kToolOutput =
+    "@!@!@STARTMSG 2262:0 @!@!@\n"
+    "TLC2 Version 2.18\n"
+    "@!@!@ENDMSG 2262 @!@!@\n"
+    "@!@!@STARTMSG 2200:0 @!@!@\n"
+    "Progress(3) at 2024-01-01 12:00:00: 1,204 states generated (72,240 s/min), "
+    "602 distinct states found (36,120 ds/min), 10 states left on queue.\n"
+    "@!@!@ENDMSG 2200 @!@!@\n"
+    "@!@!@STARTMSG 2199:0 @!@!@\n"
+    "2,048 states generated, 1,024 distinct states found, 0 states left on queue.\n"
+    "@!@!@ENDMSG 2199 @!@!@\n";
+
+void TestTLCOutputParser::testToolModeCounters()
+{
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    std::string output(kToolOutput);
+    parser.feed(output.data(), output.size());
+    parser.finish();
+
+    QCOMPARE(results.states_generated, 2048);
+    QCOMPARE(results.distinct_states, 1024);
+    QVERIFY(results.error_message.empty());
+}
+
+void TestTLCOutputParser::testChunkBoundaries()
+{
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    // Feed one byte at a time so every line and marker is split
+    std::string output(kToolOutput);
+    for (char c : output) {
+        parser.feed(&c, 1);
+    }
+    parser.finish();
+
+    QCOMPARE(results.states_generated, 2048);
+    QCOMPARE(results.distinct_states, 1024);
+}
+
+void TestTLCOutputParser::testErrorMessages()
+{
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    std::string output =
+        "@!@!@STARTMSG 1000:1 @!@!@\n"
+        "Attempted to apply function to an argument not in its domain.\n"
+        "@!@!@ENDMSG 1000 @!@!@\n"
+        "Error: could not find tla2tools.jar\r\n";
+    parser.feed(output.data(), output.size());
+    parser.finish();
+
+    QVERIFY(results.error_message.find("not in its domain") != std::string::npos);
+    QVERIFY(results.error_message.find("Error: could not find tla2tools.jar\n") != std::string::npos);
+}
+
+void TestTLCOutputParser::testProgressCallback()
+{
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    std::vector<int> reported;
+    parser.setProgressCallback([&reported](int distinct, const std::string&) {
+        reported.push_back(distinct);
+    });
+
+    std::string output(kToolOutput);
+    parser.feed(output.data(), output.size());
+    parser.finish();
+
+    QCOMPARE(reported.size(), size_t(2));
+    QCOMPARE(reported[0], 602);
+    QCOMPARE(reported[1], 1024);
+}
+
+void TestTLCOutputParser::testBoundedBuffering()
+{
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    // Many complete messages must not accumulate in the parser
+    std::string message =
+        "@!@!@STARTMSG 2200:0 @!@!@\n"
+        "Progress(1) at 2024-01-01 12:00:00: 10 states generated, 5 distinct states found\n"
+        "@!@!@ENDMSG 2200 @!@!@\n";
+    for (int i = 0; i < 10000; ++i) {
+        parser.feed(message.data(), message.size());
+    }
+    QCOMPARE(parser.bufferedBytes(), size_t(0));
+
+    // A partial line is held until its newline arrives
+    parser.feed("@!@!@STARTMSG 2200", 18);
+    QCOMPARE(parser.bufferedBytes(), size_t(18));
+}
+
+static const char* kViolationOutput =
+    "@!@!@STARTMSG 2110:1 @!@!@\n"
+    "Invariant CounterBound is violated.\n"
+    "@!@!@ENDMSG 2110 @!@!@\n"
+    "@!@!@STARTMSG 2121:1 @!@!@\n"
+    "The behavior up to this point is:\n"
+    "@!@!@ENDMSG 2121 @!@!@\n"
+    "@!@!@STARTMSG 2217:4 @!@!@\n"
+    "1: <Initial predicate>\n"
+    "/\\ count = 0\n"
+    "/\\ log = <<>>\n"
+    "@!@!@ENDMSG 2217 @!@!@\n"
+    "@!@!@STARTMSG 2217:4 @!@!@\n"
+    "2: <Increment line 12, col 5 to line 14, col 20 of module SimpleCounter>\n"
+    "/\\ count = 1\n"
+    "/\\ log = << \"inc\",\n"
+    "           \"inc\" >>\n"
+    "@!@!@ENDMSG 2217 @!@!@\n"
+    "@!@!@STARTMSG 2217:4 @!@!@\n"
+    "3: <Reset line 16, col 5 to line 17, col 20 of module SimpleCounter>\n"
+    "/\\ count = 0\n"
+    "/\\ log = <<>>\n"
+    "@!@!@ENDMSG 2217 @!@!@\n"
+    "@!@!@STARTMSG 2201:0 @!@!@\n"
+    "The depth of the complete state graph search is 3.\n"
+    "@!@!@ENDMSG 2201 @!@!@\n";
+
+void TestTLCOutputParser::testInvariantViolationTrace()
+{
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    std::string output(kViolationOutput);
+    parser.feed(output.data(), output.size());
+    parser.finish();
+
+    // Step 3 revisits the initial state, so only two distinct states
+    QCOMPARE(results.states.size(), size_t(2));
+    QCOMPARE(results.states.variableCount(), size_t(2));
+    QCOMPARE(results.states.variableName(0), std::string_view("count"));
+    QCOMPARE(results.states.value(0, 0), std::string_view("0"));
+    QCOMPARE(results.states.value(1, 1),
+             std::string_view("<< \"inc\",\n           \"inc\" >>"));
+    QCOMPARE(results.states.description(1), std::string_view("Increment"));
+
+    QCOMPARE(results.transitions.size(), size_t(2));
+    QCOMPARE(results.transitions[0].from_state, 0);
+    QCOMPARE(results.transitions[0].to_state, 1);
+    QCOMPARE(results.transitions[0].action, std::string("Increment"));
+    QCOMPARE(results.transitions[1].action, std::string("Reset"));
+
+    QCOMPARE(results.counterexamples.size(), size_t(1));
+    QCOMPARE(results.counterexamples[0].state_sequence, std::vector<int>({0, 1, 0}));
+    QCOMPARE(results.counterexamples[0].description,
+             std::string("Invariant CounterBound is violated."));
+
+    QCOMPARE(results.invariants.size(), size_t(1));
+    QCOMPARE(results.invariants[0].name, std::string("CounterBound"));
+    QVERIFY(!results.invariants[0].passed);
+    QCOMPARE(results.invariants[0].error_state_id, 0);
+    QVERIFY(!results.error_message.empty());
+}
+
+void TestTLCOutputParser::testLivenessLasso()
+{
+    TLCRunner::RunResults results{};
+    TLCOutputParser parser(results);
+
+    std::string output =
+        "@!@!@STARTMSG 2116:1 @!@!@\n"
+        "Temporal properties were violated.\n"
+        "@!@!@ENDMSG 2116 @!@!@\n"
+        "@!@!@STARTMSG 2217:4 @!@!@\n"
+        "1: <Initial predicate>\n"
+        "x = 0\n"
+        "@!@!@ENDMSG 2217 @!@!@\n"
+        "@!@!@STARTMSG 2217:4 @!@!@\n"
+        "2: <Next line 5, col 1 to line 5, col 10 of module M>\n"
+        "x = 1\n"
+        "@!@!@ENDMSG 2217 @!@!@\n"
+        "@!@!@STARTMSG 2122:4 @!@!@\n"
+        "1: Back to state: <Next line 5, col 1 to line 5, col 10 of module M>\n"
+        "@!@!@ENDMSG 2122 @!@!@\n";
+    parser.feed(output.data(), output.size());
+    parser.finish();
+
+    QCOMPARE(results.states.size(), size_t(2));
+    QCOMPARE(results.states.variableName(0), std::string_view("x"));
+    QCOMPARE(results.states.value(1, 0), std::string_view("1"));
+    QCOMPARE(results.counterexamples.size(), size_t(1));
+    QCOMPARE(results.counterexamples[0].state_sequence, std::vector<int>({0, 1, 0}));
+    QCOMPARE(results.transitions.size(), size_t(2));
+    QCOMPARE(results.transitions[1].from_state, 1);
+    QCOMPARE(results.transitions[1].to_state, 0);
+    QCOMPARE(results.transitions[1].action, std::string("Next"));
+}
+
+QTEST_MAIN(TestTLCOutputParser)
+#include "test_tlc_output_parser.moc"
@@ -1,7 +1,17 @@
 #include <QtTest/QtTest>
 #include <QDir>
 #include <QFile>
+#include <QThread>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <fstream>
+#ifndef Q_OS_WIN
+#include <csignal>
+#endif
 #include "tlc_runner.h"
+#include "run_cache.h"
+#include "results_file.h"
 
 class TestTLCRunner : public QObject
 {
@@ -10,8 +20,57 @@ class TestTLCRunner : public QObject
 private slots:
     void testInitialStatus();
     void testResultsSaving();
+    void testResultsReload();
+    void testLegacyTextResults();
+    void testMalformedTextResults();
+    void testSnapshotShared();
+    void testFailedRunQueuedCallbacks();
+    void testCancelKillsProcessTree();
+    void testWarmHostReused();
+    void testWarmHostLostFallsBack();
+    void testRunCacheSkipsTLC();
 };
 
+namespace {
+
+// A "java" that logs "host" or "tlc" per start to `log`. As the warm host
+// it answers RUN requests, or dies on the first one if `die` is set.
+QString writeFakeJava(const QTemporaryDir& dir, const QString& log, bool die)
+{
+    const QString path = dir.filePath("java");
+    QFile script(path);
+    if (!script.open(QIODevice::WriteOnly)) return QString();
+    script.write(QString("#!/bin/sh\n"
+                         "stats='10 states generated, 4 distinct states found, 0 states left on queue.'\n"
+                         "case \"$*\" in\n"
+                         "  *TLCHost.java*)\n"
+                         "    echo host >> %1\n"
+                         "    echo '@!@!@TLCHOST-READY'\n"
+                         "    while read -r line; do\n"
+                         "      %2\n"
+                         "      echo \"$stats\"\n"
+                         "      echo '@!@!@TLCHOST-END 0'\n"
+                         "    done ;;\n"
+                         "  *)\n"
+                         "    echo tlc >> %1\n"
+                         "    echo \"$stats\" ;;\n"
+                         "esac\n")
+                     .arg(log, die ? "echo 'Starting...'; exit 1" : ":")
+                     .toUtf8());
+    script.close();
+    script.setPermissions(script.permissions() | QFileDevice::ExeOwner);
+    return path;
+}
+
+QStringList readLog(const QString& log)
+{
+    QFile file(log);
+    if (!file.open(QIODevice::ReadOnly)) return {};
+    return QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+}
+
+} // namespace
+
 void TestTLCRunner::testInitialStatus()
 {
     tla_visualiser::TLCRunner runner;
@@ -22,6 +81,17 @@ void TestTLCRunner::testInitialStatus()
     QCOMPARE(results.status, tla_visualiser::TLCRunner::Status::NotStarted);
     QCOMPARE(results.states_generated, 0);
     QCOMPARE(results.distinct_states, 0);
+
+    auto progress = runner.getProgress();
+    QCOMPARE(progress.status, tla_visualiser::TLCRunner::Status::NotStarted);
+    QCOMPARE(progress.distinct_states, 0);
+
+    // Tuning is opt-in: nothing is passed to the JVM or TLC by default
+    const auto options = runner.options();
+    QCOMPARE(options.workers, 0);
+    QCOMPARE(options.heap_mb, 0);
+    QVERIFY(options.gc == tla_visualiser::TLCOptions::GarbageCollector::Default);
+    QVERIFY(options.jvmArguments().empty());
 }
 
 void TestTLCRunner::testResultsSaving()
@@ -41,5 +111,301 @@ void TestTLCRunner::testResultsSaving()
     QFile::remove(tempFile);
 }
 
+void TestTLCRunner::testResultsReload()
+{
+    tla_visualiser::TLCRunner runner;
+    QString tempFile = QDir::tempPath() + "/test_results_reload.tlcres";
+    QVERIFY(runner.saveResults(tempFile.toStdString()));
+
+    tla_visualiser::TLCRunner reloaded;
+    QVERIFY(reloaded.loadResults(tempFile.toStdString()));
+    QCOMPARE(reloaded.getStatus(), tla_visualiser::TLCRunner::Status::Completed);
+    auto results = reloaded.getResults();
+    QCOMPARE(results.status, tla_visualiser::TLCRunner::Status::NotStarted);
+    QVERIFY(results.states.empty());
+    QVERIFY(results.index);
+
+    QFile::remove(tempFile);
+}
+
+void TestTLCRunner::testLegacyTextResults()
+{
+    QString tempFile = QDir::tempPath() + "/test_results_legacy.txt";
+    QFile file(tempFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("Status: 3\nStates: 10\nDistinct: 2\nTime: 0.5\n"
+               "Error: Error: Invariant Inv is violated.\nError: The behavior up to this point is:\n\n");
+    file.close();
+
+    tla_visualiser::TLCRunner runner;
+    QVERIFY(runner.loadResults(tempFile.toStdString()));
+    auto results = runner.getResults();
+    QCOMPARE(results.status, tla_visualiser::TLCRunner::Status::Failed);
+    QCOMPARE(results.error_message,
+             std::string("Error: Invariant Inv is violated.\nError: The behavior up to this point is:\n"));
+    QCOMPARE(results.states_generated, 10);
+    QVERIFY(results.states.empty());
+    QVERIFY(results.index);
+    QCOMPARE(runner.getProgress().status, tla_visualiser::TLCRunner::Status::Completed);
+    QCOMPARE(runner.getProgress().states_generated, 10);
+
+    QFile::remove(tempFile);
+}
+
+void TestTLCRunner::testMalformedTextResults()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    tla_visualiser::TLCRunner runner;
+    for (const char* text : {"States:\n", "States: n/a\n", "Distinct: 2x\n", "Time: soon\n", "Status: 7\n"}) {
+        QFile file(dir.filePath("bad.txt"));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(text);
+        file.close();
+        QVERIFY(!runner.loadResults(file.fileName().toStdString()));
+    }
+    QCOMPARE(runner.getStatus(), tla_visualiser::TLCRunner::Status::NotStarted);
+
+    // A failed load leaves the runner free for the next one
+    QFile good(dir.filePath("good.txt"));
+    QVERIFY(good.open(QIODevice::WriteOnly));
+    good.write("States: 10\nTime: 1e-05\n");
+    good.close();
+    QVERIFY(runner.loadResults(good.fileName().toStdString()));
+    QCOMPARE(runner.getResults().states_generated, 10);
+    QCOMPARE(runner.getResults().execution_time_seconds, 1e-05);
+    // Without a Status: line the run counts as completed
+    QCOMPARE(runner.getResults().status, tla_visualiser::TLCRunner::Status::Completed);
+}
+
+void TestTLCRunner::testSnapshotShared()
+{
+    QString tempFile = QDir::tempPath() + "/test_results_snapshot.tlcres";
+    {
+        tla_visualiser::TLCRunner::RunResults saved{};
+        saved.status = tla_visualiser::TLCRunner::Status::Completed;
+        saved.states_generated = 1;
+        saved.distinct_states = 1;
+        saved.execution_time_seconds = 0.1;
+        saved.states.add(0, "Initial predicate", std::vector<std::pair<std::string, std::string>>{{"x", "0"}});
+        std::ofstream out(tempFile.toStdString(), std::ios::binary);
+        QVERIFY(tla_visualiser::results_file::write(out, saved));
+    }
+
+    tla_visualiser::TLCRunner runner;
+    auto empty = runner.getSnapshot();
+    QVERIFY(empty);
+    QVERIFY(empty->states.empty());
+
+    QVERIFY(runner.loadResults(tempFile.toStdString()));
+    auto snapshot = runner.getSnapshot();
+    QCOMPARE(runner.getSnapshot(), snapshot);
+    QCOMPARE(snapshot->states.size(), size_t(1));
+    QVERIFY(snapshot->index);
+
+    // Loading again publishes a new snapshot; the old one stays intact
+    QVERIFY(runner.loadResults(tempFile.toStdString()));
+    QVERIFY(runner.getSnapshot() != snapshot);
+    QCOMPARE(snapshot->states.value(0, 0), std::string_view("0"));
+    QVERIFY(empty->states.empty());
+
+    QFile::remove(tempFile);
+}
+
+void TestTLCRunner::testFailedRunQueuedCallbacks()
+{
+    using Status = tla_visualiser::TLCRunner::Status;
+    tla_visualiser::TLCRunner runner;
+    QList<Status> statuses;
+    QList<QThread*> threads;
+    runner.setStatusCallback([&](Status status) {
+        statuses.append(status);
+        threads.append(QThread::currentThread());
+    });
+    runner.setCallbackContext(this);
+
+    // Fails on the runner thread (no such spec) without starting TLC
+    QVERIFY(runner.startModelCheck("/nonexistent/spec.tla"));
+    QTRY_COMPARE(statuses.size(), 2);
+    QCOMPARE(statuses[0], Status::Running);
+    QCOMPARE(statuses[1], Status::Failed);
+    // Both delivered on this (the context's) thread
+    QCOMPARE(threads[1], QThread::currentThread());
+
+    QCOMPARE(runner.getStatus(), Status::Failed);
+    QCOMPARE(runner.getProgress().status, Status::Failed);
+    QVERIFY(!runner.getSnapshot()->error_message.empty());
+
+    // A finished run can be followed by another one straight away
+    QVERIFY(runner.startModelCheck("/nonexistent/spec.tla"));
+    QTRY_COMPARE(statuses.size(), 4);
+
+    // Nothing reaches a context destroyed during the run
+    auto* receiver = new QObject;
+    runner.setCallbackContext(receiver);
+    QVERIFY(runner.startModelCheck("/nonexistent/spec.tla"));
+    QCOMPARE(statuses.size(), 5);   // Running, directly on this thread
+    delete receiver;
+    QTRY_COMPARE(runner.getStatus(), Status::Failed);
+    QTest::qWait(50);
+    QCOMPARE(statuses.size(), 5);
+}
+
+void TestTLCRunner::testCancelKillsProcessTree()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Uses a shell script in place of java");
+#else
+    using Status = tla_visualiser::TLCRunner::Status;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString pidFile = dir.filePath("child.pid");
+
+    // A "java" that ignores SIGTERM and has a child, like a stuck JVM
+    QFile script(dir.filePath("java"));
+    QVERIFY(script.open(QIODevice::WriteOnly));
+    script.write(QString("#!/bin/sh\ntrap '' TERM\nsleep 60 &\necho $! > %1\nwait\n")
+                     .arg(pidFile).toUtf8());
+    script.close();
+    QVERIFY(script.setPermissions(script.permissions() | QFileDevice::ExeOwner));
+    QFile spec(dir.filePath("Spec.tla"));
+    QVERIFY(spec.open(QIODevice::WriteOnly));
+    spec.close();
+
+    const QByteArray path = qgetenv("PATH");
+    qputenv("PATH", dir.path().toUtf8() + ":" + path);
+
+    tla_visualiser::TLCRunner runner;
+    QVERIFY(runner.startModelCheck(spec.fileName().toStdString()));
+    QTRY_VERIFY(QFileInfo(pidFile).size() > 0);
+
+    // The results belong to the run until it ends
+    QFile saved(dir.filePath("saved.txt"));
+    QVERIFY(saved.open(QIODevice::WriteOnly));
+    saved.write("States: 10\n");
+    saved.close();
+    const auto running = runner.getSnapshot();
+    QVERIFY(!runner.loadResults(saved.fileName().toStdString()));
+    QCOMPARE(runner.getSnapshot(), running);
+    QCOMPARE(runner.getStatus(), Status::Running);
+
+    QElapsedTimer timer;
+    timer.start();
+    runner.cancel();
+    QTRY_COMPARE_WITH_TIMEOUT(runner.getStatus(), Status::Cancelled, 5000);
+    QVERIFY(timer.elapsed() < 4000);
+    qputenv("PATH", path);
+
+    // The child went down with the process group
+    QFile pidIn(pidFile);
+    QVERIFY(pidIn.open(QIODevice::ReadOnly));
+    const pid_t child = static_cast<pid_t>(pidIn.readAll().trimmed().toLongLong());
+    QVERIFY(child > 0);
+    QTRY_VERIFY(::kill(child, 0) != 0);
+#endif
+}
+
+void TestTLCRunner::testWarmHostReused()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Uses a shell script in place of java");
+#else
+    using Status = tla_visualiser::TLCRunner::Status;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString log = dir.filePath("starts");
+    QFile spec(dir.filePath("Spec.tla"));
+    QVERIFY(spec.open(QIODevice::WriteOnly));
+    spec.close();
+
+    tla_visualiser::TLCRunner runner;
+    tla_visualiser::TLCOptions options;
+    options.java = writeFakeJava(dir, log, false).toStdString();
+    options.warm_host = true;
+    runner.setOptions(options);
+
+    for (int run = 0; run < 3; ++run) {
+        QVERIFY(runner.startModelCheck(spec.fileName().toStdString()));
+        QTRY_VERIFY(runner.getStatus() != Status::Running);
+        QCOMPARE(runner.getStatus(), Status::Completed);
+        QCOMPARE(runner.getResults().distinct_states, 4);
+    }
+    // One JVM for all three runs
+    QCOMPARE(readLog(log), QStringList({"host"}));
+#endif
+}
+
+void TestTLCRunner::testWarmHostLostFallsBack()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Uses a shell script in place of java");
+#else
+    using Status = tla_visualiser::TLCRunner::Status;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString log = dir.filePath("starts");
+    QFile spec(dir.filePath("Spec.tla"));
+    QVERIFY(spec.open(QIODevice::WriteOnly));
+    spec.close();
+
+    tla_visualiser::TLCRunner runner;
+    tla_visualiser::TLCOptions options;
+    options.java = writeFakeJava(dir, log, true).toStdString();
+    options.warm_host = true;
+    runner.setOptions(options);
+
+    for (int run = 0; run < 3; ++run) {
+        QVERIFY(runner.startModelCheck(spec.fileName().toStdString()));
+        QTRY_VERIFY(runner.getStatus() != Status::Running);
+        QCOMPARE(runner.getStatus(), Status::Completed);
+        QCOMPARE(runner.getResults().distinct_states, 4);
+    }
+    // Each lost run is repeated in its own JVM; after two losses in a row
+    // the host is no longer tried
+    QCOMPARE(readLog(log), QStringList({"host", "tlc", "host", "tlc", "tlc"}));
+#endif
+}
+
+void TestTLCRunner::testRunCacheSkipsTLC()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Uses a shell script in place of java");
+#else
+    using Status = tla_visualiser::TLCRunner::Status;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString log = dir.filePath("starts");
+    QFile spec(dir.filePath("Spec.tla"));
+    QVERIFY(spec.open(QIODevice::WriteOnly));
+    spec.write("---- MODULE Spec ----\n====\n");
+    spec.close();
+
+    auto cache = std::make_shared<tla_visualiser::RunCache>(dir.filePath("cache").toStdString());
+    tla_visualiser::TLCRunner runner;
+    tla_visualiser::TLCOptions options;
+    options.java = writeFakeJava(dir, log, false).toStdString();
+    runner.setOptions(options);
+    runner.setRunCache(cache);
+
+    for (int run = 0; run < 2; ++run) {
+        QVERIFY(runner.startModelCheck(spec.fileName().toStdString()));
+        QTRY_VERIFY(runner.getStatus() != Status::Running);
+        QCOMPARE(runner.getStatus(), Status::Completed);
+        QCOMPARE(runner.getResults().distinct_states, 4);
+    }
+    QCOMPARE(readLog(log), QStringList({"tlc"}));
+    QCOMPARE(cache->stats().hits, uint64_t(1));
+    QCOMPARE(cache->stats().misses, uint64_t(1));
+
+    // A changed spec is checked again
+    QVERIFY(spec.open(QIODevice::Append));
+    spec.write("\\* edited\n");
+    spec.close();
+    QVERIFY(runner.startModelCheck(spec.fileName().toStdString()));
+    QTRY_VERIFY(runner.getStatus() != Status::Running);
+    QCOMPARE(readLog(log), QStringList({"tlc", "tlc"}));
+#endif
+}
+
 QTEST_MAIN(TestTLCRunner)
 #include "test_tlc_runner.moc"
@@ -0,0 +1,82 @@
+import java.io.BufferedReader;
+import java.io.FileDescriptor;
+import java.io.FileOutputStream;
+import java.io.InputStreamReader;
+import java.io.PrintStream;
+import java.lang.reflect.Method;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Long-lived TLC host for TLCRunner: runs model checks one after another
+ * in a single, already warmed-up JVM.
+ *
+ * Started with the runner's JVM flags as
+ *   java [flags] -cp tla2tools.jar TLCHost.java
+ * and driven over stdin/stdout:
+ *   <- "@!@!@TLCHOST-READY"            once TLC is loaded
+ *   -> "RUN\t<arg>\t<arg>...\n"          the TLC arguments of one run
+ *   <- TLC's output, then "@!@!@TLCHOST-END <exit code>"
+ *
+ * Anything that ends the JVM (TLC calling System.exit, a crash) closes
+ * stdout; the runner then repeats the run in a JVM of its own.
+ */
+public final class TLCHost {
+    private static final String READY = "@!@!@TLCHOST-READY";
+    private static final String END = "@!@!@TLCHOST-END ";
+
+    public static void main(String[] args) throws Exception {
+        PrintStream out = new PrintStream(new FileOutputStream(FileDescriptor.out), true,
+                                          StandardCharsets.UTF_8.name());
+        BufferedReader in = new BufferedReader(new InputStreamReader(System.in, StandardCharsets.UTF_8));
+
+        // Load TLC's classes now rather than during the first run
+        Class.forName("tlc2.TLC");
+        out.println(READY);
+
+        String line;
+        while ((line = in.readLine()) != null) {
+            if (!line.startsWith("RUN")) {
+                continue;
+            }
+            String[] tlcArgs = line.length() > 4 ? line.substring(4).split("\t", -1) : new String[0];
+            int code = run(tlcArgs, out);
+            out.flush();
+            out.println(END + code);
+        }
+    }
+
+    private static int run(String[] args, PrintStream out) {
+        PrintStream savedOut = System.out;
+        PrintStream savedErr = System.err;
+        System.setOut(out);
+        System.setErr(out);
+        tla2sany.ToolIO.out = out;
+        tla2sany.ToolIO.err = out;
+        try {
+            tlc2.TLC tlc = new tlc2.TLC();
+            if (!tlc.handleParameters(args)) {
+                return 1;
+            }
+            tlc.setResolver(new util.SimpleFilenameToStream());
+            return tlc.process();
+        } catch (Throwable t) {
+            t.printStackTrace(out);
+            return 255;
+        } finally {
+            System.setOut(savedOut);
+            System.setErr(savedErr);
+            reset();
+        }
+    }
+
+    // TLC keeps per-run state in statics; clear what this TLC version lets us
+    private static void reset() {
+        tla2sany.ToolIO.reset();
+        try {
+            Method reset = Class.forName("tlc2.TLCGlobals").getMethod("reset");
+            reset.invoke(null);
+        } catch (ReflectiveOperationException e) {
+            // Not in this TLC version
+        }
+    }
+}